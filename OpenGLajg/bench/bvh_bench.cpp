@@ -0,0 +1,86 @@
+// BVH build / refit / query benchmark
+// build: g++ -O2 -std=c++11 -I../../Dependencies/glm -I../src bvh_bench.cpp -o bvh_bench
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BVH.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <stdio.h>
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void run(unsigned int objectCount)
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> size(0.5f, 3.0f);
+	std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+
+	// car sized boxes scattered over a flat 1km x 1km area
+	std::vector<AABB> objects(objectCount);
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		glm::vec3 c(position(rng), position(rng) * 0.01f, position(rng));
+		glm::vec3 e(size(rng), size(rng) * 0.5f, size(rng));
+		objects[i] = AABB(c - e, c + e);
+	}
+
+	BVH bvh;
+	auto start = std::chrono::high_resolution_clock::now();
+	bvh.build(objects);
+	double buildMs = elapsedMs(start);
+
+	// every object moves a little, as cars do between frames
+	for (unsigned int i = 0; i < objectCount; i++)
+	{
+		glm::vec3 d(jitter(rng), 0.0f, jitter(rng));
+		objects[i].min += d;
+		objects[i].max += d;
+	}
+	start = std::chrono::high_resolution_clock::now();
+	bvh.refit(objects);
+	double refitMs = elapsedMs(start);
+
+	const int QUERIES = 1000;
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+	std::vector<unsigned int> visible;
+	unsigned long long visited = 0, found = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int q = 0; q < QUERIES; q++)
+	{
+		glm::vec3 eye(position(rng), 2.0f, position(rng));
+		glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(jitter(rng), 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		visible.clear();
+		visited += bvh.cull(Frustum(projection * view), objects, visible);
+		found += visible.size();
+	}
+	double cullUs = elapsedMs(start) * 1000.0 / QUERIES;
+
+	int hits = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int q = 0; q < QUERIES; q++)
+	{
+		glm::vec3 eye(position(rng), 50.0f, position(rng));
+		float t;
+		if (bvh.raycast(Ray(eye, glm::normalize(glm::vec3(jitter(rng), -1.0f, jitter(rng)))), objects, t) >= 0)
+			hits++;
+	}
+	double rayUs = elapsedMs(start) * 1000.0 / QUERIES;
+
+	printf("%8u objects  %6zu nodes  build %8.2f ms  refit %6.2f ms  frustum %8.2f us (%6.1f nodes, %6.1f visible)  ray %6.2f us (%d hits)\n",
+		objectCount, bvh.nodes.size(), buildMs, refitMs, cullUs, double(visited) / QUERIES, double(found) / QUERIES, rayUs, hits);
+}
+
+int main()
+{
+	unsigned int counts[] = { 1000, 10000, 100000 };
+	for (unsigned int n : counts)
+		run(n);
+	return 0;
+}
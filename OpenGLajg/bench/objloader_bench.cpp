@@ -0,0 +1,180 @@
+// OBJ loader benchmark : the memory mapped parallel parser against the previous fscanf loader
+// build: g++ -O2 -std=c++11 -pthread -I../../Dependencies/glm -I../src/common objloader_bench.cpp ../src/common/objloader.cpp ../src/common/mappedfile.cpp -o objloader_bench
+// usage: objloader_bench [megabytes]   (writes bench.obj in the working directory)
+#include <glm/glm.hpp>
+
+#include "objloader.hpp"
+
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <stdio.h>
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// the loader this project used before, kept verbatim apart from the messages
+static bool loadOBJFscanf(const char *path, std::vector<glm::vec3> &out_vertices, std::vector<glm::vec2> &out_uvs, std::vector<glm::vec3> &out_normals)
+{
+	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+	std::vector<glm::vec3> temp_vertices;
+	std::vector<glm::vec2> temp_uvs;
+	std::vector<glm::vec3> temp_normals;
+	FILE *file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+	while (1)
+	{
+		char lineHeader[128];
+		if (fscanf(file, "%s", lineHeader) == EOF)
+			break;
+		if (strcmp(lineHeader, "v") == 0)
+		{
+			glm::vec3 vertex;
+			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
+			temp_vertices.push_back(vertex);
+		}
+		else if (strcmp(lineHeader, "vt") == 0)
+		{
+			glm::vec2 uv;
+			fscanf(file, "%f %f\n", &uv.x, &uv.y);
+			uv.y = -uv.y;
+			temp_uvs.push_back(uv);
+		}
+		else if (strcmp(lineHeader, "vn") == 0)
+		{
+			glm::vec3 normal;
+			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
+			temp_normals.push_back(normal);
+		}
+		else if (strcmp(lineHeader, "f") == 0)
+		{
+			unsigned int v[3], t[3], n[3];
+			if (fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &v[0], &t[0], &n[0], &v[1], &t[1], &n[1], &v[2], &t[2], &n[2]) != 9)
+			{
+				fclose(file);
+				return false;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				vertexIndices.push_back(v[k]);
+				uvIndices.push_back(t[k]);
+				normalIndices.push_back(n[k]);
+			}
+		}
+		else
+		{
+			char stupidBuffer[1000];
+			fgets(stupidBuffer, 1000, file);
+		}
+	}
+	for (unsigned int i = 0; i < vertexIndices.size(); i++)
+	{
+		out_vertices.push_back(temp_vertices[vertexIndices[i] - 1]);
+		out_uvs.push_back(temp_uvs[uvIndices[i] - 1]);
+		out_normals.push_back(temp_normals[normalIndices[i] - 1]);
+	}
+	fclose(file);
+	return true;
+}
+
+// uv sphere written as triangles with v/vt/vn corners until the file reaches the requested size
+static void writeSphere(const char *path, double megabytes)
+{
+	// a grid vertex with its uv, normal and two triangles is roughly 200 bytes
+	int rings = (int)std::sqrt(megabytes * 1024.0 * 1024.0 / 200.0);
+	int segments = rings;
+	FILE *file = fopen(path, "w");
+	fprintf(file, "# benchmark sphere\no sphere\n");
+	for (int r = 0; r <= rings; r++)
+		for (int s = 0; s <= segments; s++)
+		{
+			float theta = 3.14159265f * r / rings, phi = 6.2831853f * s / segments;
+			glm::vec3 n(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			fprintf(file, "v %f %f %f\n", n.x * 2.5f, n.y * 2.5f, n.z * 2.5f);
+			fprintf(file, "vt %f %f\n", (float)s / segments, (float)r / rings);
+			fprintf(file, "vn %f %f %f\n", n.x, n.y, n.z);
+		}
+	fprintf(file, "s off\n");
+	for (int r = 0; r < rings; r++)
+		for (int s = 0; s < segments; s++)
+		{
+			int a = r * (segments + 1) + s + 1, b = a + segments + 1;
+			fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, a + 1, a + 1, a + 1);
+			fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a + 1, a + 1, a + 1, b, b, b, b + 1, b + 1, b + 1);
+		}
+	fclose(file);
+}
+
+int main(int argc, char **argv)
+{
+	double megabytes = argc > 1 ? atof(argv[1]) : 50.0;
+	const char *path = "bench.obj";
+	writeSphere(path, megabytes);
+	FILE *file = fopen(path, "rb");
+	fseek(file, 0, SEEK_END);
+	printf("%s : %.1f MB\n", path, ftell(file) / (1024.0 * 1024.0));
+	fclose(file);
+
+	std::vector<glm::vec3> oldVertices, oldNormals, newVertices, newNormals;
+	std::vector<glm::vec2> oldUvs, newUvs;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	loadOBJFscanf(path, oldVertices, oldUvs, oldNormals);
+	double oldMs = elapsedMs(start);
+
+	// best of three, the first run also pays for the page cache of the old loader
+	double newMs = 1e30;
+	for (int run = 0; run < 3; run++)
+	{
+		newVertices.clear();
+		newUvs.clear();
+		newNormals.clear();
+		start = std::chrono::high_resolution_clock::now();
+		loadOBJ(path, newVertices, newUvs, newNormals);
+		newMs = std::min(newMs, elapsedMs(start));
+	}
+
+	float difference = 0.0f;
+	bool same = oldVertices.size() == newVertices.size();
+	for (size_t i = 0; same && i < oldVertices.size(); i++)
+	{
+		difference = std::max(difference, glm::length(oldVertices[i] - newVertices[i]));
+		difference = std::max(difference, glm::length(oldUvs[i] - newUvs[i]));
+		difference = std::max(difference, glm::length(oldNormals[i] - newNormals[i]));
+	}
+
+	IndexedMesh mesh;
+	double indexedMs = 1e30;
+	for (int run = 0; run < 3; run++)
+	{
+		start = std::chrono::high_resolution_clock::now();
+		loadOBJIndexed(path, mesh);
+		indexedMs = std::min(indexedMs, elapsedMs(start));
+	}
+	// expanding the index buffer has to give back the de-indexed triangles
+	bool indexedSame = mesh.indexCount() == newVertices.size();
+	for (size_t i = 0; indexedSame && i < mesh.indexCount(); i++)
+	{
+		unsigned int index = mesh.indices16.empty() ? mesh.indices32[i] : mesh.indices16[i];
+		const ObjVertex &v = mesh.vertices[index];
+		indexedSame = v.position == newVertices[i] && v.uv == newUvs[i] && v.normal == newNormals[i];
+	}
+
+	printf("%u vertices, outputs %s (max difference %g)\n", (unsigned int)newVertices.size(), same ? "match" : "DIFFER", difference);
+	printf("fscanf loader  %9.1f ms\n", oldMs);
+	printf("mapped loader  %9.1f ms  (%.1fx)\n", newMs, oldMs / newMs);
+	size_t flatBytes = newVertices.size() * sizeof(ObjVertex);
+	size_t indexedBytes = mesh.vertices.size() * sizeof(ObjVertex) + mesh.indexCount() * mesh.indexSize();
+	printf("indexed loader %9.1f ms  %u unique vertices, %u-bit indices, %s\n", indexedMs, (unsigned int)mesh.vertices.size(),
+		(unsigned int)mesh.indexSize() * 8, indexedSame ? "match" : "DIFFER");
+	printf("vertex data    %9.1f MB flat, %.1f MB indexed (%.1fx smaller, %.1fx fewer vertices)\n", flatBytes / 1048576.0, indexedBytes / 1048576.0,
+		(double)flatBytes / indexedBytes, (double)newVertices.size() / mesh.vertices.size());
+	same = same && indexedSame;
+	remove(path);
+	return same ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 direction;
+
+	Ray() {}
+	Ray(const glm::vec3 &origin, const glm::vec3 &direction) : origin(origin), direction(direction) {}
+
+	// ray through a window position (pixels, origin top left) for the given camera matrices
+	static Ray fromScreen(float x, float y, float width, float height, const glm::mat4 &projection, const glm::mat4 &view)
+	{
+		glm::mat4 inverse = glm::inverse(projection * view);
+		float ndcX = 2.0f * x / width - 1.0f;
+		float ndcY = 1.0f - 2.0f * y / height;
+		glm::vec4 nearPoint = inverse * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverse * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+		glm::vec3 a = glm::vec3(nearPoint) / nearPoint.w;
+		glm::vec3 b = glm::vec3(farPoint) / farPoint.w;
+		return Ray(a, glm::normalize(b - a));
+	}
+};
+
+// slab test, returns the entry distance in tNear when the ray hits the box before tMax
+inline bool intersectRay(const AABB &box, const glm::vec3 &origin, const glm::vec3 &invDirection, float tMax, float &tNear)
+{
+	glm::vec3 t0 = (box.min - origin) * invDirection;
+	glm::vec3 t1 = (box.max - origin) * invDirection;
+	glm::vec3 tSmall = glm::min(t0, t1);
+	glm::vec3 tBig = glm::max(t0, t1);
+	float enter = std::max(std::max(tSmall.x, tSmall.y), std::max(tSmall.z, 0.0f));
+	float exit = std::min(std::min(tBig.x, tBig.y), std::min(tBig.z, tMax));
+	tNear = enter;
+	return enter <= exit;
+}
+
+// bounding volume hierarchy over object bounds
+// built top down with binned SAH, refit bottom up when objects move
+// ------------------------------------------------------------------------
+class BVH
+{
+public:
+	struct Node
+	{
+		AABB bounds;
+		unsigned int first; // first child for inner nodes, first entry of objectIndices for leaves
+		unsigned int count; // number of objects in a leaf, 0 for inner nodes
+	};
+
+	std::vector<Node> nodes;
+	std::vector<unsigned int> objectIndices;
+
+	void build(const std::vector<AABB> &objects)
+	{
+		nodes.clear();
+		objectIndices.resize(objects.size());
+		if (objects.empty())
+			return;
+		centroids.resize(objects.size());
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			objectIndices[i] = (unsigned int)i;
+			centroids[i] = objects[i].center();
+		}
+		nodes.reserve(2 * objects.size());
+
+		Node root;
+		root.first = 0;
+		root.count = (unsigned int)objects.size();
+		nodes.push_back(root);
+
+		// (node, depth) pairs, the depth limit keeps the traversal stacks below bounded
+		std::vector<unsigned int> stack;
+		stack.push_back(0);
+		stack.push_back(0);
+		while (!stack.empty())
+		{
+			unsigned int depth = stack.back();
+			stack.pop_back();
+			unsigned int nodeIndex = stack.back();
+			stack.pop_back();
+			updateBounds(nodes[nodeIndex], objects);
+
+			unsigned int mid;
+			if (depth >= MAX_DEPTH || !split(nodes[nodeIndex], objects, mid))
+				continue;
+
+			// children are always appended after their parent, refit() relies on that
+			Node left, right;
+			left.first = nodes[nodeIndex].first;
+			left.count = mid - left.first;
+			right.first = mid;
+			right.count = nodes[nodeIndex].first + nodes[nodeIndex].count - mid;
+			unsigned int leftIndex = (unsigned int)nodes.size();
+			nodes.push_back(left);
+			nodes.push_back(right);
+			nodes[nodeIndex].first = leftIndex;
+			nodes[nodeIndex].count = 0;
+			stack.push_back(leftIndex);
+			stack.push_back(depth + 1);
+			stack.push_back(leftIndex + 1);
+			stack.push_back(depth + 1);
+		}
+	}
+
+	// keeps the tree topology and only recomputes bounds, objects must be the same set as in build()
+	void refit(const std::vector<AABB> &objects)
+	{
+		for (size_t i = nodes.size(); i-- > 0;)
+		{
+			Node &node = nodes[i];
+			if (node.count > 0)
+			{
+				updateBounds(node, objects);
+			}
+			else
+			{
+				node.bounds = nodes[node.first].bounds;
+				node.bounds.grow(nodes[node.first + 1].bounds);
+			}
+		}
+	}
+
+	// appends every object whose bounds touch the frustum, returns the number of nodes visited
+	unsigned int cull(const Frustum &frustum, const std::vector<AABB> &objects, std::vector<unsigned int> &visible) const
+	{
+		if (nodes.empty())
+			return 0;
+		unsigned int visited = 0;
+		unsigned int stack[MAX_DEPTH + 2];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node &node = nodes[stack[--top]];
+			visited++;
+			Frustum::Containment c = frustum.classify(node.bounds);
+			if (c == Frustum::OUTSIDE)
+				continue;
+			if (c == Frustum::INSIDE)
+			{
+				collect(node, visible);
+				continue;
+			}
+			if (node.count > 0)
+			{
+				for (unsigned int i = 0; i < node.count; i++)
+				{
+					unsigned int object = objectIndices[node.first + i];
+					if (frustum.intersects(objects[object]))
+						visible.push_back(object);
+				}
+				continue;
+			}
+			stack[top++] = node.first;
+			stack[top++] = node.first + 1;
+		}
+		return visited;
+	}
+
+	// closest object whose bounds are hit by the ray, -1 when nothing is hit
+	int raycast(const Ray &ray, const std::vector<AABB> &objects, float &tHit) const
+	{
+		int hit = -1;
+		tHit = FLT_MAX;
+		if (nodes.empty())
+			return hit;
+		glm::vec3 invDirection = 1.0f / ray.direction;
+		unsigned int stack[MAX_DEPTH + 2];
+		int top = 0;
+		float t;
+		if (!intersectRay(nodes[0].bounds, ray.origin, invDirection, tHit, t))
+			return hit;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			const Node &node = nodes[stack[--top]];
+			if (!intersectRay(node.bounds, ray.origin, invDirection, tHit, t))
+				continue;
+			if (node.count > 0)
+			{
+				for (unsigned int i = 0; i < node.count; i++)
+				{
+					unsigned int object = objectIndices[node.first + i];
+					if (intersectRay(objects[object], ray.origin, invDirection, tHit, t) && t < tHit)
+					{
+						tHit = t;
+						hit = (int)object;
+					}
+				}
+				continue;
+			}
+			// visit the nearer child first so the far one is usually rejected by tHit
+			float tLeft, tRight;
+			bool hitLeft = intersectRay(nodes[node.first].bounds, ray.origin, invDirection, tHit, tLeft);
+			bool hitRight = intersectRay(nodes[node.first + 1].bounds, ray.origin, invDirection, tHit, tRight);
+			if (hitLeft && hitRight)
+			{
+				if (tLeft < tRight)
+				{
+					stack[top++] = node.first + 1;
+					stack[top++] = node.first;
+				}
+				else
+				{
+					stack[top++] = node.first;
+					stack[top++] = node.first + 1;
+				}
+			}
+			else if (hitLeft)
+				stack[top++] = node.first;
+			else if (hitRight)
+				stack[top++] = node.first + 1;
+		}
+		return hit;
+	}
+
+private:
+	static const unsigned int BIN_COUNT = 16;
+	static const unsigned int MAX_LEAF_SIZE = 4;
+	static const unsigned int MAX_DEPTH = 60;
+
+	std::vector<glm::vec3> centroids;
+
+	void updateBounds(Node &node, const std::vector<AABB> &objects) const
+	{
+		node.bounds = AABB();
+		for (unsigned int i = 0; i < node.count; i++)
+			node.bounds.grow(objects[objectIndices[node.first + i]]);
+	}
+
+	void collect(const Node &root, std::vector<unsigned int> &visible) const
+	{
+		// objects of a subtree are contiguous in objectIndices, so walk down to the range ends
+		const Node *leftmost = &root;
+		while (leftmost->count == 0)
+			leftmost = &nodes[leftmost->first];
+		const Node *rightmost = &root;
+		while (rightmost->count == 0)
+			rightmost = &nodes[rightmost->first + 1];
+		visible.insert(visible.end(), objectIndices.begin() + leftmost->first, objectIndices.begin() + rightmost->first + rightmost->count);
+	}
+
+	static float area(const AABB &box)
+	{
+		glm::vec3 d = box.max - box.min;
+		return d.x * d.y + d.y * d.z + d.z * d.x;
+	}
+
+	// partitions the objects of a leaf along the cheapest SAH plane, mid is the first object of the right half
+	bool split(const Node &node, const std::vector<AABB> &objects, unsigned int &mid)
+	{
+		if (node.count <= MAX_LEAF_SIZE)
+			return false;
+
+		AABB centroidBounds;
+		for (unsigned int i = 0; i < node.count; i++)
+			centroidBounds.grow(centroids[objectIndices[node.first + i]]);
+
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		unsigned int bestBin = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float lo = centroidBounds.min[axis];
+			float extent = centroidBounds.max[axis] - lo;
+			if (extent <= 0.0f)
+				continue;
+			float scale = BIN_COUNT / extent;
+
+			AABB bins[BIN_COUNT];
+			unsigned int counts[BIN_COUNT] = {};
+			for (unsigned int i = 0; i < node.count; i++)
+			{
+				unsigned int object = objectIndices[node.first + i];
+				unsigned int b = std::min(BIN_COUNT - 1, (unsigned int)((centroids[object][axis] - lo) * scale));
+				counts[b]++;
+				bins[b].grow(objects[object]);
+			}
+
+			// sweep from the right to get the cost of every right half, then from the left
+			float rightArea[BIN_COUNT];
+			unsigned int rightCount[BIN_COUNT];
+			AABB accumulated;
+			unsigned int accumulatedCount = 0;
+			for (unsigned int b = BIN_COUNT - 1; b > 0; b--)
+			{
+				accumulated.grow(bins[b]);
+				accumulatedCount += counts[b];
+				rightArea[b] = accumulated.valid() ? area(accumulated) : 0.0f;
+				rightCount[b] = accumulatedCount;
+			}
+			accumulated = AABB();
+			accumulatedCount = 0;
+			for (unsigned int b = 0; b < BIN_COUNT - 1; b++)
+			{
+				accumulated.grow(bins[b]);
+				accumulatedCount += counts[b];
+				if (accumulatedCount == 0 || rightCount[b + 1] == 0)
+					continue;
+				float cost = accumulatedCount * area(accumulated) + rightCount[b + 1] * rightArea[b + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+				}
+			}
+		}
+
+		// splitting only pays off when it beats intersecting every object of the leaf
+		if (bestAxis < 0 || bestCost >= node.count * area(node.bounds))
+		{
+			if (node.count <= 4 * MAX_LEAF_SIZE || bestAxis < 0)
+				return false;
+		}
+
+		float lo = centroidBounds.min[bestAxis];
+		float scale = BIN_COUNT / (centroidBounds.max[bestAxis] - lo);
+		unsigned int *begin = &objectIndices[node.first];
+		unsigned int *end = begin + node.count;
+		unsigned int *pivot = std::partition(begin, end, [&](unsigned int object) {
+			unsigned int b = std::min(BIN_COUNT - 1, (unsigned int)((centroids[object][bestAxis] - lo) * scale));
+			return b <= bestBin;
+		});
+		mid = node.first + (unsigned int)(pivot - begin);
+		return mid != node.first && mid != node.first + node.count;
+	}
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+// SSE2 is available on every x64 target and on Win32 builds with /arch:SSE2 or better
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULLING_USE_SSE 1
+#endif
+
+// axis aligned bounding box
+// ------------------------------------------------------------------------
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	AABB() : min(glm::vec3(INFINITY)), max(glm::vec3(-INFINITY)) {}
+	AABB(const glm::vec3 &min, const glm::vec3 &max) : min(min), max(max) {}
+
+	// bounds of the positions inside an interleaved float array,
+	// stride is the number of floats per vertex and position is the first attribute
+	static AABB fromVertices(const float *vertices, size_t vertexCount, size_t stride)
+	{
+		AABB box;
+		for (size_t i = 0; i < vertexCount; i++)
+			box.grow(glm::vec3(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]));
+		return box;
+	}
+
+	void grow(const glm::vec3 &p)
+	{
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+	void grow(const AABB &other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+	bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+	// bounds of this box after an affine transform (Arvo's method, no corner enumeration)
+	AABB transformed(const glm::mat4 &m) const
+	{
+		glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+		glm::vec3 e = extents();
+		glm::vec3 r;
+		for (int i = 0; i < 3; i++)
+			r[i] = std::fabs(m[0][i]) * e.x + std::fabs(m[1][i]) * e.y + std::fabs(m[2][i]) * e.z;
+		return AABB(c - r, c + r);
+	}
+};
+
+// six clip planes of a view frustum, normals point inwards
+// ------------------------------------------------------------------------
+class Frustum
+{
+public:
+	enum { PLANE_LEFT = 0, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR };
+	glm::vec4 planes[6];
+
+	Frustum() {}
+	explicit Frustum(const glm::mat4 &viewProjection) { extract(viewProjection); }
+
+	// Gribb/Hartmann plane extraction from projection * view
+	void extract(const glm::mat4 &m)
+	{
+		glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+		glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+		glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+		glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+		planes[PLANE_LEFT] = row3 + row0;
+		planes[PLANE_RIGHT] = row3 - row0;
+		planes[PLANE_BOTTOM] = row3 + row1;
+		planes[PLANE_TOP] = row3 - row1;
+		planes[PLANE_NEAR] = row3 + row2;
+		planes[PLANE_FAR] = row3 - row2;
+		for (int i = 0; i < 6; i++)
+			planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+
+	bool intersects(const AABB &box) const
+	{
+		glm::vec3 c = box.center();
+		glm::vec3 e = box.extents();
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 n = glm::vec3(planes[i]);
+			float d = glm::dot(n, c) + planes[i].w;
+			float r = glm::dot(glm::abs(n), e);
+			if (d + r < 0.0f)
+				return false;
+		}
+		return true;
+	}
+
+	enum Containment { OUTSIDE = 0, INTERSECTING, INSIDE };
+
+	// like intersects() but also reports boxes that lie completely inside,
+	// hierarchies use that to accept whole subtrees without further tests
+	Containment classify(const AABB &box) const
+	{
+		glm::vec3 c = box.center();
+		glm::vec3 e = box.extents();
+		Containment result = INSIDE;
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 n = glm::vec3(planes[i]);
+			float d = glm::dot(n, c) + planes[i].w;
+			float r = glm::dot(glm::abs(n), e);
+			if (d + r < 0.0f)
+				return OUTSIDE;
+			if (d - r < 0.0f)
+				result = INTERSECTING;
+		}
+		return result;
+	}
+
+	bool intersects(const glm::vec3 &center, float radius) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+				return false;
+		}
+		return true;
+	}
+};
+
+// bounds stored as structure of arrays (center + half extents) so that
+// the frustum test can run on four boxes per iteration
+// ------------------------------------------------------------------------
+class CullList
+{
+public:
+	void clear()
+	{
+		count = 0;
+		cx.clear(); cy.clear(); cz.clear();
+		ex.clear(); ey.clear(); ez.clear();
+	}
+
+	void reserve(size_t n)
+	{
+		n = padded(n);
+		cx.reserve(n); cy.reserve(n); cz.reserve(n);
+		ex.reserve(n); ey.reserve(n); ez.reserve(n);
+	}
+
+	// returns the slot of the box, visibility of that slot is written to the same index by cull()
+	size_t add(const AABB &box)
+	{
+		glm::vec3 c = box.center();
+		glm::vec3 e = box.extents();
+		return add(c, e);
+	}
+	size_t add(const glm::vec3 &center, const glm::vec3 &halfExtents)
+	{
+		// fill the padding lanes in place so the arrays always stay a multiple of 4 long
+		if (count == cx.size())
+		{
+			size_t n = padded(count + 1);
+			cx.resize(n, 0.0f); cy.resize(n, 0.0f); cz.resize(n, 0.0f);
+			ex.resize(n, 0.0f); ey.resize(n, 0.0f); ez.resize(n, 0.0f);
+		}
+		cx[count] = center.x; cy[count] = center.y; cz[count] = center.z;
+		ex[count] = halfExtents.x; ey[count] = halfExtents.y; ez[count] = halfExtents.z;
+		return count++;
+	}
+
+	size_t size() const { return count; }
+
+	// visible[i] is set to 1 when box i touches the frustum and 0 otherwise
+	void cull(const Frustum &frustum, std::vector<unsigned char> &visible) const
+	{
+		visible.resize(cx.size());
+#ifdef CULLING_USE_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		for (size_t i = 0; i < cx.size(); i += 4)
+		{
+			__m128 px = _mm_loadu_ps(&cx[i]), py = _mm_loadu_ps(&cy[i]), pz = _mm_loadu_ps(&cz[i]);
+			__m128 hx = _mm_loadu_ps(&ex[i]), hy = _mm_loadu_ps(&ey[i]), hz = _mm_loadu_ps(&ez[i]);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++)
+			{
+				const glm::vec4 &pl = frustum.planes[p];
+				__m128 nx = _mm_set1_ps(pl.x), ny = _mm_set1_ps(pl.y), nz = _mm_set1_ps(pl.z);
+				// d = n.c + w
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, px), _mm_mul_ps(ny, py)),
+					_mm_add_ps(_mm_mul_ps(nz, pz), _mm_set1_ps(pl.w)));
+				// r = |n|.e
+				__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, signMask), hx), _mm_mul_ps(_mm_and_ps(ny, signMask), hy)),
+					_mm_mul_ps(_mm_and_ps(nz, signMask), hz));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+			}
+			int mask = _mm_movemask_ps(inside);
+			visible[i] = (unsigned char)(mask & 1);
+			visible[i + 1] = (unsigned char)((mask >> 1) & 1);
+			visible[i + 2] = (unsigned char)((mask >> 2) & 1);
+			visible[i + 3] = (unsigned char)((mask >> 3) & 1);
+		}
+#else
+		for (size_t i = 0; i < cx.size(); i++)
+		{
+			glm::vec3 c(cx[i], cy[i], cz[i]);
+			glm::vec3 e(ex[i], ey[i], ez[i]);
+			visible[i] = frustum.intersects(AABB(c - e, c + e)) ? 1 : 0;
+		}
+#endif
+		visible.resize(count);
+	}
+
+private:
+	size_t count = 0;
+	std::vector<float> cx, cy, cz;
+	std::vector<float> ex, ey, ez;
+
+	static size_t padded(size_t n) { return (n + 3) & ~size_t(3); }
+};
+
+#endif
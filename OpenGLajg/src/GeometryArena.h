@@ -0,0 +1,157 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+#include "StaticMesh.h"
+#include "common/mesh.hpp"
+#include "common/meshsimplify.hpp"
+#include "common/primitives.hpp"
+#include "common/profiler.hpp"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+#include <cstddef>
+
+// one vertex buffer, one element buffer and one VAO shared by many meshes.
+// meshes are appended on the CPU and become drawable after upload(), each one
+// is addressed by its index range and base vertex (glDrawElementsBaseVertex)
+// ------------------------------------------------------------------------
+class GeometryArena
+{
+public:
+	unsigned int VAO;
+	unsigned int indexType; // GL_UNSIGNED_SHORT while every vertex fits, GL_UNSIGNED_INT after
+	PositionDecode decode;  // the buffer holds quantized vertices (quantizeMeshView)
+
+	GeometryArena() : VAO(0), indexType(GL_UNSIGNED_INT), VBO(0), EBO(0), dirty(false) {}
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		if (VAO)
+		{
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+			glDeleteBuffers(1, &EBO);
+			VAO = VBO = EBO = 0;
+		}
+		dirty = true;
+	}
+
+	// returns the range of the mesh, valid once upload() has been called
+	MeshLod add(const MeshData &mesh, float error = 0.0f)
+	{
+		MeshLod range;
+		range.indexOffset = (unsigned int)indices.size();
+		range.indexCount = (unsigned int)mesh.indices.size();
+		range.baseVertex = (int)vertices.size();
+		range.error = error;
+		vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+		indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+		dirty = true;
+		return range;
+	}
+
+	// tessellation levels of a procedural primitive, finest first. every (name, segment count)
+	// pair is generated once, later calls with the same name return the cached chain
+	const std::vector<MeshLod> &tessellated(const std::string &name, const std::vector<unsigned int> &segmentCounts, float radius,
+		const std::function<MeshData(unsigned int)> &generate)
+	{
+		std::map<std::string, std::vector<MeshLod> >::iterator it = chains.find(name);
+		if (it != chains.end())
+			return it->second;
+		std::vector<MeshLod> &chain = chains[name];
+		for (size_t i = 0; i < segmentCounts.size(); i++)
+			chain.push_back(add(generate(segmentCounts[i]), tessellationError(radius, segmentCounts[i])));
+		return chain;
+	}
+
+	// (re)creates the GL buffers from everything added so far, quantized and with 16 bit
+	// indices when possible, ranges keep their offsets either way
+	void upload()
+	{
+		PROFILE_SCOPE("upload geometry arena");
+		if (!dirty)
+			return;
+		if (!VAO)
+		{
+			glGenVertexArrays(1, &VAO);
+			glGenBuffers(1, &VBO);
+			glGenBuffers(1, &EBO);
+		}
+
+		std::vector<unsigned char> packed;
+		MeshView mesh = view(packed);
+		decode = PositionDecode(mesh);
+
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.empty() ? NULL : &packed[0], GL_STATIC_DRAW);
+		for (unsigned int i = 0; i < mesh.layout.attributeCount; i++)
+		{
+			const MeshAttribute &a = mesh.layout.attributes[i];
+			glVertexAttribPointer(a.location, a.components, a.type, a.normalized ? GL_TRUE : GL_FALSE, mesh.layout.stride, (void*)(size_t)a.offset);
+			glEnableVertexAttribArray(a.location);
+		}
+
+		// indices are relative to their base vertex, so they fit whenever the whole buffer does
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		if (vertices.size() <= 0x10000)
+		{
+			std::vector<unsigned short> narrow(indices.begin(), indices.end());
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(unsigned short), narrow.empty() ? NULL : &narrow[0], GL_STATIC_DRAW);
+			indexType = GL_UNSIGNED_SHORT;
+		}
+		else
+		{
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.empty() ? NULL : &indices[0], GL_STATIC_DRAW);
+			indexType = GL_UNSIGNED_INT;
+		}
+
+		glBindVertexArray(0);
+		dirty = false;
+	}
+
+	// everything added so far with quantized vertices (quantizeMeshView) in packed and 32 bit indices,
+	// the ranges returned by add() address it the same way as the GL buffers
+	MeshView view(std::vector<unsigned char> &packed) const
+	{
+		MeshView mesh = MeshView();
+		mesh.layout.stride = sizeof(Vertex);
+		mesh.layout.attributeCount = 4;
+		mesh.layout.attributes[0] = meshAttribute(0, 3, MESH_FLOAT, offsetof(Vertex, position));
+		mesh.layout.attributes[1] = meshAttribute(1, 3, MESH_FLOAT, offsetof(Vertex, color));
+		mesh.layout.attributes[2] = meshAttribute(2, 2, MESH_FLOAT, offsetof(Vertex, uv));
+		mesh.layout.attributes[3] = meshAttribute(3, 3, MESH_FLOAT, offsetof(Vertex, normal));
+		mesh.vertices = vertices.empty() ? NULL : &vertices[0];
+		mesh.vertexCount = (unsigned int)vertices.size();
+		mesh.indices = indices.empty() ? NULL : &indices[0];
+		mesh.indexCount = (unsigned int)indices.size();
+		mesh.indexSize = sizeof(unsigned int);
+		computeMeshBounds(mesh);
+		quantizeMeshView(mesh, packed);
+		return mesh;
+	}
+
+	// bounds of the vertices referenced by a range
+	AABB bounds(const MeshLod &range) const
+	{
+		AABB box;
+		for (unsigned int i = 0; i < range.indexCount; i++)
+			box.grow(vertices[range.baseVertex + indices[range.indexOffset + i]].position);
+		return box;
+	}
+
+private:
+	unsigned int VBO, EBO;
+	bool dirty;
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	std::map<std::string, std::vector<MeshLod> > chains;
+};
+
+#endif
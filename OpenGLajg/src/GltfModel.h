@@ -0,0 +1,291 @@
+#ifndef GLTF_MODEL_H
+#define GLTF_MODEL_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <stb_image.h>
+
+#include "shader.h"
+#include "Culling.h"
+#include "common/gltfloader.hpp"
+#include "common/profiler.hpp"
+
+#include <vector>
+
+// a .glb model on the GPU. every buffer view used by a primitive becomes one GL buffer that is
+// filled straight from the mapped BIN chunk, the accessors only turn into attribute pointers.
+// drawing walks the node hierarchy and sets "model" and "baseColorFactor" per primitive (gltf.vs,
+// gltf.fs), base color textures go to texture unit 0, white for primitives without one.
+// application.cpp draws one with --gltf model.glb
+// ------------------------------------------------------------------------
+class GltfModel
+{
+public:
+	AABB bounds; // of the whole scene, in model space
+	unsigned int drawCalls; // issued by one draw()
+	unsigned long long triangles;
+
+	GltfModel() : drawCalls(0), triangles(0), white(0) {}
+
+	bool loaded() const { return !roots.empty(); }
+
+	bool load(const char *path)
+	{
+		PROFILE_SCOPE("load glTF model");
+		release();
+		GltfFile file;
+		if (!file.open(path))
+			return false;
+
+		// which views feed vertex attributes and which indices, glTF does not require the target
+		std::vector<unsigned int> targets(file.bufferViews.size(), 0);
+		for (size_t m = 0; m < file.meshes.size(); m++)
+			for (size_t p = 0; p < file.meshes[m].primitives.size(); p++)
+			{
+				const GltfPrimitive &primitive = file.meshes[m].primitives[p];
+				for (int a = 0; a < GLTF_ATTRIBUTE_COUNT; a++)
+					if (primitive.attributes[a] >= 0 && file.accessors[primitive.attributes[a]].bufferView >= 0)
+						targets[file.accessors[primitive.attributes[a]].bufferView] = GL_ARRAY_BUFFER;
+				if (primitive.indices >= 0 && file.accessors[primitive.indices].bufferView >= 0)
+					targets[file.accessors[primitive.indices].bufferView] = GL_ELEMENT_ARRAY_BUFFER;
+			}
+
+		buffers.assign(file.bufferViews.size(), 0);
+		for (size_t v = 0; v < file.bufferViews.size(); v++)
+		{
+			if (!targets[v])
+				continue;
+			glGenBuffers(1, &buffers[v]);
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[v]);
+			glBufferData(GL_ARRAY_BUFFER, file.bufferViews[v].length, file.data(v), GL_STATIC_DRAW);
+		}
+
+		for (size_t m = 0; m < file.meshes.size(); m++)
+		{
+			meshes.push_back(std::vector<Primitive>());
+			for (size_t p = 0; p < file.meshes[m].primitives.size(); p++)
+				meshes.back().push_back(createPrimitive(file, file.meshes[m].primitives[p]));
+		}
+
+		for (size_t i = 0; i < file.images.size(); i++)
+			textures.push_back(createTexture(file, file.images[i]));
+		materials = file.materials;
+		nodes = file.nodes;
+		roots = file.roots;
+
+		unsigned char pixel[4] = { 255, 255, 255, 255 };
+		glGenTextures(1, &white);
+		glBindTexture(GL_TEXTURE_2D, white);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		bounds = AABB();
+		drawCalls = 0;
+		triangles = 0;
+		for (size_t r = 0; r < roots.size(); r++)
+			walk(file, roots[r], glm::mat4(1.0f), 0);
+		glBindVertexArray(0);
+		// the mapping is released on return, GL has its own copy of every view
+		return true;
+	}
+
+	// the shader has to be in use
+	void draw(const Shader &shader, const glm::mat4 &model) const
+	{
+		for (size_t r = 0; r < roots.size(); r++)
+			drawNode(shader, roots[r], model, 0);
+	}
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		for (size_t m = 0; m < meshes.size(); m++)
+			for (size_t p = 0; p < meshes[m].size(); p++)
+			{
+				glDeleteVertexArrays(1, &meshes[m][p].VAO);
+				if (meshes[m][p].indexBuffer)
+					glDeleteBuffers(1, &meshes[m][p].indexBuffer);
+			}
+		for (size_t i = 0; i < buffers.size(); i++)
+			if (buffers[i])
+				glDeleteBuffers(1, &buffers[i]);
+		for (size_t i = 0; i < textures.size(); i++)
+			if (textures[i])
+				glDeleteTextures(1, &textures[i]);
+		if (white)
+			glDeleteTextures(1, &white);
+		white = 0;
+		meshes.clear();
+		buffers.clear();
+		textures.clear();
+		materials.clear();
+		nodes.clear();
+		roots.clear();
+	}
+
+private:
+	// nodes nested deeper than this are ignored, which also stops cycles in broken files
+	static const int MAX_NODE_DEPTH = 32;
+
+	struct Primitive
+	{
+		unsigned int VAO;
+		unsigned int mode;
+		unsigned int count;        // indices, or vertices when not indexed
+		unsigned int indexType;    // 0 when not indexed
+		size_t indexOffset;        // bytes into the element buffer
+		unsigned int indexBuffer;  // owned copy for 8 bit indices, 0 when the view buffer is used
+		int material;
+	};
+
+	std::vector<unsigned int> buffers; // per buffer view, 0 when unused
+	std::vector<std::vector<Primitive> > meshes;
+	std::vector<unsigned int> textures; // per image
+	unsigned int white; // 1x1, for primitives without a base color texture
+	std::vector<GltfMaterial> materials;
+	std::vector<GltfNode> nodes;
+	std::vector<int> roots;
+
+	Primitive createPrimitive(const GltfFile &file, const GltfPrimitive &source)
+	{
+		Primitive primitive;
+		primitive.mode = source.mode;
+		primitive.material = source.material;
+		primitive.indexType = 0;
+		primitive.indexOffset = 0;
+		primitive.indexBuffer = 0;
+		primitive.count = (unsigned int)file.accessors[source.attributes[GLTF_POSITION]].count;
+
+		glGenVertexArrays(1, &primitive.VAO);
+		glBindVertexArray(primitive.VAO);
+		for (int a = 0; a < GLTF_ATTRIBUTE_COUNT; a++)
+		{
+			if (source.attributes[a] < 0)
+				continue;
+			const GltfAccessor &accessor = file.accessors[source.attributes[a]];
+			if (accessor.bufferView < 0)
+			{
+				glVertexAttrib4f(a, 0.0f, 0.0f, 0.0f, 0.0f);
+				continue;
+			}
+			// every glTF vertex format is a valid GL one, the accessor maps onto a pointer as it is
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[accessor.bufferView]);
+			glVertexAttribPointer(a, accessor.components, accessor.componentType, accessor.normalized ? GL_TRUE : GL_FALSE,
+				file.bufferViews[accessor.bufferView].stride, (void*)accessor.offset);
+			glEnableVertexAttribArray(a);
+		}
+
+		if (source.indices >= 0)
+		{
+			const GltfAccessor &accessor = file.accessors[source.indices];
+			primitive.count = (unsigned int)accessor.count;
+			if (accessor.componentType == GL_UNSIGNED_BYTE && accessor.bufferView >= 0)
+			{
+				// 8 bit indices are legal but slow on most drivers, the only case that gets converted
+				const unsigned char *bytes = file.data(accessor.bufferView) + accessor.offset;
+				std::vector<unsigned short> wide(bytes, bytes + accessor.count);
+				glGenBuffers(1, &primitive.indexBuffer);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, primitive.indexBuffer);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, wide.size() * sizeof(unsigned short), wide.empty() ? NULL : &wide[0], GL_STATIC_DRAW);
+				primitive.indexType = GL_UNSIGNED_SHORT;
+			}
+			else if (accessor.bufferView >= 0)
+			{
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[accessor.bufferView]);
+				primitive.indexType = accessor.componentType;
+				primitive.indexOffset = accessor.offset;
+			}
+			else
+			{
+				primitive.count = 0; // an index accessor without data is all zeros, nothing to draw
+			}
+		}
+		glBindVertexArray(0);
+		return primitive;
+	}
+
+	static unsigned int createTexture(const GltfFile &file, const GltfImage &image)
+	{
+		if (image.bufferView < 0)
+			return 0;
+		// glTF uvs start at the top left corner like the image rows, the rows go up as decoded. nothing
+		// here touches stbi_set_flip_vertically_on_load, the workers decode at the same time
+		int width, height, channels;
+		unsigned char *pixels = stbi_load_from_memory(file.data(image.bufferView), (int)file.bufferViews[image.bufferView].length, &width, &height, &channels, 4);
+		if (!pixels)
+			return 0;
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		stbi_image_free(pixels);
+		return texture;
+	}
+
+	// the bounds and what one draw() issues
+	void walk(const GltfFile &file, int node, const glm::mat4 &parent, int depth)
+	{
+		if (depth > MAX_NODE_DEPTH)
+			return;
+		glm::mat4 world = parent * nodes[node].local;
+		if (nodes[node].mesh >= 0)
+		{
+			const GltfMesh &mesh = file.meshes[nodes[node].mesh];
+			for (size_t p = 0; p < mesh.primitives.size(); p++)
+			{
+				const GltfAccessor &position = file.accessors[mesh.primitives[p].attributes[GLTF_POSITION]];
+				if (position.hasBounds)
+					bounds.grow(AABB(position.min, position.max).transformed(world));
+				const Primitive &primitive = meshes[nodes[node].mesh][p];
+				drawCalls++;
+				if (primitive.mode == GL_TRIANGLES)
+					triangles += primitive.count / 3;
+			}
+		}
+		for (size_t c = 0; c < nodes[node].children.size(); c++)
+			walk(file, nodes[node].children[c], world, depth + 1);
+	}
+
+	void drawNode(const Shader &shader, int node, const glm::mat4 &parent, int depth) const
+	{
+		if (depth > MAX_NODE_DEPTH)
+			return;
+		glm::mat4 world = parent * nodes[node].local;
+		if (nodes[node].mesh >= 0)
+		{
+			shader.setMat4("model", world);
+			const std::vector<Primitive> &primitives = meshes[nodes[node].mesh];
+			for (size_t p = 0; p < primitives.size(); p++)
+			{
+				const Primitive &primitive = primitives[p];
+				glm::vec4 baseColor(1.0f);
+				unsigned int texture = white;
+				if (primitive.material >= 0 && primitive.material < (int)materials.size())
+				{
+					const GltfMaterial &material = materials[primitive.material];
+					baseColor = material.baseColorFactor;
+					if (material.baseColorImage >= 0 && textures[material.baseColorImage])
+						texture = textures[material.baseColorImage];
+				}
+				shader.setVec4("baseColorFactor", baseColor);
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, texture);
+				glBindVertexArray(primitive.VAO);
+				if (primitive.indexType)
+					glDrawElements(primitive.mode, primitive.count, primitive.indexType, (void*)primitive.indexOffset);
+				else
+					glDrawArrays(primitive.mode, 0, primitive.count);
+			}
+		}
+		for (size_t c = 0; c < nodes[node].children.size(); c++)
+			drawNode(shader, nodes[node].children[c], world, depth + 1);
+	}
+};
+
+#endif
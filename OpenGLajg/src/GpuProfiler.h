@@ -0,0 +1,159 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include "common/profiler.hpp"
+
+#include <vector>
+
+// GPU time of each render pass from GL_TIME_ELAPSED queries (core since 3.3). the queries are
+// double buffered : a frame's are read back at the start of the frame after next, when the GPU
+// is long done with them, so timing never stalls the pipeline. only one time elapsed query can be
+// running, so passes do not nest; back to back they cover the whole frame and add up to its time.
+// with the profiler enabled the passes also go on a "GPU" track of the capture, each placed at
+// the time it was submitted. a pass cannot have taken longer than from its submission to its
+// read back, a query result beyond that is garbage from the driver : the frame is invalid, its
+// passes stay off lastFrame() and its time off frameMilliseconds() rather than a partial sum
+// ------------------------------------------------------------------------
+class GpuProfiler
+{
+public:
+	static const unsigned int MAX_PASSES = 16;
+
+	struct PassTime
+	{
+		const char *name;
+		double milliseconds;
+	};
+
+	GpuProfiler() : frame(0), invalid(0), track(NULL) {}
+
+	// reads back the frame before last, whose queries this one is about to reuse
+	void beginFrame()
+	{
+		if (!frames[0].queries[0])
+			for (unsigned int i = 0; i < 2; i++)
+				glGenQueries(MAX_PASSES, frames[i].queries);
+		collect(frames[frame % 2]);
+		frames[frame % 2].number = frame;
+	}
+	void begin(const char *pass)
+	{
+		Frame &current = frames[frame % 2];
+		if (current.count == MAX_PASSES)
+			return;
+		current.names[current.count] = pass;
+		current.submitted[current.count] = profileClock();
+		glBeginQuery(GL_TIME_ELAPSED, current.queries[current.count]);
+	}
+	void end()
+	{
+		Frame &current = frames[frame % 2];
+		if (current.count == MAX_PASSES)
+			return;
+		glEndQuery(GL_TIME_ELAPSED);
+		current.count++;
+	}
+	void endFrame() { frame++; }
+
+	// waits for the frames still in flight, after the last endFrame()
+	void finish()
+	{
+		collect(frames[frame % 2]);
+		collect(frames[(frame + 1) % 2]);
+	}
+
+	// the passes of the latest frame read back, two frames behind
+	const std::vector<PassTime> &lastFrame() const { return passes; }
+	// the GPU time of every valid frame read back so far, in order
+	const std::vector<double> &frameMilliseconds() const { return frameTimes; }
+	// which frame (counted by endFrame() from 0) each of frameMilliseconds() is
+	const std::vector<unsigned int> &frameNumbers() const { return numbers; }
+	// frames left out of frameMilliseconds() for a bogus query result
+	unsigned int invalidFrames() const { return invalid; }
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		if (frames[0].queries[0])
+			for (unsigned int i = 0; i < 2; i++)
+			{
+				glDeleteQueries(MAX_PASSES, frames[i].queries);
+				frames[i].queries[0] = 0;
+			}
+	}
+
+private:
+	struct Frame
+	{
+		unsigned int queries[MAX_PASSES];
+		const char *names[MAX_PASSES];
+		long long submitted[MAX_PASSES]; // profileClock() at begin()
+		unsigned int count;
+		unsigned int number; // the frame counter at beginFrame()
+		Frame() : count(0), number(0) { queries[0] = 0; }
+	};
+
+	Frame frames[2];
+	unsigned int frame;
+	unsigned int invalid;
+	std::vector<PassTime> passes;
+	std::vector<double> frameTimes;
+	std::vector<unsigned int> numbers;
+	ProfileTrack *track;
+
+	void collect(Frame &done)
+	{
+		if (done.count == 0)
+			return;
+		std::vector<PassTime> timed;
+		double total = 0.0;
+		bool valid = true;
+		for (unsigned int i = 0; i < done.count; i++)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(done.queries[i], GL_QUERY_RESULT, &nanoseconds);
+			long long duration = (long long)(nanoseconds / 1000);
+			if (duration > profileClock() - done.submitted[i])
+			{
+				valid = false;
+				continue;
+			}
+			PassTime pass = { done.names[i], nanoseconds / 1e6 };
+			timed.push_back(pass);
+			total += pass.milliseconds;
+			if (profilerEnabled())
+			{
+				if (!track)
+					track = newProfileTrack("GPU");
+				track->record(done.names[i], done.submitted[i], duration);
+			}
+		}
+		if (valid)
+		{
+			passes.swap(timed);
+			frameTimes.push_back(total);
+			numbers.push_back(done.number);
+		}
+		else
+			invalid++;
+		done.count = 0;
+	}
+};
+
+// times a pass on the CPU and the GPU until the end of the block
+class GpuScope
+{
+public:
+	GpuScope(GpuProfiler &profiler, const char *name) : cpu(name), profiler(profiler) { profiler.begin(name); }
+	~GpuScope() { profiler.end(); }
+
+private:
+	ProfileScope cpu;
+	GpuProfiler &profiler;
+	GpuScope(const GpuScope &);
+	GpuScope &operator=(const GpuScope &);
+};
+
+#endif
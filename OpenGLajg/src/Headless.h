@@ -0,0 +1,183 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// an OpenGL 3.3 core context without a window or a display, for benchmarks and CI agents without a GPU.
+// on Linux it comes from EGL on Mesa's surfaceless platform (EGL_MESA_platform_surfaceless, llvmpipe
+// when there is no GPU); build with HEADLESS_OSMESA to use OSMesa instead. either way the frames are
+// drawn into a framebuffer object of the size asked for, which stays bound in place of the window's.
+// elsewhere create() fails and the application keeps to its window
+// linux: g++ ... -DHEADLESS_EGL -lEGL (or -DHEADLESS_OSMESA -lOSMesa)
+#if defined(HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#elif defined(HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#include <glad/glad.h>
+
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+
+// ------------------------------------------------------------------------
+class HeadlessContext
+{
+public:
+	HeadlessContext() : width(0), height(0), framebuffer(0), color(0), depth(0)
+	{
+#if defined(HEADLESS_OSMESA)
+		context = NULL;
+#elif defined(HEADLESS_EGL)
+		display = EGL_NO_DISPLAY;
+		context = EGL_NO_CONTEXT;
+#endif
+	}
+	~HeadlessContext() { destroy(); }
+
+	// makes the context current, loads the GL functions with glad and binds a width x height
+	// framebuffer with RGBA8 color and 24 bit depth
+	bool create(int width, int height)
+	{
+		this->width = width;
+		this->height = height;
+		if (!createContext())
+			return false;
+		printf("headless : GL %s on %s, %dx%d\n", glGetString(GL_VERSION), glGetString(GL_RENDERER), width, height);
+
+		glGenRenderbuffers(1, &color);
+		glBindRenderbuffer(GL_RENDERBUFFER, color);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glGenRenderbuffers(1, &depth);
+		glBindRenderbuffer(GL_RENDERBUFFER, depth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			printf("headless : the %dx%d framebuffer is incomplete\n", width, height);
+			destroy();
+			return false;
+		}
+		glViewport(0, 0, width, height);
+		return true;
+	}
+
+	// stands in for the buffer swap : waits for the frame so its time is counted where it was spent
+	void endFrame() const { glFinish(); }
+
+	// the color buffer as RGBA rows, top row first the way image files want it
+	void readPixels(std::vector<unsigned char> &pixels) const
+	{
+		pixels.resize((size_t)width * height * 4);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+		size_t stride = (size_t)width * 4;
+		std::vector<unsigned char> row(stride);
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char *top = &pixels[y * stride], *bottom = &pixels[(height - 1 - y) * stride];
+			std::copy(top, top + stride, row.begin());
+			std::copy(bottom, bottom + stride, top);
+			std::copy(row.begin(), row.end(), bottom);
+		}
+	}
+
+	// deletes the framebuffer and the context, the GL objects of the application have to go first
+	void destroy()
+	{
+		if (framebuffer)
+		{
+			glDeleteFramebuffers(1, &framebuffer);
+			glDeleteRenderbuffers(1, &color);
+			glDeleteRenderbuffers(1, &depth);
+			framebuffer = color = depth = 0;
+		}
+#if defined(HEADLESS_OSMESA)
+		if (context)
+			OSMesaDestroyContext(context);
+		context = NULL;
+#elif defined(HEADLESS_EGL)
+		if (display != EGL_NO_DISPLAY)
+		{
+			eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			if (context != EGL_NO_CONTEXT)
+				eglDestroyContext(display, context);
+			eglTerminate(display);
+		}
+		display = EGL_NO_DISPLAY;
+		context = EGL_NO_CONTEXT;
+#endif
+	}
+
+	int width, height;
+
+private:
+	unsigned int framebuffer, color, depth;
+#if defined(HEADLESS_OSMESA)
+	OSMesaContext context;
+	std::vector<unsigned char> osmesaBuffer; // OSMesa wants a buffer to make current with, the frames go to the FBO
+
+	bool createContext()
+	{
+		const int attributes[] = { OSMESA_FORMAT, OSMESA_RGBA, OSMESA_DEPTH_BITS, 0, OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+			OSMESA_CONTEXT_MAJOR_VERSION, 3, OSMESA_CONTEXT_MINOR_VERSION, 3, 0 };
+		context = OSMesaCreateContextAttribs(attributes, NULL);
+		osmesaBuffer.resize(4);
+		if (!context || !OSMesaMakeCurrent(context, &osmesaBuffer[0], GL_UNSIGNED_BYTE, 1, 1))
+		{
+			printf("headless : no OSMesa 3.3 core context\n");
+			return false;
+		}
+		return load((GLADloadproc)OSMesaGetProcAddress);
+	}
+#elif defined(HEADLESS_EGL)
+	EGLDisplay display;
+	EGLContext context;
+
+	bool createContext()
+	{
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		EGLint major, minor;
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+		{
+			printf("headless : no surfaceless EGL display\n");
+			display = EGL_NO_DISPLAY;
+			return false;
+		}
+		// without a surface the context needs no config (EGL_KHR_no_config_context)
+		eglBindAPI(EGL_OPENGL_API);
+		const EGLint attributes[] = { EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+		context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+		if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+		{
+			printf("headless : no EGL 3.3 core context (error %x)\n", eglGetError());
+			return false;
+		}
+		return load((GLADloadproc)eglGetProcAddress);
+	}
+#else
+	bool createContext()
+	{
+		printf("headless : built without HEADLESS_EGL or HEADLESS_OSMESA\n");
+		return false;
+	}
+#endif
+
+	static bool load(GLADloadproc getProcAddress)
+	{
+		if (!gladLoadGLLoader(getProcAddress))
+		{
+			printf("headless : glad could not load the GL functions\n");
+			return false;
+		}
+		return true;
+	}
+};
+
+#endif
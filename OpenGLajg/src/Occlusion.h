@@ -0,0 +1,213 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// occlusion culling against a small software rasterized depth buffer.
+// occluder triangles are drawn on the CPU every frame, a max-depth pyramid
+// (hierarchical Z) is built from it and object bounds are rejected when their
+// nearest depth lies behind the farthest occluder depth of the pixels they cover
+// ------------------------------------------------------------------------
+class OcclusionCuller
+{
+public:
+	bool enabled;
+	unsigned int tested; // objects tested since beginFrame()
+	unsigned int culled; // objects of those that were hidden
+
+	OcclusionCuller(int width = 256, int height = 128) : enabled(true), tested(0), culled(0), width(width), height(height)
+	{
+		int w = width, h = height;
+		while (true)
+		{
+			levels.push_back(Level());
+			levels.back().width = w;
+			levels.back().height = h;
+			levels.back().depth.assign((size_t)w * h, 1.0f);
+			if (w == 1 && h == 1)
+				break;
+			// rounding up keeps every source texel under exactly one 2x2 footprint
+			w = std::max(1, (w + 1) / 2);
+			h = std::max(1, (h + 1) / 2);
+		}
+	}
+
+	// clears the depth buffer, depths are window depths in [0, 1] with 1 being the far plane
+	void beginFrame(const glm::mat4 &projectionView)
+	{
+		viewProjection = projectionView;
+		std::fill(levels[0].depth.begin(), levels[0].depth.end(), 1.0f);
+		tested = 0;
+		culled = 0;
+	}
+
+	// rasterizes indexed triangles from an interleaved float array, position is the first attribute
+	void addOccluder(const float *vertices, size_t stride, const unsigned int *indices, size_t indexCount, const glm::mat4 &model)
+	{
+		if (!enabled)
+			return;
+		glm::mat4 mvp = viewProjection * model;
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			glm::vec3 screen[3];
+			bool clipped = false;
+			for (int k = 0; k < 3; k++)
+			{
+				const float *p = vertices + indices[i + k] * stride;
+				glm::vec4 clip = mvp * glm::vec4(p[0], p[1], p[2], 1.0f);
+				// triangles crossing the near plane are skipped, losing an occluder is always safe
+				if (clip.w <= 1e-5f)
+				{
+					clipped = true;
+					break;
+				}
+				screen[k] = toWindow(clip);
+			}
+			if (!clipped)
+				rasterize(screen[0], screen[1], screen[2]);
+		}
+	}
+
+	// builds the max-depth mip chain, call once after the last occluder
+	void buildPyramid()
+	{
+		if (!enabled)
+			return;
+		for (size_t l = 1; l < levels.size(); l++)
+		{
+			const Level &src = levels[l - 1];
+			Level &dst = levels[l];
+			for (int y = 0; y < dst.height; y++)
+			{
+				int y0 = std::min(2 * y, src.height - 1), y1 = std::min(2 * y + 1, src.height - 1);
+				for (int x = 0; x < dst.width; x++)
+				{
+					int x0 = std::min(2 * x, src.width - 1), x1 = std::min(2 * x + 1, src.width - 1);
+					float d = std::max(std::max(src.at(x0, y0), src.at(x1, y0)), std::max(src.at(x0, y1), src.at(x1, y1)));
+					dst.depth[(size_t)y * dst.width + x] = d;
+				}
+			}
+		}
+	}
+
+	// false when the box is completely hidden behind the occluders
+	bool isVisible(const AABB &box)
+	{
+		if (!enabled)
+			return true;
+		tested++;
+
+		glm::vec2 lo(INFINITY), hi(-INFINITY);
+		float nearest = INFINITY;
+		for (int c = 0; c < 8; c++)
+		{
+			glm::vec3 corner((c & 1) ? box.max.x : box.min.x, (c & 2) ? box.max.y : box.min.y, (c & 4) ? box.max.z : box.min.z);
+			glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+			// boxes reaching behind the camera cannot be tested conservatively
+			if (clip.w <= 1e-5f)
+				return true;
+			glm::vec3 p = toWindow(clip);
+			lo = glm::min(lo, glm::vec2(p));
+			hi = glm::max(hi, glm::vec2(p));
+			nearest = std::min(nearest, p.z);
+		}
+		if (nearest <= 0.0f)
+			return true;
+
+		int x0 = std::max(0, (int)std::floor(lo.x)), y0 = std::max(0, (int)std::floor(lo.y));
+		int x1 = std::min(width - 1, (int)std::ceil(hi.x)), y1 = std::min(height - 1, (int)std::ceil(hi.y));
+		if (x0 > x1 || y0 > y1)
+			return true; // off screen, frustum culling deals with it
+
+		// pick the level where the rectangle spans at most four texels per axis
+		size_t l = 0;
+		while (l + 1 < levels.size() && ((x1 >> l) - (x0 >> l) > 3 || (y1 >> l) - (y0 >> l) > 3))
+			l++;
+		const Level &level = levels[l];
+		float farthest = 0.0f;
+		for (int y = y0 >> l; y <= std::min(y1 >> l, level.height - 1); y++)
+			for (int x = x0 >> l; x <= std::min(x1 >> l, level.width - 1); x++)
+				farthest = std::max(farthest, level.at(x, y));
+
+		if (nearest > farthest)
+		{
+			culled++;
+			return false;
+		}
+		return true;
+	}
+
+private:
+	struct Level
+	{
+		int width;
+		int height;
+		std::vector<float> depth;
+		float at(int x, int y) const { return depth[(size_t)y * width + x]; }
+	};
+
+	int width;
+	int height;
+	glm::mat4 viewProjection;
+	std::vector<Level> levels;
+
+	glm::vec3 toWindow(const glm::vec4 &clip) const
+	{
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		return glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+	}
+
+	static float edge(const glm::vec3 &a, const glm::vec3 &b, float x, float y)
+	{
+		return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+	}
+
+	// half-space rasterizer sampling pixel centres, keeps the nearest depth
+	void rasterize(glm::vec3 a, glm::vec3 b, glm::vec3 c)
+	{
+		float area = edge(a, b, c.x, c.y);
+		if (std::fabs(area) < 1e-8f)
+			return;
+		// both windings are occluders, the car meshes are not consistently wound
+		if (area < 0.0f)
+		{
+			std::swap(b, c);
+			area = -area;
+		}
+
+		int minX = std::max(0, (int)std::floor(std::min(a.x, std::min(b.x, c.x))));
+		int minY = std::max(0, (int)std::floor(std::min(a.y, std::min(b.y, c.y))));
+		int maxX = std::min(width - 1, (int)std::ceil(std::max(a.x, std::max(b.x, c.x))));
+		int maxY = std::min(height - 1, (int)std::ceil(std::max(a.y, std::max(b.y, c.y))));
+		if (minX > maxX || minY > maxY)
+			return;
+
+		std::vector<float> &depth = levels[0].depth;
+		float invArea = 1.0f / area;
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			for (int x = minX; x <= maxX; x++)
+			{
+				float px = x + 0.5f;
+				float w0 = edge(b, c, px, py);
+				float w1 = edge(c, a, px, py);
+				float w2 = edge(a, b, px, py);
+				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+					continue;
+				float z = (w0 * a.z + w1 * b.z + w2 * c.z) * invArea;
+				float &d = depth[(size_t)y * width + x];
+				if (z < d)
+					d = z;
+			}
+		}
+	}
+};
+
+#endif
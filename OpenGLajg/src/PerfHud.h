@@ -0,0 +1,356 @@
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include <glad/glad.h>
+
+#include "shader.h"
+
+// stb_easy_font defines a global, so this header belongs to one translation unit (application.cpp)
+#include <stb_easy_font.h>
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include <stdio.h>
+
+// what a frame asked of the driver, counted where the application issues the calls
+// ------------------------------------------------------------------------
+struct RenderStats
+{
+	unsigned int drawCalls;
+	unsigned long long triangles;
+	unsigned int stateChanges; // programs, vertex arrays and textures bound
+
+	RenderStats() { reset(); }
+	void reset() { drawCalls = 0; triangles = 0; stateChanges = 0; }
+	void draw(unsigned long long triangleCount, unsigned int instances = 1)
+	{
+		drawCalls++;
+		triangles += triangleCount * instances;
+	}
+	void state(unsigned int count = 1) { stateChanges += count; }
+};
+
+// the performance overlay in the top left corner : graphs of the last frame times on the CPU
+// and the GPU, the frame's draw calls, triangles, state changes, rain drops and occlusion culling, and the
+// texture memory. the text only changes a few times a second, averaged over the frames in between :
+// its stb_easy_font quads are filled into a coverage mask on the CPU then and uploaded to the one
+// of two textures the last frames did not draw with, so the upload does not wait on them. a frame
+// draws five quads from a static vertex buffer, the panel, a quad a graph whose bars hud.fs cuts
+// from a uniform array of heights, and the 60 Hz lines, so all it sends is a few hundred floats
+// of uniforms
+// ------------------------------------------------------------------------
+class PerfHud
+{
+public:
+	static const unsigned int HISTORY = 120;      // frames in the graphs
+	static const unsigned int MAX_QUADS = 4096;   // of text
+	static const unsigned int GRAPH_WIDTH = 120;  // overlay pixels, a bar per frame
+	static const unsigned int GRAPH_HEIGHT = 30;  // for GRAPH_MS
+	static const unsigned int GRAPH_MS = 33;      // the top of the graphs, 2 frames at 60 Hz
+	static const unsigned int TEXT_REFRESH = 250; // milliseconds between text updates
+
+	struct Input
+	{
+		unsigned int particles;
+		unsigned int particlesDrawn;
+		size_t textureBytes; // what the application knows it has resident
+		bool occlusion;      // OcclusionCuller on, and what it saw this frame
+		unsigned int occlusionTested;
+		unsigned int occlusionCulled;
+	};
+
+	PerfHud() : VAO(0), VBO(0), EBO(0), panel(0), panelWidth(0), panelHeight(0), screenSizeLocation(-1), scaleLocation(-1), barsLocation(-1),
+		next(0), sumCpu(0.0), sumGpu(0.0), sumHud(0.0), sumFrames(0), textQuads(0), textLines(0), textWidth(0),
+		lastHudMs(0.0), checkedMemoryInfo(false), memoryInfo(false)
+	{
+		memset(cpuHistory, 0, sizeof(cpuHistory));
+		memset(gpuHistory, 0, sizeof(gpuHistory));
+		memset(panels, 0, sizeof(panels));
+		memset(textureWidth, 0, sizeof(textureWidth));
+		memset(textureHeight, 0, sizeof(textureHeight));
+	}
+
+	// the frame just finished : its CPU time and the latest GPU time read back (two frames behind)
+	void addFrame(double cpuMs, double gpuMs)
+	{
+		cpuHistory[next] = (float)cpuMs;
+		gpuHistory[next] = (float)gpuMs;
+		next = (next + 1) % HISTORY;
+		sumCpu += cpuMs;
+		sumGpu += gpuMs;
+		sumHud += lastHudMs;
+		sumFrames++;
+	}
+
+	// draws over whatever is in the framebuffer, leaves depth testing on and blending off as the
+	// scene has them
+	void draw(Shader &shader, const RenderStats &stats, const Input &input, unsigned int width, unsigned int height)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		if (!VAO)
+			create(shader);
+
+		glDisable(GL_DEPTH_TEST);
+		shader.use();
+		glBindVertexArray(VAO);
+		if (!panelWidth || (sumFrames && std::chrono::duration<double, std::milli>(start - lastText).count() >= TEXT_REFRESH))
+		{
+			if (sumFrames)
+				buildText(stats, input);
+			buildQuads();
+			paintPanel();
+			lastText = start;
+		}
+
+		// the bar heights as fractions of the graph, oldest on the left. the frames not seen yet are zero
+		for (unsigned int i = 0; i < HISTORY; i++)
+		{
+			unsigned int frame = (next + i) % HISTORY;
+			barHeights[i] = std::min(cpuHistory[frame] / GRAPH_MS, 1.0f);
+			barHeights[HISTORY + i] = std::min(gpuHistory[frame] / GRAPH_MS, 1.0f);
+		}
+
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glUniform2f(screenSizeLocation, (float)width, (float)height);
+		glUniform1f(scaleLocation, height >= 720 ? 2.0f : 1.0f);
+		glUniform4fv(barsLocation, 2 * HISTORY / 4, barHeights);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, panels[panel]);
+		glDrawElements(GL_TRIANGLES, FRAME_QUADS * 6, GL_UNSIGNED_SHORT, 0);
+		glBindVertexArray(0);
+		glDisable(GL_BLEND);
+		glEnable(GL_DEPTH_TEST);
+
+		lastHudMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		if (VAO)
+		{
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+			glDeleteBuffers(1, &EBO);
+			glDeleteTextures(2, panels);
+			VAO = VBO = EBO = 0;
+			memset(panels, 0, sizeof(panels));
+		}
+	}
+
+private:
+	// stb_easy_font's vertex : x, y, z and an RGBA byte color
+	struct Vertex
+	{
+		float x, y, z;
+		unsigned char color[4];
+	};
+	struct Quad
+	{
+		Vertex corners[4];
+	};
+
+	static const unsigned int FRAME_QUADS = 5; // the vertex buffer
+	static const unsigned int MARGIN = 4;
+	static const unsigned int TEXT_TOP = 4;
+	static const unsigned int LINE_HEIGHT = 10; // stb_easy_font's glyphs are 7 high
+	static const unsigned int GRAPH_GAP = 4;
+	static const unsigned int PANEL = 0xb0000000; // colors as ABGR words, the bytes RGBA in memory
+	static const unsigned int CPU = 0xff40d040;
+	static const unsigned int GPU = 0xff2090f0;
+	static const unsigned int BUDGET = 0x80ffffff;
+	// what hud.fs does with a quad, its vertices' z. stb_easy_font writes 0
+	static const int COLOR = 0;
+	static const int PANEL_TEXTURE = 1;
+	static const int CPU_GRAPH = 2;
+	static const int GPU_GRAPH = 3;
+
+	unsigned int VAO, VBO, EBO;
+	unsigned int panels[2]; // the text's mask, a texel an overlay pixel
+	unsigned int textureWidth[2], textureHeight[2]; // as they were last allocated
+	unsigned int panel; // the one drawn
+	unsigned int panelWidth, panelHeight;
+	int screenSizeLocation, scaleLocation, barsLocation; // looked up once, the HUD's program is the only one drawn with
+	float cpuHistory[HISTORY];
+	float gpuHistory[HISTORY];
+	unsigned int next;
+	double sumCpu, sumGpu, sumHud; // since the text was last built
+	unsigned int sumFrames;
+	float barHeights[2 * HISTORY]; // hud.fs's bars : the CPU graph, then the GPU graph
+	std::vector<Quad> glyphs;   // the text as stb_easy_font wrote it
+	std::vector<unsigned char> mask; // of the text over the panel, 255 where it is
+	unsigned int textQuads;
+	unsigned int textLines;
+	unsigned int textWidth;
+	double lastHudMs;
+	std::chrono::high_resolution_clock::time_point lastText;
+	bool checkedMemoryInfo, memoryInfo;
+
+	void create(Shader &shader)
+	{
+		screenSizeLocation = glGetUniformLocation(shader.ID, "screenSize");
+		scaleLocation = glGetUniformLocation(shader.ID, "scale");
+		barsLocation = glGetUniformLocation(shader.ID, "bars");
+
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+		glGenBuffers(1, &EBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, FRAME_QUADS * sizeof(Quad), NULL, GL_DYNAMIC_DRAW);
+		// z says what a quad is, see hud.fs
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		// every quad is two triangles of the same four corners
+		std::vector<unsigned short> indices(FRAME_QUADS * 6);
+		for (unsigned int q = 0; q < FRAME_QUADS; q++)
+		{
+			unsigned short corner = (unsigned short)(q * 4);
+			unsigned short corners[6] = { corner, (unsigned short)(corner + 1), (unsigned short)(corner + 2),
+				corner, (unsigned short)(corner + 2), (unsigned short)(corner + 3) };
+			memcpy(&indices[q * 6], corners, sizeof(corners));
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), &indices[0], GL_STATIC_DRAW);
+		glBindVertexArray(0);
+		glyphs.resize(MAX_QUADS);
+
+		glGenTextures(2, panels);
+		for (int i = 0; i < 2; i++)
+		{
+			glBindTexture(GL_TEXTURE_2D, panels[i]);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		}
+	}
+
+	// the free and total video memory of NVIDIA drivers (GL_NVX_gpu_memory_info), in KB
+	bool driverMemory(int &freeKB, int &totalKB)
+	{
+		if (!checkedMemoryInfo)
+		{
+			int count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (int i = 0; i < count; i++)
+				memoryInfo = memoryInfo || strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), "GL_NVX_gpu_memory_info") == 0;
+			checkedMemoryInfo = true;
+		}
+		if (!memoryInfo)
+			return false;
+		glGetIntegerv(0x9048, &totalKB); // GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
+		glGetIntegerv(0x9049, &freeKB);  // GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+		return true;
+	}
+
+	void buildText(const RenderStats &stats, const Input &input)
+	{
+		double cpu = sumCpu / sumFrames, gpu = sumGpu / sumFrames, hud = sumHud / sumFrames;
+		sumCpu = sumGpu = sumHud = 0.0;
+		sumFrames = 0;
+
+		char text[512];
+		int length = snprintf(text, sizeof(text),
+			"cpu %6.2f ms %4.0f fps\ngpu %6.2f ms\nhud %6.3f ms\n"
+			"draws %u  tris %llu\nstate changes %u\nrain %u / %u drawn\nocclusion %s %u / %u culled\ntextures %.1f MB",
+			cpu, cpu > 0.0 ? 1000.0 / cpu : 0.0, gpu, hud,
+			stats.drawCalls, stats.triangles, stats.stateChanges,
+			input.particlesDrawn, input.particles, input.occlusion ? "on" : "off", input.occlusionCulled, input.occlusionTested,
+			input.textureBytes / (1024.0 * 1024.0));
+		int freeKB = 0, totalKB = 0;
+		if (driverMemory(freeKB, totalKB) && length < (int)sizeof(text))
+			snprintf(text + length, sizeof(text) - length, "\nvideo memory %d / %d MB free", freeKB / 1024, totalKB / 1024);
+
+		textLines = 1;
+		for (const char *c = text; *c; c++)
+			textLines += *c == '\n';
+		textWidth = stb_easy_font_width(text);
+		// stb_easy_font spaces lines 12 apart, one print a line keeps them tighter. the text stays
+		// in glyphs until the next time
+		unsigned char white[4] = { 255, 255, 255, 255 };
+		unsigned int written = 0;
+		float y = (float)TEXT_TOP;
+		for (char *line = strtok(text, "\n"); line; line = strtok(NULL, "\n"))
+		{
+			written += stb_easy_font_print((float)MARGIN, y, line, white, &glyphs[written], (int)((glyphs.size() - written) * sizeof(Quad)));
+			y += LINE_HEIGHT;
+		}
+		textQuads = written;
+	}
+
+	// the frame's quads : the panel texture, the graphs and their 60 Hz lines, uploaded whenever the
+	// text changes as that moves the graphs
+	void buildQuads()
+	{
+		float graphTop = (float)(TEXT_TOP + textLines * LINE_HEIGHT + GRAPH_GAP);
+		float gpuTop = graphTop + GRAPH_HEIGHT + GRAPH_GAP;
+		panelWidth = (std::max(GRAPH_WIDTH, textWidth) + 2 * MARGIN + 3) & ~3u; // mask rows on the default 4 byte unpack alignment
+		panelHeight = (unsigned int)gpuTop + GRAPH_HEIGHT + GRAPH_GAP;
+		Quad quads[FRAME_QUADS] = {
+			quad(0.0f, 0.0f, (float)panelWidth, (float)panelHeight, PANEL, PANEL_TEXTURE),
+			quad((float)MARGIN, graphTop, (float)(MARGIN + GRAPH_WIDTH), graphTop + GRAPH_HEIGHT, CPU, CPU_GRAPH),
+			quad((float)MARGIN, gpuTop, (float)(MARGIN + GRAPH_WIDTH), gpuTop + GRAPH_HEIGHT, GPU, GPU_GRAPH),
+			budgetLine(graphTop),
+			budgetLine(gpuTop)
+		};
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(quads), quads, GL_DYNAMIC_DRAW); // a new store, no wait on the last draw
+	}
+
+	// the text's mask. stb_easy_font's quads are rectangles on whole pixels
+	void paintPanel()
+	{
+		mask.assign(panelWidth * panelHeight, 0);
+		for (unsigned int q = 0; q < textQuads; q++)
+		{
+			const Vertex &topLeft = glyphs[q].corners[0], &bottomRight = glyphs[q].corners[2];
+			unsigned int x0 = (unsigned int)std::max(topLeft.x + 0.5f, 0.0f), x1 = std::min((unsigned int)std::max(bottomRight.x + 0.5f, 0.0f), panelWidth);
+			unsigned int y0 = (unsigned int)std::max(topLeft.y + 0.5f, 0.0f), y1 = std::min((unsigned int)std::max(bottomRight.y + 0.5f, 0.0f), panelHeight);
+			for (unsigned int y = y0; y < y1; y++)
+				if (x0 < x1)
+					memset(&mask[y * panelWidth + x0], 255, x1 - x0);
+		}
+
+		panel = 1 - panel;
+		glBindTexture(GL_TEXTURE_2D, panels[panel]);
+		if (panelWidth == textureWidth[panel] && panelHeight == textureHeight[panel])
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, panelWidth, panelHeight, GL_RED, GL_UNSIGNED_BYTE, &mask[0]);
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, panelWidth, panelHeight, 0, GL_RED, GL_UNSIGNED_BYTE, &mask[0]);
+			textureWidth[panel] = panelWidth;
+			textureHeight[panel] = panelHeight;
+		}
+	}
+
+	static Quad quad(float x0, float y0, float x1, float y1, unsigned int color, int kind = COLOR)
+	{
+		Quad q;
+		float points[4][2] = { { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 } };
+		for (int i = 0; i < 4; i++)
+		{
+			Vertex &v = q.corners[i];
+			v.x = points[i][0];
+			v.y = points[i][1];
+			v.z = (float)kind;
+			memcpy(v.color, &color, 4);
+		}
+		return q;
+	}
+
+	// a line at 60 Hz across a graph
+	static Quad budgetLine(float top)
+	{
+		float budget = top + GRAPH_HEIGHT - GRAPH_HEIGHT * (1000.0f / 60.0f) / GRAPH_MS;
+		return quad((float)MARGIN, budget, (float)(MARGIN + GRAPH_WIDTH), budget + 1.0f, BUDGET);
+	}
+};
+
+#endif
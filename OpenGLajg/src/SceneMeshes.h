@@ -0,0 +1,238 @@
+#ifndef SCENE_MESHES_H
+#define SCENE_MESHES_H
+
+#include "common/meshfile.hpp"
+
+#include <vector>
+
+// hand-typed meshes of the scene. tools/meshconv writes them to model/*.mesh, the
+// application loads those files and only falls back to these arrays when they are missing
+// ------------------------------------------------------------------------
+
+// car body : position, color, texture coordinate and normal per vertex
+static const float carBodyVertices[] = {
+	-0.5f, -0.7f,  0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, //0
+	 0.5f, -0.7f,  0.0f, 1.0f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//1
+	-0.5f, -0.2f,  0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//2
+	 0.5f, -0.2f,  0.0f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//3
+	 0.5f, -0.7f, -0.5f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//4
+	 0.5f, -0.2f, -0.5f, 1.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,//5
+	-0.5f, -0.2f, -0.5f, 1.0f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//6
+	-0.5f, -0.7f, -0.5f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//7
+	 0.5f,  0.2f, -0.65f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//8
+	-0.5f,  0.2f, -0.65f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//9
+	-0.5f,  0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//10
+	 0.5f,  0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//11
+	 0.5f, -0.7f, -1.5f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//12
+	-0.5f, -0.7f, -1.5f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//13
+	 0.45f, -0.2f, -0.499f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,//14
+	-0.45f, -0.2f, -0.499f, 0.77f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//15
+	0.45f,  0.15f, -0.63f, 0.77f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//16
+	-0.45f,  0.15f, -0.63f, 0.77f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//17
+
+	 0.5f,  -0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//18
+	 -0.5f, -0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,// 19
+
+	 //0.51f,  0.15f, -0.7f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f,//8 20
+	 //0.51f,  0.15f, -1.4f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f,//11 21
+	 //0.51f, -0.15f, -0.6f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f,//5 22
+	 //0.51f,  -0.15f, -1.4f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f,//18 23
+
+	 0.501f,  0.15f, -0.7f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//8 20
+	 0.501f,  0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//11 21
+	 0.501f, -0.15f, -0.6f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//5 22
+	 0.501f,  -0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//18 23
+
+	 0.501f,  0.15f, -1.1f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//8 24
+	 0.501f,  0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 25
+	 0.501f, -0.15f, -1.1f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//5 26
+	 0.501f,  -0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//18 27
+
+	 -0.501f,  0.15f, -0.7f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//8 28
+	 -0.501f,  0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 29
+	 -0.501f, -0.15f, -0.6f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//5 30
+	 -0.501f,  -0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//18 31
+
+	 -0.501f,  0.15f, -1.1f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//8 32
+	 -0.501f,  0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 33
+	 -0.501f, -0.15f, -1.1f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//5 34
+	 -0.501f,  -0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//18 35
+
+	 -0.45f,  0.15f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//10 36
+	 0.45f,  0.15f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 37
+	 0.45f, -0.2f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//12 38
+	 -0.45f, -0.2f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//13 39
+
+	 -0.4f, -0.425f,  0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//40
+	 0.4f, -0.425f,  0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,//41
+	 -0.4f, -0.25f,  0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,//42
+	 0.4f, -0.25f,  0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f//43
+};
+
+static const unsigned int carBodyIndices[] = {
+	0, 1, 2,
+	1, 2, 3,
+	1, 3, 4,
+	3, 4, 5,
+	2, 3, 6,
+	3, 5, 6,
+	0, 2, 7,
+	2, 7, 6,
+	0, 1, 7,
+	1, 4, 7,
+	6, 5, 8,
+	6, 8, 9,
+	8, 9, 10,
+	8, 10, 11,
+	5, 8, 18,
+	8, 11, 18,
+	4,5,12,
+	5,12,18,
+	10, 13, 12,
+	10, 11, 12,
+	9, 10, 19,
+	6, 9, 19,
+	6, 7, 13,
+	6, 13, 19,
+	7, 4, 13,
+	13,12,4,
+	14, 15, 17,
+	14, 17, 16,
+
+	20,21,22,
+	22,23,21,
+
+	24,25,26,
+	26,27,25,
+
+	28,29,30,
+	30,31,29,
+
+	32,33,34,
+	34,35,33,
+
+	36,37,38,
+	38,39,36,
+
+	40,41,42,
+	41,42,43
+};
+
+
+// lamp cube : position and normal, drawn without indices
+static const float lampCubeVertices[] = {
+	-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+	 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+	 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+	 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+	-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+
+	-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+	 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+	 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+	 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+	-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+	-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
+
+	-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+	-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+	-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+	-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+	-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+	-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+
+	 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+	 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+	 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+	 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+	 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+	 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+
+	-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+	 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+	 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+	 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+	-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+	-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+
+	-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+	 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+	 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+	 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+	-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+	-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
+};
+
+
+// rain drop : a small prism, positions only
+static const float rainDropVertices[] = {
+	-0.5f, -0.5f, 0.0f,
+	 0.5f, -0.5f, 0.0f,
+	 0.0f, 0.5f, 0.0f,
+
+	-0.5f, -0.5f, 0.5f,
+	 0.5f, -0.5f, 0.5f,
+	 0.0f, 0.5f, 0.5f
+};
+
+static const unsigned int rainDropIndices[] = {
+	0, 1, 2,
+	3, 4, 5,
+	0, 3, 2,
+	2, 5, 3,
+	0, 3, 1,
+	1, 4, 3,
+	2, 5, 1,
+	1, 4, 5
+};
+
+
+inline MeshView arrayMeshView(const float *vertices, const unsigned int *indices, size_t indexCount)
+{
+	MeshView mesh = MeshView();
+	mesh.vertices = vertices;
+	mesh.indices = indices;
+	mesh.indexCount = (unsigned int)indexCount;
+	mesh.indexSize = sizeof(unsigned int);
+	return mesh;
+}
+
+inline MeshView carBodyMesh()
+{
+	MeshView mesh = arrayMeshView(carBodyVertices, carBodyIndices, sizeof(carBodyIndices) / sizeof(unsigned int));
+	mesh.layout.stride = 11 * sizeof(float);
+	mesh.layout.attributeCount = 4;
+	mesh.layout.attributes[0] = meshAttribute(0, 3, MESH_FLOAT, 0);
+	mesh.layout.attributes[1] = meshAttribute(1, 3, MESH_FLOAT, 3 * sizeof(float));
+	mesh.layout.attributes[2] = meshAttribute(2, 2, MESH_FLOAT, 6 * sizeof(float));
+	mesh.layout.attributes[3] = meshAttribute(3, 3, MESH_FLOAT, 8 * sizeof(float));
+	mesh.vertexCount = sizeof(carBodyVertices) / mesh.layout.stride;
+	computeMeshBounds(mesh);
+	return mesh;
+}
+
+inline MeshView lampCubeMesh()
+{
+	MeshView mesh = arrayMeshView(lampCubeVertices, NULL, 0);
+	mesh.layout.stride = 6 * sizeof(float);
+	mesh.layout.attributeCount = 2;
+	mesh.layout.attributes[0] = meshAttribute(0, 3, MESH_FLOAT, 0);
+	mesh.layout.attributes[1] = meshAttribute(1, 3, MESH_FLOAT, 3 * sizeof(float));
+	mesh.vertexCount = sizeof(lampCubeVertices) / mesh.layout.stride;
+	computeMeshBounds(mesh);
+	return mesh;
+}
+
+inline MeshView rainDropMesh()
+{
+	MeshView mesh = arrayMeshView(rainDropVertices, rainDropIndices, sizeof(rainDropIndices) / sizeof(unsigned int));
+	mesh.layout.stride = 3 * sizeof(float);
+	mesh.layout.attributeCount = 1;
+	mesh.layout.attributes[0] = meshAttribute(0, 3, MESH_FLOAT, 0);
+	mesh.vertexCount = sizeof(rainDropVertices) / mesh.layout.stride;
+	computeMeshBounds(mesh);
+	return mesh;
+}
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef SKIN_ARRAY_H
+#define SKIN_ARRAY_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "common/imageresize.hpp"
+#include "common/texturefile.hpp"
+#include "common/profiler.hpp"
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <stdio.h>
+
+// car skins as the layers of one GL_TEXTURE_2D_ARRAY, so an instanced draw picks a skin per
+// instance instead of binding a texture per car. workers decode every file and resize it to the
+// size of the array (stb_image_resize, in linear light) and build its mip chain (generateMipChain),
+// update() copies the finished layers in on the GL thread. layers that are not in yet are plain grey.
+// the array starts at its levels up to startSize pixels; setWantedLevel() streams finer levels in one
+// per update (for every layer at once, from the chains kept in memory) or drops them again
+// ------------------------------------------------------------------------
+class SkinArray
+{
+public:
+	SkinArray(int width = 1024, int height = 1024, unsigned int workerCount = 2, int startSize = 128)
+		: width(width), height(height), startSize(startSize), textureArray(0), levels(1), residentLevel(0), wantedLevel(-1), stopping(false)
+	{
+		for (unsigned int i = 0; i < std::max(1u, workerCount); i++)
+			workers.push_back(std::thread(&SkinArray::work, this));
+	}
+	~SkinArray()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+
+	// queues a skin and returns its layer. the array is allocated at the first update(), every
+	// layer has to be added before that
+	int add(const char *path, bool flip = true)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (textureArray)
+		{
+			printf("%s : skins have to be added before the array is allocated\n", path);
+			return -1;
+		}
+		Layer layer;
+		layer.path = path;
+		layer.flip = flip;
+		layers.push_back(layer);
+		jobs.push_back((int)layers.size() - 1);
+		wake.notify_one();
+		return (int)layers.size() - 1;
+	}
+
+	// GL thread, once per frame : allocates the array the first time, copies in the resident levels
+	// of the layers the workers finished, then moves one level towards the wanted one
+	void update()
+	{
+		PROFILE_SCOPE("stream skins");
+		if (!textureArray && !layers.empty())
+			allocate();
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t i = 0; i < layers.size(); i++)
+		{
+			Layer &layer = layers[i];
+			if (layer.state != DECODED)
+				continue;
+			for (int level = residentLevel; level < levels; level++)
+				uploadLayer((int)i, level);
+			layer.state = RESIDENT;
+		}
+		int target = targetLevel();
+		if (target < residentLevel)
+		{
+			// a level finer, allocated and filled for every layer before the sampler may reach it
+			int level = residentLevel - 1;
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(1, width >> level), std::max(1, height >> level), (GLsizei)layers.size(), 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			for (size_t i = 0; i < layers.size(); i++)
+				uploadLayer((int)i, level);
+			residentLevel = level;
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, residentLevel);
+		}
+		else if (target > residentLevel)
+		{
+			// the levels above the target are given back, respecified empty
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, target);
+			for (int level = residentLevel; level < target; level++)
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			residentLevel = target;
+		}
+	}
+
+	// finest level to keep resident, clamped to the levels the array has; -1 for the start level
+	void setWantedLevel(int level) { wantedLevel = level; }
+	int resident() const { return residentLevel; }
+	int levelCount() const { return levels; }
+	int startLevel() const
+	{
+		int level = 0;
+		while ((std::max(width, height) >> level) > startSize && (std::max(width, height) >> (level + 1)) > 0)
+			level++;
+		return level;
+	}
+	// GPU bytes of the array from level first down
+	size_t levelBytes(int first) const
+	{
+		size_t bytes = 0;
+		for (int level = std::max(first, 0); (std::max(width, height) >> level) > 0; level++)
+			bytes += (size_t)std::max(1, width >> level) * std::max(1, height >> level) * 4 * layers.size();
+		return bytes;
+	}
+
+	unsigned int texture() const { return textureArray; }
+	int layerCount() const { return (int)layers.size(); }
+	// skins still decoding or waiting for update()
+	size_t pending() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t count = 0;
+		for (size_t i = 0; i < layers.size(); i++)
+			count += layers[i].state == QUEUED || layers[i].state == DECODED;
+		return count;
+	}
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		if (textureArray)
+			glDeleteTextures(1, &textureArray);
+		textureArray = 0;
+	}
+
+private:
+	enum State { QUEUED, DECODED, RESIDENT, FAILED };
+	struct Layer
+	{
+		std::string path;
+		bool flip;
+		State state;
+		TextureImage chain; // RGBA8 at the size of the array, kept to stream levels in again
+		Layer() : flip(true), state(QUEUED) {}
+	};
+
+	int width, height;
+	int startSize;
+	unsigned int textureArray;
+	int levels;
+	int residentLevel; // finest level allocated, the array's BASE_LEVEL
+	int wantedLevel;
+	std::vector<unsigned char> grey;
+	std::deque<Layer> layers; // a deque, the workers keep writing to layers while add() appends
+	std::deque<int> jobs;
+	std::vector<std::thread> workers;
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping;
+
+	int targetLevel() const
+	{
+		return wantedLevel < 0 ? startLevel() : std::min(wantedLevel, levels - 1);
+	}
+
+	// one level of a layer from its chain, grey while it has none
+	void uploadLayer(int layer, int level)
+	{
+		const TextureImage &chain = layers[layer].chain;
+		const unsigned char *pixels = chain.levels.empty() ? &grey[0] : &chain.data[chain.levels[level].offset];
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, std::max(1, width >> level), std::max(1, height >> level), 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	}
+
+	void allocate()
+	{
+		while ((std::max(width, height) >> levels) > 0)
+			levels++;
+		residentLevel = targetLevel();
+		glGenTextures(1, &textureArray);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, residentLevel);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		// grey until the skins come in
+		grey.assign((size_t)width * height * 4, 112);
+		for (int level = residentLevel; level < levels; level++)
+		{
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(1, width >> level), std::max(1, height >> level), (GLsizei)layers.size(), 0,
+				GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			for (size_t i = 0; i < layers.size(); i++)
+				uploadLayer((int)i, level);
+		}
+	}
+
+	void work()
+	{
+		setProfileThreadName("skin worker");
+		for (;;)
+		{
+			int job;
+			std::string path;
+			bool flip;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (stopping)
+					return;
+				job = jobs.front();
+				jobs.pop_front();
+				path = layers[job].path;
+				flip = layers[job].flip;
+			}
+			PROFILE_SCOPE("decode skin");
+			int sourceWidth, sourceHeight, channels;
+			unsigned char *source = stbi_load(path.c_str(), &sourceWidth, &sourceHeight, &channels, 4);
+			std::vector<unsigned char> pixels;
+			if (source)
+			{
+				pixels.resize((size_t)width * height * 4);
+				if (sourceWidth == width && sourceHeight == height)
+					std::copy(source, source + pixels.size(), pixels.begin());
+				else if (!resizeImage(source, sourceWidth, sourceHeight, 4, &pixels[0], width, height, true))
+					pixels.clear();
+				stbi_image_free(source);
+				if (flip && !pixels.empty())
+					flipImageRows(&pixels[0], (size_t)width * 4, height);
+			}
+			else
+				printf("%s could not be decoded : %s\n", path.c_str(), stbi_failure_reason());
+			TextureImage chain;
+			if (!pixels.empty())
+				generateMipChain(&pixels[0], width, height, MipChainOptions(), chain);
+			std::lock_guard<std::mutex> lock(mutex);
+			layers[job].chain.levels.swap(chain.levels);
+			layers[job].chain.data.swap(chain.data);
+			layers[job].state = pixels.empty() ? FAILED : DECODED;
+		}
+	}
+};
+
+#endif
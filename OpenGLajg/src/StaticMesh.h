@@ -0,0 +1,134 @@
+#ifndef STATIC_MESH_H
+#define STATIC_MESH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+#include "common/meshfile.hpp"
+#include "common/profiler.hpp"
+
+#include <vector>
+
+// how a vertex shader gets model space positions back from quantized ones :
+// position = offset + scale * aPos, uniforms positionScale and positionOffset
+struct PositionDecode
+{
+	glm::vec3 scale;
+	glm::vec3 offset;
+
+	PositionDecode() : scale(1.0f), offset(0.0f) {}
+	// identity for float positions, the bounds for positions stored relative to them
+	explicit PositionDecode(const MeshView &mesh) : scale(1.0f), offset(0.0f)
+	{
+		if (!meshPositionsQuantized(mesh.layout))
+			return;
+		offset = glm::vec3(mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2]);
+		scale = glm::vec3(mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2]) - offset;
+	}
+};
+
+// GPU copy of a mesh in the .mesh layout : one VAO with an interleaved vertex buffer,
+// an optional element buffer and the LOD ranges inside it
+// ------------------------------------------------------------------------
+class StaticMesh
+{
+public:
+	unsigned int VAO;
+	unsigned int indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	std::vector<MeshLod> lods; // always at least one level when indexed
+	AABB bounds;
+	PositionDecode decode;
+
+	StaticMesh() : VAO(0), indexType(GL_UNSIGNED_INT), vertexCount(0), indexCount(0), VBO(0), EBO(0) {}
+
+	// maps a .mesh file and uploads straight from the mapping, false when it is missing or invalid
+	bool load(const char *path)
+	{
+		PROFILE_SCOPE("load static mesh");
+		MeshFile file;
+		if (!file.open(path))
+			return false;
+		upload(file.view());
+		return true;
+	}
+
+	void upload(const MeshView &mesh)
+	{
+		PROFILE_SCOPE("upload static mesh");
+		if (!VAO)
+		{
+			glGenVertexArrays(1, &VAO);
+			glGenBuffers(1, &VBO);
+		}
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)mesh.vertexCount * mesh.layout.stride, mesh.vertices, GL_STATIC_DRAW);
+		for (unsigned int i = 0; i < mesh.layout.attributeCount; i++)
+		{
+			const MeshAttribute &a = mesh.layout.attributes[i];
+			glVertexAttribPointer(a.location, a.components, a.type, a.normalized ? GL_TRUE : GL_FALSE, mesh.layout.stride, (void*)(size_t)a.offset);
+			glEnableVertexAttribArray(a.location);
+		}
+
+		vertexCount = mesh.vertexCount;
+		indexCount = mesh.indices ? mesh.indexCount : 0;
+		indexType = mesh.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		if (indexCount)
+		{
+			if (!EBO)
+				glGenBuffers(1, &EBO);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCount * mesh.indexSize, mesh.indices, GL_STATIC_DRAW);
+		}
+		glBindVertexArray(0);
+
+		lods.clear();
+		if (mesh.lods)
+			lods.assign(mesh.lods, mesh.lods + mesh.lodCount);
+		else if (indexCount)
+		{
+			MeshLod all = { 0, indexCount, 0, 0.0f };
+			lods.push_back(all);
+		}
+		decode = PositionDecode(mesh);
+		bounds = AABB(glm::vec3(mesh.boundsMin[0], mesh.boundsMin[1], mesh.boundsMin[2]), glm::vec3(mesh.boundsMax[0], mesh.boundsMax[1], mesh.boundsMax[2]));
+	}
+
+	unsigned int indexSize() const { return indexType == GL_UNSIGNED_SHORT ? 2 : 4; }
+	// what draw(lod) sends down
+	unsigned int triangleCount(size_t lod = 0) const { return (lods.empty() ? vertexCount : lods[lod].indexCount) / 3; }
+
+	// draws one level, or every vertex for meshes without indices
+	void draw(size_t lod = 0) const
+	{
+		glBindVertexArray(VAO);
+		if (lods.empty())
+		{
+			glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+			return;
+		}
+		const MeshLod &level = lods[lod];
+		glDrawElementsBaseVertex(GL_TRIANGLES, level.indexCount, indexType, (void*)((size_t)level.indexOffset * indexSize()), level.baseVertex);
+	}
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		if (VAO)
+		{
+			glDeleteVertexArrays(1, &VAO);
+			glDeleteBuffers(1, &VBO);
+			if (EBO)
+				glDeleteBuffers(1, &EBO);
+			VAO = VBO = EBO = 0;
+		}
+	}
+
+private:
+	unsigned int VBO, EBO;
+};
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include <glad/glad.h>
+
+#include "TextureStreamer.h"
+#include "common/mappedfile.hpp"
+
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <cstddef>
+#include <climits>
+#include <cmath>
+#include <stdio.h>
+
+// shared textures on top of TextureStreamer : a file is loaded once per sampler however many
+// parts ask for it (paths compare after canonicalPath), handles are reference counted and the
+// video memory of every resident texture is added up. once the total goes over the budget,
+// textures nobody holds any more are unloaded least recently bound first; acquiring one again
+// streams it back in.
+// textures start at their levels up to START_SIZE pixels. request() says how large a texture is on
+// screen this frame, the level that matches is streamed in and kept until no request has needed it
+// for DROP_DELAY frames. when the wanted levels of everything would not fit the budget, all of them
+// are made coarser by the same number of levels (bias) until they do
+// ------------------------------------------------------------------------
+class TextureManager
+{
+public:
+	static const unsigned int START_SIZE = 128;
+	static const unsigned int DROP_DELAY = 120;
+
+	explicit TextureManager(size_t budget = 256 << 20, unsigned int workerCount = 2) : streamer(workerCount), budget(budget), frame(0), bias(0)
+	{
+		streamer.setStartSize(START_SIZE);
+	}
+
+	// a handle to the texture of path with these sampler settings, shared with earlier acquires
+	// of the same file. every acquire needs its release
+	int acquire(const char *path, bool flip = true, const TextureSampler &sampler = TextureSampler())
+	{
+		std::string key = textureKey(canonicalPath(path), flip, sampler);
+		std::map<std::string, int>::iterator found = byKey.find(key);
+		if (found != byKey.end())
+		{
+			Record &record = records[found->second];
+			if (record.refs++ == 0 && streamer.evicted(record.texture))
+				streamer.reload(record.texture);
+			return found->second;
+		}
+		Record record;
+		record.texture = streamer.load(path, flip, sampler);
+		record.sampler = sampler;
+		record.refs = 1;
+		record.lastUse = frame;
+		record.requested = INT_MAX;
+		record.wanted = -1;
+		record.holdUntil = 0;
+		records.push_back(record);
+		byKey[key] = (int)records.size() - 1;
+		return (int)records.size() - 1;
+	}
+	// the texture stays resident until the budget needs its memory
+	void release(int handle)
+	{
+		if (records[handle].refs > 0)
+			records[handle].refs--;
+	}
+
+	// the texture to bind for a handle, the streamer's placeholder while it is not resident.
+	// counts as a use for the eviction order
+	unsigned int texture(int handle)
+	{
+		records[handle].lastUse = frame;
+		return streamer.texture(records[handle].texture);
+	}
+	bool resident(int handle) const { return streamer.resident(records[handle].texture); }
+	// textures still decoding, or with levels to stream in
+	size_t pending() const { return streamer.pending(); }
+
+	// residency feedback : the texture covers about pixels screen pixels along its larger side
+	// this frame (for an atlas page, the part's share scaled up to the page)
+	void request(int handle, float pixels)
+	{
+		unsigned int size = streamer.baseSize(records[handle].texture);
+		if (size == 0)
+			return;
+		int level = (int)std::floor(std::log2(size / std::max(pixels, 1.0f)));
+		records[handle].requested = std::min(records[handle].requested, std::max(level, 0));
+	}
+
+	// GL thread, once per frame : picks the wanted levels from the requests, streams pending
+	// uploads, then evicts down to the budget
+	void update(size_t uploadBudget)
+	{
+		frame++;
+		chooseLevels();
+		streamer.update(uploadBudget);
+		size_t total = residentBytes();
+		if (total <= budget)
+			return;
+		std::vector<int> unused;
+		for (size_t i = 0; i < records.size(); i++)
+			if (records[i].refs == 0 && streamer.resident(records[i].texture))
+				unused.push_back((int)i);
+		std::sort(unused.begin(), unused.end(), [this](int a, int b) { return records[a].lastUse < records[b].lastUse; });
+		for (size_t i = 0; i < unused.size() && total > budget; i++)
+		{
+			total -= streamer.residentBytes(records[unused[i]].texture);
+			streamer.unload(records[unused[i]].texture);
+		}
+	}
+
+	void setBudget(size_t bytes) { budget = bytes; }
+	size_t memoryBudget() const { return budget; }
+	// video memory of every resident texture
+	size_t residentBytes() const
+	{
+		size_t total = 0;
+		for (size_t i = 0; i < records.size(); i++)
+			total += streamer.residentBytes(records[i].texture);
+		return total;
+	}
+
+	// one line per texture : resident bytes and levels, references, frames since it was last bound and its sampler
+	void report(FILE *out) const
+	{
+		fprintf(out, "textures : %.2f MB resident of a %.2f MB budget, levels biased by %d\n", residentBytes() / 1048576.0, budget / 1048576.0, bias);
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			const Record &record = records[i];
+			int texture = record.texture;
+			const char *state = streamer.resident(texture) ? "resident" : streamer.evicted(texture) ? "evicted"
+				: streamer.failed(texture) ? "failed" : "loading";
+			fprintf(out, "  %8.2f KB  %-8s level %2d of %2d (wants %2d)  refs %d  idle %4u  wrap %04x/%04x filter %04x/%04x  %s\n",
+				streamer.residentBytes(texture) / 1024.0, state, streamer.residentLevel(texture), streamer.levels(texture), record.wanted,
+				record.refs, frame - record.lastUse, record.sampler.wrapS, record.sampler.wrapT, record.sampler.minFilter, record.sampler.magFilter,
+				streamer.path(texture).c_str());
+		}
+	}
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void releaseAll()
+	{
+		streamer.release();
+	}
+
+private:
+	struct Record
+	{
+		int texture; // streamer handle
+		TextureSampler sampler;
+		int refs;
+		unsigned int lastUse; // frame of the last texture() call
+		int requested;        // finest level request() asked for this frame, INT_MAX for none
+		int wanted;           // finest level kept, -1 until the levels are known
+		unsigned int holdUntil; // frame the wanted level may get coarser again
+	};
+
+	TextureStreamer streamer;
+	std::vector<Record> records;
+	std::map<std::string, int> byKey;
+	size_t budget;
+	unsigned int frame;
+	int bias; // levels every wanted level is moved down to fit the budget
+
+	// the feedback of the last frame turned into wanted levels, never coarser than the start level
+	void chooseLevels()
+	{
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			Record &record = records[i];
+			if (streamer.levels(record.texture) == 0)
+				continue;
+			int start = streamer.startLevel(record.texture);
+			if (record.refs == 0)
+				record.wanted = start;
+			else if (record.requested != INT_MAX && (record.wanted < 0 || record.requested <= record.wanted))
+			{
+				record.wanted = record.requested;
+				record.holdUntil = frame + DROP_DELAY;
+			}
+			else if (record.wanted < 0 || frame > record.holdUntil)
+				record.wanted = record.requested != INT_MAX ? record.requested : start;
+			record.wanted = std::min(record.wanted, start);
+			record.requested = INT_MAX;
+		}
+		// the smallest bias that fits, unreferenced textures are left to the eviction
+		int maxBias = 0;
+		for (bias = 0;; bias++)
+		{
+			size_t total = 0;
+			for (size_t i = 0; i < records.size(); i++)
+				if (records[i].wanted >= 0)
+				{
+					total += streamer.levelBytes(records[i].texture, biased(records[i]));
+					maxBias = std::max(maxBias, streamer.startLevel(records[i].texture) - records[i].wanted);
+				}
+			if (total <= budget || bias >= maxBias)
+				break;
+		}
+		for (size_t i = 0; i < records.size(); i++)
+			if (records[i].wanted >= 0)
+				streamer.setWantedLevel(records[i].texture, biased(records[i]));
+	}
+	int biased(const Record &record) const
+	{
+		return std::min(record.wanted + bias, std::max(record.wanted, streamer.startLevel(record.texture)));
+	}
+
+	static std::string textureKey(const std::string &path, bool flip, const TextureSampler &sampler)
+	{
+		char settings[64];
+		snprintf(settings, sizeof(settings), "|%d|%x|%x|%x|%x", flip ? 1 : 0, sampler.wrapS, sampler.wrapT, sampler.minFilter, sampler.magFilter);
+		return path + settings;
+	}
+};
+
+#endif
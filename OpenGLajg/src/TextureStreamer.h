@@ -0,0 +1,581 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "common/texturefile.hpp"
+#include "common/mappedfile.hpp"
+#include "common/imageresize.hpp"
+#include "common/profiler.hpp"
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <stdio.h>
+
+// asynchronous texture loading : files are decoded by stb_image on worker threads, the GL thread
+// copies the decoded rows through a pixel unpack buffer a few at a time in update(), so no frame
+// pays for more than the byte budget. until a texture is complete texture() hands out a shared
+// placeholder, the first frame never waits for a file.
+// DDS and KTX files (common/texturefile.hpp) are mapped instead of decoded and every level goes
+// up straight from the mapping. a cooked file next to a source image (tools/texcook) is used in
+// its place when it is up to date and the driver can sample its format.
+// decoded images get their mip chain on the CPU (common/imageresize.hpp, filtered in linear light)
+// instead of glGenerateMipmap, and flipped loads keep it next to the source for the next run, as
+// name.<filter>.<srgb|linear>.mips.dds so that other mip options make their own.
+// levels go up coarsest first, one at a time, with GL_TEXTURE_BASE_LEVEL on the finest one in, so a
+// texture is drawn as soon as its smallest level is there. setWantedLevel() streams finer levels in
+// or drops them again (their storage respecified to 0x0); without one a texture goes down to the
+// first level no larger than the start size. the mapping or decoded chain stays for the levels that
+// are not in
+// ------------------------------------------------------------------------
+
+// texture parameters set once a texture is resident, mipmap filters fall back to GL_LINEAR
+// for compressed files that come without a chain
+struct TextureSampler
+{
+	GLenum wrapS, wrapT;
+	GLenum minFilter, magFilter;
+	TextureSampler() : wrapS(GL_REPEAT), wrapT(GL_REPEAT), minFilter(GL_LINEAR_MIPMAP_LINEAR), magFilter(GL_LINEAR) {}
+};
+
+class TextureStreamer
+{
+public:
+	explicit TextureStreamer(unsigned int workerCount = 2, const MipChainOptions &mipOptions = MipChainOptions()) : mipOptions(mipOptions), startSize(0), placeholder(0), pixelBuffer(0), pixelBufferSize(0), uploading(-1), uploadLevel(0), uploadedRows(0),
+		s3tc(false), bptc(false), checkedExtensions(false), stopping(false)
+	{
+		for (unsigned int i = 0; i < std::max(1u, workerCount); i++)
+			workers.push_back(std::thread(&TextureStreamer::work, this));
+	}
+	~TextureStreamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (size_t i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+
+	// queues a file for loading and returns its handle right away, GL thread. the workers flip
+	// decoded rows themselves, stbi_set_flip_vertically_on_load is a global shared with the rest
+	// of the program. DDS / KTX files are taken as they are, cooked files hold flipped rows so they
+	// only stand in for flipped loads
+	int load(const char *path, bool flip = true, const TextureSampler &sampler = TextureSampler())
+	{
+		if (!checkedExtensions)
+			checkExtensions();
+		Entry entry;
+		entry.path = path;
+		entry.flip = flip;
+		entry.sampler = sampler;
+		std::string cooked = cookedTexturePath(path);
+		std::string mips = mipCachePath(path, mipOptions);
+		if (isTextureContainer(path))
+			entry.filePath = path;
+		else if (flip && cacheUpToDate(path, cooked.c_str()))
+			entry.filePath = cooked;
+		else if (flip && cacheUpToDate(path, mips.c_str()))
+			entry.filePath = mips;
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.push_back(entry);
+		jobs.push_back((int)entries.size() - 1);
+		wake.notify_one();
+		return (int)entries.size() - 1;
+	}
+
+	// GL thread, once per frame : drops the levels no longer wanted, then uploads at most budget
+	// bytes of rows through the PBO
+	void update(size_t budget)
+	{
+		PROFILE_SCOPE("stream textures");
+		if (!placeholder)
+			createPlaceholder();
+		dropLevels();
+		while (budget > 0)
+		{
+			if (uploading < 0 && !beginUpload())
+				return;
+			Entry &entry = entries[uploading];
+			Level level = levelOf(entry, uploadLevel);
+			int rows = (int)std::max<size_t>(1, budget / level.rowBytes) * level.rowHeight;
+			rows = std::min(rows, level.height - uploadedRows);
+			size_t bytes = level.rowBytes * ((rows + level.rowHeight - 1) / level.rowHeight);
+
+			// the buffer is orphaned every time, the copy of the last chunk may still be reading the old storage
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+			pixelBufferSize = std::max(pixelBufferSize, bytes);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, pixelBufferSize, NULL, GL_STREAM_DRAW);
+			void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			if (mapped)
+			{
+				memcpy(mapped, level.data + level.rowBytes * (uploadedRows / level.rowHeight), bytes);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				glBindTexture(GL_TEXTURE_2D, entry.texture);
+				if (level.compressed)
+					glCompressedTexSubImage2D(GL_TEXTURE_2D, uploadLevel, 0, uploadedRows, level.width, rows, level.format, (GLsizei)bytes, (const void *)0);
+				else
+				{
+					glPixelStorei(GL_UNPACK_ALIGNMENT, level.alignment);
+					glTexSubImage2D(GL_TEXTURE_2D, uploadLevel, 0, uploadedRows, level.width, rows, level.pixelFormat, level.pixelType, (const void *)0);
+					glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				}
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			uploadedRows += rows;
+			budget -= std::min(budget, bytes);
+
+			if (uploadedRows < level.height)
+				continue;
+			// the level is complete, sampling starts there
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, uploadLevel);
+			std::lock_guard<std::mutex> lock(mutex);
+			entry.residentLevel = uploadLevel;
+			entry.bytes = textureBytes(entry, uploadLevel);
+			if (entry.state == UPLOADING)
+			{
+				// files that come without a chain are sampled without one
+				bool chain = levelCount(entry) > 1;
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, chain || !mipmapFilter(entry.sampler.minFilter) ? entry.sampler.minFilter : GL_LINEAR);
+				entry.state = RESIDENT;
+			}
+			uploading = -1;
+		}
+	}
+
+	// textures without a wanted level stream down to the first level no larger than size, 0 for all levels
+	void setStartSize(unsigned int size) { startSize = size; }
+	// the finest level a texture should have, -1 for the start size. finer levels are streamed in,
+	// the ones above it dropped at the next update()
+	void setWantedLevel(int handle, int level) { entries[handle].wantedLevel = level; }
+	// levels of a texture once it is decoded or mapped, 0 before
+	int levels(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return loaded(entries[handle]) ? levelCount(entries[handle]) : 0;
+	}
+	// the larger side of level 0, 0 before the texture is decoded or mapped
+	unsigned int baseSize(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!loaded(entries[handle]))
+			return 0;
+		Level level = levelOf(entries[handle], 0);
+		return (unsigned int)std::max(level.width, level.height);
+	}
+	// the finest level in video memory, levels() while there is none
+	int residentLevel(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries[handle].state == RESIDENT ? entries[handle].residentLevel : levels(entries[handle]);
+	}
+	// video memory the levels from level down take, what a wanted level would cost
+	size_t levelBytes(int handle, int level) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return loaded(entries[handle]) ? textureBytes(entries[handle], level) : 0;
+	}
+	// the level setWantedLevel(-1) stands for
+	int startLevel(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return loaded(entries[handle]) ? startLevelOf(entries[handle]) : 0;
+	}
+
+	// the texture to bind for a handle : the placeholder until its first level is uploaded
+	unsigned int texture(int handle) const
+	{
+		return resident(handle) ? entries[handle].texture : placeholder;
+	}
+	bool resident(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries[handle].state == RESIDENT;
+	}
+	// video memory taken by the resident levels of a texture, 0 while none is in
+	size_t residentBytes(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries[handle].state == RESIDENT ? entries[handle].bytes : 0;
+	}
+	const std::string &path(int handle) const { return entries[handle].path; }
+
+	// deletes the texture of a resident handle, texture() hands out the placeholder again until reload()
+	void unload(int handle)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Entry &entry = entries[handle];
+		if (entry.state != RESIDENT)
+			return;
+		glDeleteTextures(1, &entry.texture);
+		entry.texture = 0;
+		entry.bytes = 0;
+		entry.chain.reset();
+		entry.file.reset();
+		entry.state = EVICTED;
+		if (uploading == handle)
+			uploading = -1;
+	}
+	// queues an unloaded (or failed) handle for loading again
+	void reload(int handle)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Entry &entry = entries[handle];
+		if (entry.state != EVICTED && entry.state != FAILED)
+			return;
+		entry.state = QUEUED;
+		jobs.push_back(handle);
+		wake.notify_one();
+	}
+	bool evicted(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries[handle].state == EVICTED;
+	}
+	bool failed(int handle) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return entries[handle].state == FAILED;
+	}
+
+	// handles still decoding or uploading, or short of their wanted level
+	size_t pending() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t count = 0;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			const Entry &entry = entries[i];
+			count += entry.state == QUEUED || entry.state == DECODED || entry.state == UPLOADING ||
+				(entry.state == RESIDENT && entry.residentLevel > targetLevel(entry));
+		}
+		return count;
+	}
+
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		for (size_t i = 0; i < entries.size(); i++)
+			if (entries[i].texture)
+				glDeleteTextures(1, &entries[i].texture);
+		if (placeholder)
+			glDeleteTextures(1, &placeholder);
+		if (pixelBuffer)
+			glDeleteBuffers(1, &pixelBuffer);
+		placeholder = pixelBuffer = 0;
+	}
+
+private:
+	enum State { QUEUED, DECODED, UPLOADING, RESIDENT, FAILED, EVICTED };
+	struct Entry
+	{
+		std::string path;
+		std::string filePath; // DDS / KTX file to map, empty when the source is decoded
+		bool flip;
+		TextureSampler sampler;
+		State state;
+		std::shared_ptr<TextureImage> chain; // decoded sources with their generated levels
+		std::shared_ptr<TextureFile> file;   // mapped containers
+		unsigned int texture;
+		int residentLevel; // finest level uploaded, the base level of the texture
+		int wantedLevel;   // -1 for the start size
+		size_t bytes;      // of the resident levels
+		Entry() : flip(true), state(QUEUED), texture(0), residentLevel(0), wantedLevel(-1), bytes(0) {}
+	};
+	// one mip level as update() slices it : compressed levels go by rows of 4x4 blocks
+	struct Level
+	{
+		int width, height;
+		int rowHeight;
+		size_t rowBytes;
+		const unsigned char *data;
+		bool compressed;
+		GLenum format, pixelFormat, pixelType;
+		GLint alignment;
+	};
+
+	MipChainOptions mipOptions;
+	unsigned int startSize;
+	unsigned int placeholder;
+	unsigned int pixelBuffer;
+	size_t pixelBufferSize;
+	int uploading;    // entry whose rows are going up, -1 for none
+	int uploadLevel;
+	int uploadedRows;
+	bool s3tc, bptc;  // formats beyond GL 3.3 core the driver samples
+	bool checkedExtensions;
+	std::deque<Entry> entries; // a deque, the workers keep writing to entries while load() appends
+	std::deque<int> jobs;      // entries waiting for a worker
+	std::vector<std::thread> workers;
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping;
+
+	static int levelCount(const Entry &entry)
+	{
+		return entry.file ? (int)entry.file->view().levels : (int)entry.chain->levels.size();
+	}
+	static Level levelOf(const Entry &entry, int index)
+	{
+		Level level;
+		if (entry.chain)
+		{
+			const TextureLevel &image = entry.chain->levels[index];
+			level.width = image.width;
+			level.height = image.height;
+			level.rowHeight = 1;
+			level.rowBytes = (size_t)image.width * 4;
+			level.data = &entry.chain->data[image.offset];
+			level.compressed = false;
+			level.format = GL_RGBA8;
+			level.pixelFormat = GL_RGBA;
+			level.pixelType = GL_UNSIGNED_BYTE;
+			level.alignment = 4;
+			return level;
+		}
+		const TextureView &view = entry.file->view();
+		const TextureSubresource &image = view.at(index);
+		level.width = image.width;
+		level.height = image.height;
+		level.compressed = textureFormatCompressed(view.format);
+		level.rowHeight = level.compressed ? 4 : 1;
+		level.rowBytes = level.compressed ? textureLevelSize(view.format, image.width, 4) : image.size / image.height;
+		level.data = image.data;
+		level.format = view.format;
+		level.pixelFormat = view.pixelFormat;
+		level.pixelType = view.pixelType;
+		level.alignment = view.rowAlignment;
+		return level;
+	}
+
+	// the file is mapped or the source decoded, the levels are known
+	static bool loaded(const Entry &entry)
+	{
+		return entry.state == DECODED || entry.state == UPLOADING || entry.state == RESIDENT;
+	}
+	static int levels(const Entry &entry)
+	{
+		return loaded(entry) ? levelCount(entry) : 0;
+	}
+	int startLevelOf(const Entry &entry) const
+	{
+		int level = 0;
+		if (startSize == 0)
+			return 0;
+		while (level + 1 < levelCount(entry) && (unsigned int)std::max(levelOf(entry, level).width, levelOf(entry, level).height) > startSize)
+			level++;
+		return level;
+	}
+	int targetLevel(const Entry &entry) const
+	{
+		int level = entry.wantedLevel < 0 ? startLevelOf(entry) : entry.wantedLevel;
+		return std::min(level, levelCount(entry) - 1);
+	}
+
+	static bool mipmapFilter(GLenum filter)
+	{
+		return filter != GL_NEAREST && filter != GL_LINEAR;
+	}
+	// the levels from first down, formats we do not know counted at 4 bytes a pixel
+	static size_t textureBytes(const Entry &entry, int first)
+	{
+		size_t bytes = 0;
+		for (int index = std::max(0, first); index < levelCount(entry); index++)
+		{
+			Level level = levelOf(entry, index);
+			if (level.compressed)
+				bytes += level.rowBytes * ((level.height + 3) / 4);
+			else
+			{
+				// 3 channel formats are stored at 4 bytes a pixel by drivers
+				size_t pixel = level.format == GL_RGB8 ? 4 : textureFormatBytes(level.format);
+				bytes += (pixel ? pixel : 4) * level.width * level.height;
+			}
+		}
+		return bytes;
+	}
+
+	// formats beyond GL 3.3 core come from extensions, looked up once on the GL thread
+	void checkExtensions()
+	{
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++)
+		{
+			const char *name = (const char *)glGetStringi(GL_EXTENSIONS, i);
+			s3tc = s3tc || strcmp(name, "GL_EXT_texture_compression_s3tc") == 0;
+			bptc = bptc || strcmp(name, "GL_ARB_texture_compression_bptc") == 0;
+		}
+		bptc = bptc || GLAD_GL_VERSION_4_2;
+		checkedExtensions = true;
+	}
+	// the streamer makes 2D textures, arrays and cube maps are left to their own loaders
+	bool usable(const TextureView &view) const
+	{
+		if (view.layers != 1 || view.faces != 1)
+			return false;
+		switch (view.format)
+		{
+		case TEXTURE_BC1: case TEXTURE_BC1_SRGB: case TEXTURE_BC2: case TEXTURE_BC2_SRGB: case TEXTURE_BC3: case TEXTURE_BC3_SRGB:
+			return s3tc;
+		case TEXTURE_BC7: case TEXTURE_BC7_SRGB:
+			return bptc;
+		default:
+			return true;
+		}
+	}
+
+	void work()
+	{
+		setProfileThreadName("texture streamer");
+		for (;;)
+		{
+			int job;
+			std::string path, filePath;
+			bool flip;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+				if (stopping)
+					return;
+				job = jobs.front();
+				jobs.pop_front();
+				path = entries[job].path;
+				filePath = entries[job].filePath;
+				flip = entries[job].flip;
+			}
+			if (!filePath.empty())
+			{
+				std::shared_ptr<TextureFile> file(new TextureFile());
+				bool ok = file->open(filePath.c_str()) && usable(file->view());
+				if (ok || filePath == path)
+				{
+					if (!ok)
+						printf("%s can not be streamed as a 2D texture here\n", path.c_str());
+					std::lock_guard<std::mutex> lock(mutex);
+					entries[job].file = ok ? file : std::shared_ptr<TextureFile>();
+					entries[job].state = ok ? DECODED : FAILED;
+					continue;
+				}
+				// a cooked file that does not work here, the source is decoded instead
+			}
+			// RGBA, the chain is built and uploaded that way
+			PROFILE_SCOPE("decode texture");
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			int width, height, channels;
+			unsigned char *pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+			std::shared_ptr<TextureImage> chain;
+			if (pixels)
+			{
+				if (flip)
+					flipImageRows(pixels, (size_t)width * 4, height);
+				double decodeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				chain.reset(new TextureImage());
+				MipChainStats stats;
+				generateMipChain(pixels, width, height, mipOptions, *chain, &stats);
+				stbi_image_free(pixels);
+				// unflipped rows are not what the cache holds
+				bool cached = flip && writeTextureFile(mipCachePath(path.c_str(), mipOptions).c_str(), *chain);
+				printf("%s : decoded in %.1f ms, %u %s levels in %.1f ms on %u threads%s\n", path.c_str(), decodeMs, stats.levels,
+					mipFilterName(mipOptions.filter), stats.milliseconds, stats.threads, cached ? ", cached" : "");
+			}
+			else
+				printf("%s could not be decoded : %s\n", path.c_str(), stbi_failure_reason());
+			std::lock_guard<std::mutex> lock(mutex);
+			entries[job].chain = chain;
+			entries[job].state = chain ? DECODED : FAILED;
+		}
+	}
+
+	// the next level to upload : the coarsest one of a decoded entry, which creates its texture, or
+	// the next finer one of a resident entry short of its wanted level. false when nothing is left
+	bool beginUpload()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			Entry &entry = entries[i];
+			if (entry.state != DECODED)
+				continue;
+			glGenTextures(1, &entry.texture);
+			glBindTexture(GL_TEXTURE_2D, entry.texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, entry.sampler.wrapS);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, entry.sampler.wrapT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, entry.sampler.magFilter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount(entry) - 1);
+			entry.residentLevel = levelCount(entry);
+			entry.bytes = 0;
+			entry.state = UPLOADING;
+			beginLevel((int)i, levelCount(entry) - 1);
+			return true;
+		}
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			Entry &entry = entries[i];
+			if (entry.state != RESIDENT || entry.residentLevel <= targetLevel(entry))
+				continue;
+			glBindTexture(GL_TEXTURE_2D, entry.texture);
+			beginLevel((int)i, entry.residentLevel - 1);
+			return true;
+		}
+		return false;
+	}
+	// allocates the storage of one level, its rows follow in update()
+	void beginLevel(int index, int levelIndex)
+	{
+		Level level = levelOf(entries[index], levelIndex);
+		if (level.compressed)
+			glCompressedTexImage2D(GL_TEXTURE_2D, levelIndex, level.format, level.width, level.height, 0, (GLsizei)(level.rowBytes * ((level.height + 3) / 4)), NULL);
+		else
+			glTexImage2D(GL_TEXTURE_2D, levelIndex, level.format, level.width, level.height, 0, level.pixelFormat, level.pixelType, NULL);
+		uploading = index;
+		uploadLevel = levelIndex;
+		uploadedRows = 0;
+	}
+	// resident levels finer than the wanted one go : the base level moves up and their storage is
+	// respecified to nothing, which is where drivers free it
+	void dropLevels()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			Entry &entry = entries[i];
+			int target = entry.state == RESIDENT ? targetLevel(entry) : 0;
+			if (entry.state != RESIDENT || entry.residentLevel >= target || uploading == (int)i)
+				continue;
+			glBindTexture(GL_TEXTURE_2D, entry.texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, target);
+			for (int level = entry.residentLevel; level < target; level++)
+				glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+			entry.residentLevel = target;
+			entry.bytes = textureBytes(entry, target);
+		}
+	}
+
+	// a 2x2 grey checker, bound in place of everything that is not resident yet
+	void createPlaceholder()
+	{
+		static const unsigned char pixels[16] = { 128, 128, 128, 255, 96, 96, 96, 255, 96, 96, 96, 255, 128, 128, 128, 255 };
+		glGenTextures(1, &placeholder);
+		glBindTexture(GL_TEXTURE_2D, placeholder);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glGenBuffers(1, &pixelBuffer);
+	}
+};
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef VERTEX_PULLER_H
+#define VERTEX_PULLER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "StaticMesh.h"
+#include "common/meshfile.hpp"
+#include "common/profiler.hpp"
+
+#include <vector>
+#include <cstring>
+#include <stdio.h>
+
+// storage buffer bindings read by pulling.vs
+const unsigned int PULL_VERTEX_BINDING = 0;
+const unsigned int PULL_LAYOUT_BINDING = 1;
+const unsigned int PULL_DRAW_BINDING = 2;
+const unsigned int PULL_LOCATIONS = 4; // 0 position, 1 color, 2 uv, 3 normal
+
+// programmable vertex pulling : the vertices of every mesh live in one storage buffer as raw
+// words, whatever their layout. pulling.vs decodes them from gl_VertexID with the layout
+// descriptor of the mesh, so meshes with different layouts share one empty VAO and a whole
+// frame of them goes out in one glMultiDrawElementsIndirect, gl_DrawIDARB picking the draw record
+// ------------------------------------------------------------------------
+class VertexPuller
+{
+public:
+	// storage buffers and indirect multi-draw are core in GL 4.3, gl_DrawIDARB comes from
+	// ARB_shader_draw_parameters, which 4.6 drivers keep listing next to the core gl_DrawID
+	static bool supported()
+	{
+		if (!GLAD_GL_VERSION_4_3)
+			return false;
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++)
+			if (strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_shader_draw_parameters") == 0)
+				return true;
+		return false;
+	}
+
+	VertexPuller() : VAO(0), vertexBuffer(0), layoutBuffer(0), drawBuffer(0), indexBuffer(0), indirectBuffer(0), dirty(false) {}
+	// deletes the GL objects, has to happen while the context is still alive
+	void release()
+	{
+		if (VAO)
+		{
+			glDeleteVertexArrays(1, &VAO);
+			unsigned int buffers[5] = { vertexBuffer, layoutBuffer, drawBuffer, indexBuffer, indirectBuffer };
+			glDeleteBuffers(5, buffers);
+			VAO = vertexBuffer = layoutBuffer = drawBuffer = indexBuffer = indirectBuffer = 0;
+		}
+		dirty = true;
+	}
+
+	// copies the vertices and indices of a mesh, non indexed meshes get a sequential index list.
+	// returns the handle for draw(), or -1 for layouts the shader cannot decode
+	int add(const MeshView &mesh)
+	{
+		Layout layout;
+		memset(&layout, 0, sizeof(layout));
+		// attributes are read as whole words
+		if (mesh.layout.stride % 4 != 0)
+			return unsupported("stride");
+		for (unsigned int i = 0; i < mesh.layout.attributeCount; i++)
+		{
+			const MeshAttribute &a = mesh.layout.attributes[i];
+			if (a.location >= PULL_LOCATIONS)
+				continue;
+			if (a.offset % 4 != 0)
+				return unsupported("attribute offset");
+			if (a.type != MESH_FLOAT && a.type != MESH_HALF_FLOAT && a.type != MESH_UNSIGNED_SHORT
+				&& a.type != MESH_UNSIGNED_BYTE && a.type != MESH_INT_2_10_10_10_REV)
+				return unsupported("attribute type");
+			layout.attributes[a.location].offset = a.offset / 4;
+			layout.attributes[a.location].type = a.type;
+			layout.attributes[a.location].components = a.components;
+			layout.attributes[a.location].normalized = a.normalized;
+		}
+		PositionDecode decode(mesh);
+		layout.positionScale = glm::vec4(decode.scale, 0.0f);
+		layout.positionOffset = glm::vec4(decode.offset, 0.0f);
+		layout.base = (unsigned int)words.size();
+		layout.stride = mesh.layout.stride / 4;
+
+		size_t bytes = (size_t)mesh.vertexCount * mesh.layout.stride;
+		words.resize(words.size() + bytes / 4);
+		if (bytes)
+			memcpy(&words[layout.base], mesh.vertices, bytes);
+
+		firstIndex.push_back((unsigned int)indices.size());
+		if (mesh.indices)
+		{
+			for (unsigned int i = 0; i < mesh.indexCount; i++)
+				indices.push_back(mesh.indexSize == 2 ? ((const unsigned short *)mesh.indices)[i] : ((const unsigned int *)mesh.indices)[i]);
+		}
+		else
+		{
+			for (unsigned int i = 0; i < mesh.vertexCount; i++)
+				indices.push_back(i);
+		}
+		layouts.push_back(layout);
+		dirty = true;
+		return (int)layouts.size() - 1;
+	}
+
+	// (re)creates the vertex, layout and index buffers from everything added so far
+	void upload()
+	{
+		PROFILE_SCOPE("upload pulled meshes");
+		if (!dirty)
+			return;
+		if (!VAO)
+		{
+			// the VAO only carries the element buffer, there are no attributes
+			glGenVertexArrays(1, &VAO);
+			glGenBuffers(1, &vertexBuffer);
+			glGenBuffers(1, &layoutBuffer);
+			glGenBuffers(1, &drawBuffer);
+			glGenBuffers(1, &indexBuffer);
+			glGenBuffers(1, &indirectBuffer);
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, vertexBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, words.size() * sizeof(unsigned int), words.empty() ? NULL : &words[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, layoutBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, layouts.size() * sizeof(Layout), layouts.empty() ? NULL : &layouts[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.empty() ? NULL : &indices[0], GL_STATIC_DRAW);
+		glBindVertexArray(0);
+		dirty = false;
+	}
+
+	// queues one range of a mesh, the range is relative to the mesh's own index list (MeshView::lods).
+	// uvTransform is the scale (xy) and offset (zw) of the texture coordinates, for atlas parts
+	void draw(int mesh, const MeshLod &range, const glm::mat4 &model, const glm::vec4 &uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f))
+	{
+		Draw record;
+		memset(&record, 0, sizeof(record));
+		record.model = model;
+		record.mesh = (unsigned int)mesh;
+		record.uvTransform = uvTransform;
+		draws.push_back(record);
+
+		Command command;
+		command.count = range.indexCount;
+		command.instanceCount = 1;
+		command.firstIndex = firstIndex[mesh] + range.indexOffset;
+		command.baseVertex = range.baseVertex;
+		command.baseInstance = 0;
+		commands.push_back(command);
+	}
+
+	size_t queued() const { return commands.size(); }
+
+	// draws everything queued since the last flush in one call, pulling.vs has to be in use
+	void flush()
+	{
+		if (commands.empty())
+			return;
+		// both per frame buffers are orphaned, the driver hands out fresh storage
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, draws.size() * sizeof(Draw), &draws[0], GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(Command), &commands[0], GL_STREAM_DRAW);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PULL_VERTEX_BINDING, vertexBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PULL_LAYOUT_BINDING, layoutBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PULL_DRAW_BINDING, drawBuffer);
+		glBindVertexArray(VAO);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, (GLsizei)commands.size(), 0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+		draws.clear();
+		commands.clear();
+	}
+
+private:
+	// std430 mirrors of the structs in pulling.vs
+	struct Attribute
+	{
+		unsigned int offset; // words from the start of the vertex
+		unsigned int type;   // MeshAttributeType, 0 when the mesh has no such attribute
+		unsigned int components;
+		unsigned int normalized;
+	};
+	struct Layout
+	{
+		glm::vec4 positionScale; // see PositionDecode
+		glm::vec4 positionOffset;
+		unsigned int base;   // first word of the mesh in the vertex buffer
+		unsigned int stride; // words per vertex
+		unsigned int padding[2];
+		Attribute attributes[PULL_LOCATIONS]; // by shader location
+	};
+	struct Draw
+	{
+		glm::mat4 model;
+		unsigned int mesh; // index of the layout
+		unsigned int padding[3];
+		glm::vec4 uvTransform;
+	};
+	// DrawElementsIndirectCommand
+	struct Command
+	{
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
+	};
+
+	unsigned int VAO;
+	unsigned int vertexBuffer, layoutBuffer, drawBuffer, indexBuffer, indirectBuffer;
+	bool dirty;
+	std::vector<unsigned int> words;
+	std::vector<Layout> layouts;
+	std::vector<unsigned int> indices;
+	std::vector<unsigned int> firstIndex; // per mesh, into indices
+	std::vector<Draw> draws;
+	std::vector<Command> commands;
+
+	static int unsupported(const char *what)
+	{
+		printf("vertex pulling : unsupported %s\n", what);
+		return -1;
+	}
+};
+
+#endif
@@ -1,7 +1,5 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -11,18 +9,55 @@
 
 #include "Particle.h"
 #include "shader.h"
+#include "common/meshsimplify.hpp"
+#include "common/carprofile.hpp"
+#include "common/textureatlas.hpp"
+#include "common/benchmark.hpp"
+#include "common/profiler.hpp"
+#include "Culling.h"
+#include "BVH.h"
+#include "Occlusion.h"
+#include "GeometryArena.h"
+#include "StaticMesh.h"
+#include "GltfModel.h"
+#include "SceneMeshes.h"
+#include "VertexPuller.h"
+#include "TextureManager.h"
+#include "SkinArray.h"
+#include "Headless.h"
+#include "GpuProfiler.h"
+#include "PerfHud.h"
+// after every header that includes stb_image.h, version 2.22 has no guard around the implementation
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
 
 #include <vector>
+#include <memory>
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+void addCarDraw(const char *name, unsigned int VAO, unsigned int indexType, const PositionDecode &decode, int pulledMesh, const std::vector<MeshLod> *lods, const glm::mat4 &model, const AABB &localBounds);
+void setPositionDecode(const Shader &shader, const PositionDecode &decode);
+const char *atlasPartName(const char *drawName);
+void setCameraAngles(float newYaw, float newPitch);
 
 // settings
-const unsigned int SCR_WIDTH = 800;
-const unsigned int SCR_HEIGHT = 600;
+unsigned int SCR_WIDTH = 800; // the window, or the framebuffer of --headless --size
+unsigned int SCR_HEIGHT = 600;
+const size_t TEXTURE_UPLOAD_BUDGET = 1 << 20; // bytes of texture rows uploaded per frame
+const size_t TEXTURE_MEMORY_BUDGET = 128 << 20; // resident textures nobody holds are unloaded above this
+const int FLEET_MAX_INSTANCES = 64; // the size of the instances array in fleet.vs
+const int SKIN_SIZE = 1024; // pixels, every layer of the skin array
 
 // camera
 glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
@@ -37,6 +72,14 @@ float lastX = 800.0f / 2.0;
 float lastY = 600.0 / 2.0;
 float fov = 45.0f;
 
+// picking
+bool cursorFree = false; // hold left alt to release the cursor and point at a part
+bool pickRequested = false;
+
+bool textureReportRequested = false; // press T for the resident texture list
+double cursorX = 800.0 / 2.0;
+double cursorY = 600.0 / 2.0;
+
 
 // timing
 float deltaTime = 0.0f;	// time between current frame and last frame
@@ -48,535 +91,456 @@ std::vector<Rain> rains;
 std::vector<Smoke> smokes;
 unsigned int nr_particles = 5000;
 
-int main()
+// culling
+struct DrawItem
 {
-	// glfw: initialize and configure
-	// ------------------------------
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-	// glfw window creation
-	// --------------------
-	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
-	if (window == NULL)
+	const char *name;
+	unsigned int VAO;
+	unsigned int indexType;
+	PositionDecode decode;
+	int pulledMesh; // handle in the vertex puller, -1 when it is not available
+	const std::vector<MeshLod> *lods;
+	int lod;
+	int fleetLod; // the level the fleet draws the part at, from the nearest visible car
+	glm::mat4 model;
+	glm::vec4 uvTransform; // where the part's texture sits on the atlas page, identity without one
+};
+std::vector<DrawItem> carDraws;
+StaticMesh carBody;
+StaticMesh lampCube;
+StaticMesh rainDrop;
+GeometryArena geometry;
+VertexPuller puller;
+bool vertexPulling = false; // press V to toggle, when VertexPuller::supported()
+std::vector<AABB> carWorldBounds;
+BVH carBVH;
+CullList rainBounds;
+std::vector<unsigned int> carVisible;
+std::vector<unsigned char> rainVisible;
+OcclusionCuller occlusion; // press O to toggle
+bool fleet = false; // press F for a parking lot of cars around this one, each with a skin from the array
+unsigned int fleetCars = 25; // with the one in the middle
+unsigned int lightCount = 1; // lamps drawn, the first one at lightPos lights the scene
+std::vector<glm::vec4> fleetInstances; // offset and skin layer, see fleet.vs
+std::vector<glm::vec4> fleetVisible; // the instances that pass the frustum and occlusion tests this frame
+bool hud = false; // press H for the performance overlay (PerfHud.h), --hud starts with it
+RenderStats renderStats; // the draw calls, triangles and state changes of the frame, for the overlay
+
+// headless : no window, a fixed number of frames into a framebuffer object (Headless.h)
+bool headless = false;
+unsigned int headlessFrames = 300;
+const char *headlessOutput = NULL; // PNG of the last frame
+const float HEADLESS_FRAME_TIME = 1.0f / 60.0f; // the clock steps by this much a frame, whatever the frame took
+
+// benchmark : a scene file drawn on its fixed timestep along its camera path, the frame times
+// of the measured frames go to <report>.csv and <report>.json (common/benchmark.hpp)
+bool benchmark = false;
+BenchmarkScene benchmarkScene;
+const char *benchmarkReport = "benchmark_report";
+
+// --trace capture.json : CPU scopes of every thread and the GPU passes as a Chrome trace, written at exit
+const char *tracePath = NULL;
+
+// --gltf model.glb : a glTF model parked next to the car, scaled to its size
+const char *gltfPath = NULL;
+GltfModel gltfModel;
+glm::mat4 gltfPlacement(1.0f);
+
+int main(int argc, char **argv)
+{
+	// command line: [--headless [--frames n] [--size WxH] [--output frame.png]] [--benchmark scene.txt [--report base]] [--trace capture.json] [--hud] [--gltf model.glb]
+	// ----------------------------------------------------------------------------------------------------------------------------------
+	for (int i = 1; i < argc; i++)
 	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
+		if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc)
+		{
+			if (!readBenchmarkScene(argv[++i], benchmarkScene))
+				return -1;
+			benchmark = true;
+		}
+		else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+			benchmarkReport = argv[++i];
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracePath = argv[++i];
+		else if (strcmp(argv[i], "--hud") == 0)
+			hud = true;
+		else if (strcmp(argv[i], "--gltf") == 0 && i + 1 < argc)
+			gltfPath = argv[++i];
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			headlessFrames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+		{
+			unsigned int width, height;
+			if (sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+			{
+				SCR_WIDTH = width;
+				SCR_HEIGHT = height;
+			}
+			else
+				std::cout << argv[i] << " : expected a size like 1280x720" << std::endl;
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			headlessOutput = argv[++i];
+		else
+			std::cout << "unknown option " << argv[i] << std::endl;
+	}
+	// from here on the loaders are in the capture too
+	setProfileThreadName("main");
+	enableProfiler(tracePath != NULL);
+	long long startupBegin = profileClock();
+	if (benchmark)
+	{
+		// the report has to describe what was drawn, a scene the fleet cannot hold is refused
+		if (benchmarkScene.cars > (unsigned int)FLEET_MAX_INSTANCES + 1)
+		{
+			printf("benchmark %s : %u cars, fleet.vs draws at most %d\n", benchmarkScene.name.c_str(), benchmarkScene.cars, FLEET_MAX_INSTANCES + 1);
+			return -1;
+		}
+		SCR_WIDTH = benchmarkScene.width;
+		SCR_HEIGHT = benchmarkScene.height;
+		nr_particles = benchmarkScene.particles;
+		lightCount = benchmarkScene.lights;
+		fleetCars = std::max(1u, benchmarkScene.cars);
+		fleet = fleetCars > 1;
 	}
-	glfwMakeContextCurrent(window);
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-	glfwSetCursorPosCallback(window, mouse_callback);
-	glfwSetScrollCallback(window, scroll_callback);
-
-	// tell GLFW to capture our mouse
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-	// glad: load all OpenGL function pointers
-	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	GLFWwindow* window = NULL;
+	HeadlessContext offscreen;
+	if (headless)
 	{
-		std::cout << "Failed to initialize GLAD" << std::endl;
-		return -1;
+		if (!offscreen.create(SCR_WIDTH, SCR_HEIGHT))
+			return -1;
+	}
+	else
+	{
+		// glfw: initialize and configure
+		// ------------------------------
+		glfwInit();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		// glfw window creation
+		// --------------------
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+		if (window == NULL)
+		{
+			std::cout << "Failed to create GLFW window" << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		glfwMakeContextCurrent(window);
+		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+		glfwSetCursorPosCallback(window, mouse_callback);
+		glfwSetScrollCallback(window, scroll_callback);
+		glfwSetMouseButtonCallback(window, mouse_button_callback);
+
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+		// glad: load all OpenGL function pointers
+		// ---------------------------------------
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+		{
+			std::cout << "Failed to initialize GLAD" << std::endl;
+			return -1;
+		}
 	}
 
 	// configure global opengl state
 	// -----------------------------
 	glEnable(GL_DEPTH_TEST);
 
+	// textures decode on worker threads from here on, update() streams them in once the frames run
+	// ---------------------------------------------------------------------------------------------
+	// with an atlas from tools/atlaspack every part samples its corner of one page, one binding for the car
+	TextureManager textures(TEXTURE_MEMORY_BUDGET);
+	std::vector<std::string> atlasPages;
+	std::vector<AtlasPlacement> atlasParts;
+	bool atlas = readAtlasManifest("../OpenGLajg/image/car_atlas.txt", atlasPages, atlasParts) && !atlasPages.empty();
+	int carTexture = textures.acquire(atlas ? atlasPages[0].c_str() : "../OpenGLajg/image/car_texture.jpg");
+
+	// the fleet's liveries, resized to one size on the workers. more skins only need another line here
+	SkinArray skins(SKIN_SIZE, SKIN_SIZE);
+	skins.add("../OpenGLajg/image/car_texture.jpg");
+
 	// build and compile our shader zprogram
 	// ------------------------------------
 	Shader squareShader("../OpenGLajg/src/vertex.vs", "../OpenGLajg/src/fragment.fs");
 	Shader lightingShader("../OpenGLajg/src/basic_lighting.vs", "../OpenGLajg/src/basic_lighting.fs");
 	Shader lampShader("../OpenGLajg/src/lamp.vs", "../OpenGLajg/src/lamp.fs");
 	Shader particleShader("../OpenGLajg/src/particle.vs", "../OpenGLajg/src/particle.fs");
+	Shader fleetShader("../OpenGLajg/src/fleet.vs", "../OpenGLajg/src/fleet.fs");
+	Shader gltfShader("../OpenGLajg/src/gltf.vs", "../OpenGLajg/src/gltf.fs");
+	Shader hudShader("../OpenGLajg/src/hud.vs", "../OpenGLajg/src/hud.fs");
 
 	// set up vertex data (and buffer(s)) and configure vertex attributes
 	// ------------------------------------------------------------------
-	float vertices[] = {
-		-0.5f, -0.7f,  0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, //0
-		 0.5f, -0.7f,  0.0f, 1.0f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//1
-		-0.5f, -0.2f,  0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//2
-		 0.5f, -0.2f,  0.0f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//3
-		 0.5f, -0.7f, -0.5f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//4
-		 0.5f, -0.2f, -0.5f, 1.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,//5
-		-0.5f, -0.2f, -0.5f, 1.0f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//6
-		-0.5f, -0.7f, -0.5f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//7
-		 0.5f,  0.2f, -0.65f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//8
-		-0.5f,  0.2f, -0.65f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//9
-		-0.5f,  0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//10
-		 0.5f,  0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//11
-		 0.5f, -0.7f, -1.5f, 1.0f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//12
-		-0.5f, -0.7f, -1.5f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//13
-		 0.45f, -0.2f, -0.499f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,//14
-		-0.45f, -0.2f, -0.499f, 0.77f, 1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,//15
-		0.45f,  0.15f, -0.63f, 0.77f, 1.0f,  1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,//16
-		-0.45f,  0.15f, -0.63f, 0.77f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//17
-
-		 0.5f,  -0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,//18
-		 -0.5f, -0.2f, -1.5f, 1.0f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,// 19
-
-		 //0.51f,  0.15f, -0.7f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f,//8 20
-		 //0.51f,  0.15f, -1.4f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f,//11 21
-		 //0.51f, -0.15f, -0.6f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f,//5 22
-		 //0.51f,  -0.15f, -1.4f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f,//18 23
-
-		 0.501f,  0.15f, -0.7f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//8 20
-		 0.501f,  0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//11 21
-		 0.501f, -0.15f, -0.6f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//5 22
-		 0.501f,  -0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f,//18 23
-
-		 0.501f,  0.15f, -1.1f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//8 24
-		 0.501f,  0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 25
-		 0.501f, -0.15f, -1.1f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//5 26
-		 0.501f,  -0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//18 27
-
-		 -0.501f,  0.15f, -0.7f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//8 28
-		 -0.501f,  0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 29
-		 -0.501f, -0.15f, -0.6f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//5 30
-		 -0.501f,  -0.15f, -1.0f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//18 31
-
-		 -0.501f,  0.15f, -1.1f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//8 32
-		 -0.501f,  0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 33
-		 -0.501f, -0.15f, -1.1f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//5 34
-		 -0.501f,  -0.15f, -1.45f, 0.77f, 1.0f,  1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//18 35
-
-		 -0.45f,  0.15f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//10 36
-		 0.45f,  0.15f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//11 37
-		 0.45f, -0.2f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//12 38
-		 -0.45f, -0.2f, -1.501f, 0.77f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//13 39
-
-		 -0.4f, -0.425f,  0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,//40
-		 0.4f, -0.425f,  0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,//41
-		 -0.4f, -0.25f,  0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,//42
-		 0.4f, -0.25f,  0.01f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f//43
-	};
-	unsigned int indices[] = {
-		0, 1, 2,
-		1, 2, 3,
-		1, 3, 4,
-		3, 4, 5,
-		2, 3, 6,
-		3, 5, 6,
-		0, 2, 7,
-		2, 7, 6,
-		0, 1, 7,
-		1, 4, 7,
-		6, 5, 8,
-		6, 8, 9,
-		8, 9, 10,
-		8, 10, 11,
-		5, 8, 18,
-		8, 11, 18,
-		4,5,12,
-		5,12,18,
-		10, 13, 12,
-		10, 11, 12,
-		9, 10, 19,
-		6, 9, 19,
-		6, 7, 13,
-		6, 13, 19,
-		7, 4, 13,
-		13,12,4,
-		14, 15, 17,
-		14, 17, 16,
-
-		20,21,22,
-		22,23,21,
-
-		24,25,26,
-		26,27,25,
-
-		28,29,30,
-		30,31,29,
-
-		32,33,34,
-		34,35,33,
-
-		36,37,38,
-		38,39,36,
-
-		40,41,42,
-		41,42,43
-	};
-
-	//SQUARES
-	unsigned int VBO, VAOSQ, EBO, VAOC, VBOC, EBOC, VAOWG, VBOWG, EBOWG, VAOFL, VBOFL, EBOFL;
-	glGenVertexArrays(1, &VAOSQ);
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
-
-	glBindVertexArray(VAOSQ);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	// color attribute
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// texture attribute
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	// normal attribute
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(float), (void*)(8 * sizeof(float)));
-	glEnableVertexAttribArray(3);
-
-	//CIRCLES
-	glGenVertexArrays(1, &VAOC);
-	glGenBuffers(1, &VBOC);
-	glGenBuffers(1, &EBOC);
-	glBindVertexArray(VAOC);
-	float verticesCircle[] = {
-		0.4f, 0.4f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//0 tengah
-		0.4f, 0.01f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//1 atas
-		0.675f, 0.125f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//2 kanan atas
-		0.79f, 0.4f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//3 kanan
-		0.675f, 0.675f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//4 kanan bawah
-		0.4f, 0.79f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//5 bawah
-		0.125f, 0.675f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//6 kiri bawah
-		0.001f, 0.4f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//7 kiri
-		0.125f, 0.125f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//8 kiri atas
-
-		0.4f, 0.01f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//9 atas
-		0.675f, 0.125f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//10 kanan atas
-		0.79f, 0.4f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//11 kanan
-		0.675f, 0.675f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//12 kanan bawah
-		0.4f, 0.79f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//13 bawah
-		0.125f, 0.675f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//14 kiri bawah
-		0.001f, 0.4f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,//15 kiri
-		0.125f, 0.125f, -0.3f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f//16 kiri atas
-	};
-	unsigned int indicesCircle[] = {
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,1,
-
-		1,2,9,
-		2,9,10,
-		2,3,10,
-		3,10,11,
-		3,4,11,
-		4,11,12,
-		4,5,12,
-		5,12,13,
-		5,6,13,
-		6,13,14,
-		6,7,14,
-		7,14,15,
-		7,8,15,
-		8,15,16,
-		8,1,16,
-		1,16,9,
-
-		10,9,10,
-		10,10,11,
-		10,11,12,
-		10,12,13,
-		10,13,14,
-		10,14,15,
-		10,15,16,
-		10,16,9,
-	};
-	glBindBuffer(GL_ARRAY_BUFFER, VBOC);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verticesCircle), verticesCircle, GL_STATIC_DRAW);
-
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOC);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indicesCircle), indicesCircle, GL_STATIC_DRAW);
-
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	// texture coord attribute
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// normal attribute
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	//Wheel Glass
-	glGenVertexArrays(1, &VAOWG);
-	glGenBuffers(1, &VBOWG);
-	glGenBuffers(1, &EBOWG);
-	glBindVertexArray(VAOWG);
-	float verticesWheelGlass[] = {
-		0.4f, 0.4f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//0 tengah
-		0.4f, 0.01f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//1 atas
-		0.675f, 0.125f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//2 kanan atas
-		0.79f, 0.4f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//3 kanan
-		0.675f, 0.675f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//4 kanan bawah
-		0.4f, 0.79f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//5 bawah
-		0.125f, 0.675f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//6 kiri bawah
-		0.001f, 0.4f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//7 kiri
-		0.125f, 0.125f, 0.0f, 1.0f, 1.0f,  1.0f, 0.0f, 1.0f, 0.0f,//8 kiri atas
-
-		0.24f, 0.24f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f, //9
-		0.4f, 0.165f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f,//10
-		0.585f, 0.215f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f,//11
-		0.63f, 0.4f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f,//12
-		0.55f, 0.55f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f,//13
-		0.4f, 0.62f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f,//14
-		0.26f, 0.54f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f,//15
-		0.18f, 0.4f, 0.01f, 0.0f, 0.0f,  0.0f, -1.0f, 0.0f, 0.0f//16
-	};
-	unsigned int indicesWheelGlass[] = {
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,1,
-
-		0,9,10,
-		0,11,12,
-		0,13,14,
-		0,15,16
-	};
-	glBindBuffer(GL_ARRAY_BUFFER, VBOWG);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verticesWheelGlass), verticesWheelGlass, GL_STATIC_DRAW);
-
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOWG);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indicesWheelGlass), indicesWheelGlass, GL_STATIC_DRAW);
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// color attribute
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// texture attribute
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	// normal attribute
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(3);
-
-	//Front Lamp
-	glGenVertexArrays(1, &VAOFL);
-	glGenBuffers(1, &VBOFL);
-	glGenBuffers(1, &EBOFL);
-	glBindVertexArray(VAOFL);
-	float verticesFrontLamp[] = {
-		0.4f, 0.4f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//0 tengah
-		0.4f, 0.01f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//1 atas
-		0.675f, 0.125f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//2 kanan atas
-		0.79f, 0.4f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//3 kanan
-		0.675f, 0.675f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//4 kanan bawah
-		0.4f, 0.79f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//5 bawah
-		0.125f, 0.675f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//6 kiri bawah
-		0.001f, 0.4f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//7 kiri
-		0.125f, 0.125f, 0.0f, 1.0f, 1.0f,  0.0f, 0.0f, 1.0f, 0.0f,//8 kiri atas
-	};
-	unsigned int indicesFrontLamp[] = {
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,1,
-
-		0,9,10,
-		0,11,12,
-		0,13,14,
-		0,15,16
-	};
-	glBindBuffer(GL_ARRAY_BUFFER, VBOFL);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verticesFrontLamp), verticesFrontLamp, GL_STATIC_DRAW);
-
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOFL);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indicesFrontLamp), indicesFrontLamp, GL_STATIC_DRAW);
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// color attribute
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	// normal attribute
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(3);
-
-	unsigned int VBOL, lightVAO;
-	glGenVertexArrays(1, &lightVAO);
-	glBindVertexArray(lightVAO);
-	glGenBuffers(1, &VBOL);
-	float lampu[] = {
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
-	};
-
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBOL);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(lampu), lampu, GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	unsigned int VBOp, particleVAO, particleEBO;
-	glGenVertexArrays(1, &particleVAO);
-	glBindVertexArray(particleVAO);
-	glGenBuffers(1, &particleEBO);
-	glGenBuffers(1, &VBOp);
-	float base_particle[] = {
-		-0.5f, -0.5f, 0.0f,
-		 0.5f, -0.5f, 0.0f,
-		 0.0f, 0.5f, 0.0f,
-
-		-0.5f, -0.5f, 0.5f,
-		 0.5f, -0.5f, 0.5f,
-		 0.0f, 0.5f, 0.5f
-	};
-
-	unsigned int particle_indices[] = {
-		0, 1, 2,
-		3, 4, 5,
-		0, 3, 2,
-		2, 5, 3,
-		0, 3, 1,
-		1, 4, 3,
-		2, 5, 1,
-		1, 4, 5
-	};
-	glBindBuffer(GL_ARRAY_BUFFER, VBOp);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(base_particle), base_particle, GL_STATIC_DRAW);
-
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, particleEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(particle_indices), particle_indices, GL_STATIC_DRAW);
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	glEnableVertexAttribArray(0);
-
-
-	// load and create a texture 
-	// -------------------------
-	unsigned int texture1;
-	// texture 1
-	// ---------
-	glGenTextures(1, &texture1);
-	glBindTexture(GL_TEXTURE_2D, texture1);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char *data = stbi_load("../OpenGLajg/image/car_texture.jpg", &width, &height, &nrChannels, 0);
-
-	if (data)
+	// the meshes come from the files written by tools/meshconv, uploaded straight from the mapping.
+	// the body is built from the outlines of "koordinat mobil.txt" and cached in model/car_profile.mesh,
+	// rebuilt whenever the outlines are newer. without either file the arrays in SceneMeshes.h are used,
+	// the body LOD chain is then built, optimized and quantized here
+	const char *profilePath = "../koordinat mobil.txt";
+	const char *profileCache = "../OpenGLajg/src/model/car_profile.mesh";
+	if (!carProfileCacheValid(profilePath, profileCache))
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		CarProfile profile;
+		if (loadCarProfile(profilePath, CarProfileOptions(), profile))
+			cookMeshFile(profileCache, meshDataView(profile.body), true, true);
 	}
+	MeshFile bodyFile;
+	MeshView body;
+	std::vector<unsigned int> chain, optimizedIndices;
+	std::vector<MeshLod> chainLods;
+	std::vector<unsigned char> optimizedVertices, quantizedVertices;
+	std::vector<unsigned short> narrowIndices;
+	if (bodyFile.open(profileCache) || bodyFile.open("../OpenGLajg/src/model/car_body.mesh"))
+		body = bodyFile.view();
 	else
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		body = carBodyMesh();
+		buildMeshLods(body, chain, chainLods, 8);
+		optimizeMeshView(body, optimizedVertices, optimizedIndices);
+		quantizeMeshView(body, quantizedVertices);
+		narrowMeshIndices(body, narrowIndices);
 	}
-	stbi_image_free(data);
-	
+	carBody.upload(body);
+	// the occlusion rasterizer gets the finest level of the body as plain floats
+	std::vector<float> occluderVertices;
+	std::vector<unsigned int> occluderIndices;
+	decodeMeshPositions(body, occluderVertices);
+	MeshLod occluderLevel = body.lods ? body.lods[0] : MeshLod{ 0, body.indexCount, 0, 0.0f };
+	for (unsigned int i = 0; i < occluderLevel.indexCount && body.indices; i++)
+	{
+		unsigned int index = occluderLevel.indexOffset + i;
+		occluderIndices.push_back(occluderLevel.baseVertex + (body.indexSize == 2 ? ((const unsigned short *)body.indices)[index] : ((const unsigned int *)body.indices)[index]));
+	}
+	if (!lampCube.load("../OpenGLajg/src/model/lamp_cube.mesh"))
+		lampCube.upload(lampCubeMesh());
+	if (!rainDrop.load("../OpenGLajg/src/model/rain_drop.mesh"))
+		rainDrop.upload(rainDropMesh());
+	if (gltfPath && gltfModel.load(gltfPath) && gltfModel.bounds.valid())
+	{
+		// two units across at the car's right, standing on the ground
+		glm::vec3 size = gltfModel.bounds.extents() * 2.0f;
+		float scale = 2.0f / glm::max(glm::max(size.x, size.y), glm::max(size.z, 0.0001f));
+		glm::vec3 base = glm::vec3(gltfModel.bounds.center().x, gltfModel.bounds.min.y, gltfModel.bounds.center().z);
+		gltfPlacement = glm::translate(glm::mat4(1.0f), glm::vec3(2.5f, -0.5f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(scale)) * glm::translate(glm::mat4(1.0f), -base);
+	}
+
+	// wheels, hubs and front lamps are procedural, every tessellation level lives in the geometry arena
+	// ------------------------------------------------------------------------------------------------
+	std::vector<unsigned int> segmentLevels = { 64, 32, 16, 8 };
+	const std::vector<MeshLod> &lodsCircle = geometry.tessellated("wheel", segmentLevels, 0.39f, [](unsigned int segments) {
+		return makeCylinder(0.39f, 0.3f, segments, glm::vec3(0.0f));
+	});
+	const std::vector<MeshLod> &lodsWheelGlass = geometry.tessellated("wheel glass", segmentLevels, 0.39f, [](unsigned int segments) {
+		MeshData hub = makeDisc(0.39f, segments, glm::vec3(1.0f));
+		appendMesh(hub, makeDisc(0.23f, segments, glm::vec3(0.0f)), glm::vec3(0.0f, 0.0f, 0.01f));
+		return hub;
+	});
+	const std::vector<MeshLod> &lodsFrontLamp = geometry.tessellated("front lamp", segmentLevels, 0.39f, [](unsigned int segments) {
+		return makeDisc(0.39f, segments, glm::vec3(1.0f, 1.0f, 0.0f));
+	});
+	geometry.upload();
+
+	// the vertex pulling path keeps its own copy of the car parts in one storage buffer, press V to use it
+	std::unique_ptr<Shader> pullingShader;
+	int pulledBody = -1, pulledArena = -1;
+	if (VertexPuller::supported())
+	{
+		pullingShader.reset(new Shader("../OpenGLajg/src/pulling.vs", "../OpenGLajg/src/fragment.fs"));
+		std::vector<unsigned char> packed;
+		pulledBody = puller.add(body);
+		pulledArena = puller.add(geometry.view(packed));
+		puller.upload();
+	}
+	bodyFile.close();
 
 	// tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
 	// -------------------------------------------------------------------------------------------
 	squareShader.use();
 	squareShader.setInt("texture1", 0);
-	
 
+	// the car does not move, so its draw list and world space bounds are built once
+	// ------------------------------------------------------------------------------
+	AABB boundsBody = carBody.bounds;
+	AABB boundsCircle = geometry.bounds(lodsCircle[0]);
+	AABB boundsWheelGlass = geometry.bounds(lodsWheelGlass[0]);
+	AABB boundsFrontLamp = geometry.bounds(lodsFrontLamp[0]);
+	AABB lampBounds = lampCube.bounds;
+	AABB particleBounds = rainDrop.bounds;
+
+	// the procedural parts are centred on the origin, the hand-typed ones had their centre at (0.4, 0.4)
+	glm::mat4 recenter = glm::translate(glm::mat4(1.0f), glm::vec3(0.4f, 0.4f, 0.0f));
+
+	// body
+	glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
+	float angle = 0;
+	model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+	addCarDraw("body", carBody.VAO, carBody.indexType, carBody.decode, pulledBody, &carBody.lods, model, boundsBody);
+
+	// circle
+	glm::mat4 modelCircle = glm::mat4(1.0f);
+	float angleCircle = 0;
+
+	// roda kiri depan
+	modelCircle = glm::rotate(modelCircle, glm::radians(angleCircle), glm::vec3(1.0f, 0.3f, 0.5f));
+	modelCircle = glm::scale(modelCircle, glm::vec3(0.5f));
+	modelCircle = glm::rotate(modelCircle, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	modelCircle = glm::translate(modelCircle, glm::vec3(0.1f, -1.8f, 1.1f));
+	addCarDraw("roda kiri depan", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsCircle, modelCircle * recenter, boundsCircle);
+
+	// roda kiri belakang
+	modelCircle = glm::translate(modelCircle, glm::vec3(2.0f, 0.0f, 0.0f));
+	addCarDraw("roda kiri belakang", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsCircle, modelCircle * recenter, boundsCircle);
+
+	//roda kanan belakang
+	modelCircle = glm::translate(modelCircle, glm::vec3(0.0f, 0.0f, -1.9f));
+	addCarDraw("roda kanan belakang", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsCircle, modelCircle * recenter, boundsCircle);
+
+	//roda kanan depan
+	modelCircle = glm::translate(modelCircle, glm::vec3(-2.0f, 0.0f, -0.0f));
+	addCarDraw("roda kanan depan", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsCircle, modelCircle * recenter, boundsCircle);
+
+	// wheel glass
+	glm::mat4 modelWheelGlass = glm::mat4(1.0f);
+	float angleWheelGlass = 0;
+	//kiri depan
+	modelWheelGlass = glm::rotate(modelWheelGlass, glm::radians(angleWheelGlass), glm::vec3(1.0f, 0.3f, 0.5f));
+	modelWheelGlass = glm::scale(modelWheelGlass, glm::vec3(0.3f));
+	modelWheelGlass = glm::rotate(modelWheelGlass, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(0.4f, -2.75f, 1.85f));
+	addCarDraw("velg kiri depan", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsWheelGlass, modelWheelGlass * recenter, boundsWheelGlass);
+
+	//kiri belakang
+	modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(3.35f, 0.0f, 0.0f));
+	addCarDraw("velg kiri belakang", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsWheelGlass, modelWheelGlass * recenter, boundsWheelGlass);
+
+	//kanan belakang
+	modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(0.0f, 0.0f, -3.75f));
+	modelWheelGlass = glm::rotate(modelWheelGlass, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(-0.8f, 0.0f, 0.0f));
+	addCarDraw("velg kanan belakang", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsWheelGlass, modelWheelGlass * recenter, boundsWheelGlass);
+
+	//kanan depan
+	modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(3.35f, 0.0f, 0.0f));
+	addCarDraw("velg kanan depan", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsWheelGlass, modelWheelGlass * recenter, boundsWheelGlass);
+
+	//lampu depan
+	glm::mat4 modelFrontLamp = glm::mat4(1.0f);
+
+	//kiri
+	modelFrontLamp = glm::scale(modelFrontLamp, glm::vec3(0.2f));
+	modelFrontLamp = glm::translate(modelFrontLamp, glm::vec3(-1.9f, -2.1f, 0.1f));
+	addCarDraw("lampu kiri", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsFrontLamp, modelFrontLamp * recenter, boundsFrontLamp);
+
+	//kanan
+	modelFrontLamp = glm::translate(modelFrontLamp, glm::vec3(3.0f, 0.0f, 0.0f));
+	addCarDraw("lampu kanan", geometry.VAO, geometry.indexType, geometry.decode, pulledArena, &lodsFrontLamp, modelFrontLamp * recenter, boundsFrontLamp);
+	for (size_t i = 0; i < carDraws.size() && atlas; i++)
+	{
+		const AtlasPlacement *part = findAtlasPlacement(atlasParts, atlasPartName(carDraws[i].name));
+		if (part && part->page == 0)
+			carDraws[i].uvTransform = glm::vec4(part->uvScale[0], part->uvScale[1], part->uvOffset[0], part->uvOffset[1]);
+		else
+			std::cout << carDraws[i].name << " has no texture on the first atlas page" << std::endl;
+	}
+	carBVH.build(carWorldBounds);
+
+	// a square grid of cars around the one in the middle, the skins taken in turn
+	int fleetRadius = 1;
+	while ((unsigned int)((fleetRadius * 2 + 1) * (fleetRadius * 2 + 1)) < fleetCars)
+		fleetRadius++;
+	for (int row = -fleetRadius; row <= fleetRadius; row++)
+		for (int column = -fleetRadius; column <= fleetRadius; column++)
+			if ((row != 0 || column != 0) && fleetInstances.size() + 1 < fleetCars && (int)fleetInstances.size() < FLEET_MAX_INSTANCES)
+				fleetInstances.push_back(glm::vec4(column * 3.0f, 0.0f, row * 2.5f, (float)(fleetInstances.size() % skins.layerCount())));
+	fleet = fleet && !fleetInstances.empty();
+	fleetShader.use();
+	fleetShader.setInt("skins", 1);
+
+	// a benchmark starts from the same state every run : the rain spawns from its seed and the
+	// textures are resident at their start levels before the first frame
+	std::vector<double> cpuFrameTimes, wallFrameTimes;
+	GpuProfiler gpuProfiler;
+	PerfHud perfHud;
+	if (benchmark)
+	{
+		srand(benchmarkScene.seed);
+		while (textures.pending() || skins.pending())
+		{
+			textures.update(TEXTURE_UPLOAD_BUDGET);
+			skins.update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
 
 	// render loop
 	// -----------
-	while (!glfwWindowShouldClose(window))
+	if (profilerEnabled())
+		threadProfileTrack().record("startup", startupBegin, profileClock() - startupBegin);
+	unsigned int frameCount = 0;
+	unsigned int frameLimit = benchmark ? benchmarkScene.warmup + benchmarkScene.frames : headless ? headlessFrames : 0; // 0 until the window closes
+	float fixedTimestep = benchmark ? benchmarkScene.timestep : headless ? HEADLESS_FRAME_TIME : 0.0f;
+	std::chrono::high_resolution_clock::time_point loopStart = std::chrono::high_resolution_clock::now();
+	while ((frameLimit == 0 || frameCount < frameLimit) && (headless || !glfwWindowShouldClose(window)))
 	{
+		PROFILE_SCOPE("frame");
+		std::chrono::high_resolution_clock::time_point frameStart = std::chrono::high_resolution_clock::now();
+		gpuProfiler.beginFrame();
+		renderStats.reset();
+
 		// per-frame time logic
 		// --------------------
-		float currentFrame = glfwGetTime();
+		float currentFrame = fixedTimestep > 0.0f ? frameCount * fixedTimestep : (float)glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		for (unsigned int i = 0; i < nr_particles; i++) {
+		// the drops spawn once and wrap around at the bottom (Rain::update)
+		while (rains.size() < nr_particles) {
 			float x = (rand() % 200) / 100.0 - 1;
 			float y = (rand() % 200) / 100.0 - 1;
 			float z = (rand() % 200) / 100.0 - 1;
 			rains.push_back(Rain(glm::vec4(x, y, z, 0.0), glm::vec4(0.0f, -0.01f, 0.0f, 0.0f)));
 		}
 
-		// input
+		// input, a benchmark follows its camera path instead
 		// -----
-		processInput(window);
+		if (benchmark)
+		{
+			float pathYaw = yaw, pathPitch = pitch;
+			benchmarkCamera(benchmarkScene, currentFrame, cameraPos, pathYaw, pathPitch);
+			setCameraAngles(pathYaw, pathPitch);
+		}
+		else if (!headless)
+			processInput(window);
+
+		// a slice of the pending texture uploads, the placeholder is bound until the last row is in
+		{
+			GpuScope pass(gpuProfiler, "textures");
+			textures.update(TEXTURE_UPLOAD_BUDGET);
+			skins.update();
+		}
+		if (textureReportRequested)
+		{
+			textures.report(stdout);
+			textureReportRequested = false;
+		}
 
 		// render
 		// ------
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		{
+			GpuScope pass(gpuProfiler, "clear");
+			glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		}
 
 		// be sure to activate shader when setting uniforms/drawing objects
 		lightingShader.use();
+		renderStats.state();
 		lightingShader.setVec3("objectColor", 1.0f, 0.5f, 0.31f);
 		lightingShader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
 		lightingShader.setVec3("lightPos", lightPos);
@@ -584,12 +548,14 @@ int main()
 
 		// bind textures on corresponding texture units
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture1);
+		glBindTexture(GL_TEXTURE_2D, textures.texture(carTexture));
+		renderStats.state();
 		//glActiveTexture(GL_TEXTURE1);
 		//glBindTexture(GL_TEXTURE_2D, texture2);
 
 		// activate shader
 		squareShader.use();
+		renderStats.state();
 
 		// pass projection matrix to shader (note that in this case it could change every frame)
 		glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
@@ -599,140 +565,370 @@ int main()
 		glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 		squareShader.setMat4("view", view);
 
-		// render boxes
-		glBindVertexArray(VAOSQ);
-		glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-		float angle = 0;
-		model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-		squareShader.setMat4("model", model);
-
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 3 * sizeof(int), GL_UNSIGNED_INT, 0);
-
-
-		// render circle
-		glBindVertexArray(VAOC);
-		glm::mat4 modelCircle = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-		float angleCircle = 0;
-
-		// roda kiri depan
-		modelCircle = glm::rotate(modelCircle, glm::radians(angleCircle), glm::vec3(1.0f, 0.3f, 0.5f));
-		modelCircle = glm::scale(modelCircle, glm::vec3(0.5f));
-		modelCircle = glm::rotate(modelCircle, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		modelCircle = glm::translate(modelCircle, glm::vec3(0.1f, -1.8f, 1.1f));
-		squareShader.setMat4("model", modelCircle);
-
-		// roda kiri belakang
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 5 * sizeof(float), GL_UNSIGNED_INT, 0);
-		modelCircle = glm::translate(modelCircle, glm::vec3(2.0f, 0.0f, 0.0f));
-		squareShader.setMat4("model", modelCircle);
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 5 * sizeof(float), GL_UNSIGNED_INT, 0);
-
-		//roda kanan belakang
-		modelCircle = glm::translate(modelCircle, glm::vec3(0.0f, 0.0f, -1.9f));
-		squareShader.setMat4("model", modelCircle);
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 5 * sizeof(float), GL_UNSIGNED_INT, 0);
-
-		//roda kanan depan
-		modelCircle = glm::translate(modelCircle, glm::vec3(-2.0f, 0.0f, -0.0f));
-		squareShader.setMat4("model", modelCircle);
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 5 * sizeof(float), GL_UNSIGNED_INT, 0);
-
-		// render wheel glass
-		glBindVertexArray(VAOWG);
-		glm::mat4 modelWheelGlass = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-		float angleWheelGlass = 0;
-		//kiri depan
-		modelWheelGlass = glm::rotate(modelWheelGlass, glm::radians(angleWheelGlass), glm::vec3(1.0f, 0.3f, 0.5f));
-		modelWheelGlass = glm::scale(modelWheelGlass, glm::vec3(0.3f));
-		modelWheelGlass = glm::rotate(modelWheelGlass, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(0.4f, -2.75f, 1.85f));
-
-		squareShader.setMat4("model", modelWheelGlass);
-
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 3 * sizeof(int), GL_UNSIGNED_INT, 0);
-		//kiri belakang
-		modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(3.35f, 0.0f, 0.0f));
-		squareShader.setMat4("model", modelWheelGlass);
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 3 * sizeof(int), GL_UNSIGNED_INT, 0);
-
-		//kiri belakang
-		modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(0.0f, 0.0f, -3.75f));
-		modelWheelGlass = glm::rotate(modelWheelGlass, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(-0.8f, 0.0f, 0.0f));
-		squareShader.setMat4("model", modelWheelGlass);
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 3 * sizeof(int), GL_UNSIGNED_INT, 0);
-
-		//kiri depan
-		modelWheelGlass = glm::translate(modelWheelGlass, glm::vec3(3.35f, 0.0f, 0.0f));
-		squareShader.setMat4("model", modelWheelGlass);
-		glDrawElements(GL_TRIANGLES, sizeof(indices) / 3 * sizeof(int), GL_UNSIGNED_INT, 0);
-
-		//lampu depan
-		glBindVertexArray(VAOFL);
-		glm::mat4 modelFrontLamp = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-		float angleFrontLamp = 0;
-
-		//kiri
-		modelFrontLamp = glm::scale(modelFrontLamp, glm::vec3(0.2f));
-		modelFrontLamp = glm::translate(modelFrontLamp, glm::vec3(-1.9f, -2.1f, 0.1f));
-		squareShader.setMat4("model", modelFrontLamp);
-		glDrawElements(GL_TRIANGLES, sizeof(indicesFrontLamp) / 5 * sizeof(int), GL_UNSIGNED_INT, 0);
-
-		//kanan
-		modelFrontLamp = glm::translate(modelFrontLamp, glm::vec3(3.0f, 0.0f, 0.0f));
-		squareShader.setMat4("model", modelFrontLamp);
-		glDrawElements(GL_TRIANGLES, sizeof(indicesFrontLamp) / 5 * sizeof(int), GL_UNSIGNED_INT, 0);
-
-		// also draw the lamp object
-		lampShader.use();
-		lampShader.setMat4("projection", projection);
-		lampShader.setMat4("view", view);
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, lightPos);
-		model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
-		lampShader.setMat4("model", model);
-
-		glBindVertexArray(lightVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-		particleShader.use();
-		glm::mat4 modelParticle = glm::mat4(1.0f);
-		glm::mat4 transform = glm::mat4(1.0);
-		transform = glm::scale(transform, glm::vec3(0.0025, 0.005, 0.005));
-		glm::vec4 color = glm::vec4(0.0f, 1.0f, 1.0f, 1.0f);
-
-		particleShader.setMat4("model", modelParticle);
-		particleShader.setMat4("projection", projection);
-		particleShader.setMat4("view", view);
-		particleShader.setMat4("transform", transform);
-		particleShader.setVec4("color", color);
-		glBindVertexArray(particleVAO);
-
-		for (int i = 0; i < nr_particles; i++) {
-			particleShader.setVec4("offset", rains[i].offset);
-			glDrawElements(GL_TRIANGLES, 24, GL_UNSIGNED_INT, 0);
-			rains[i].update();
+		// pick the car part under the cursor, or under the screen centre while the mouse steers the camera
+		if (pickRequested)
+		{
+			float pickX = cursorFree ? (float)cursorX : SCR_WIDTH / 2.0f;
+			float pickY = cursorFree ? (float)cursorY : SCR_HEIGHT / 2.0f;
+			Ray ray = Ray::fromScreen(pickX, pickY, (float)SCR_WIDTH, (float)SCR_HEIGHT, projection, view);
+			float distance;
+			int part = carBVH.raycast(ray, carWorldBounds, distance);
+			if (part >= 0)
+				std::cout << "Picked " << carDraws[part].name << " at distance " << distance << std::endl;
+			else
+				std::cout << "Picked nothing" << std::endl;
+			pickRequested = false;
+		}
+
+		// the car body is the only large occluder, rasterize it into the occlusion depth buffer
+		{
+			PROFILE_SCOPE("occlusion");
+			occlusion.beginFrame(projection * view);
+			if (!occluderIndices.empty())
+				occlusion.addOccluder(&occluderVertices[0], 3, &occluderIndices[0], occluderIndices.size(), carDraws[0].model);
+			occlusion.buildPyramid();
+		}
+
+		// render car parts that survive frustum and occlusion culling
+		Frustum frustum(projection * view);
+		{
+			PROFILE_SCOPE("cull");
+			carVisible.clear();
+			carBVH.cull(frustum, carWorldBounds, carVisible);
+		}
+		{
+			GpuScope pass(gpuProfiler, "car");
+			unsigned long long pulledTriangles = 0;
+			for (size_t i = 0; i < carVisible.size(); i++)
+			{
+				if (!occlusion.isVisible(carWorldBounds[carVisible[i]]))
+					continue;
+				DrawItem &item = carDraws[carVisible[i]];
+
+				// choose the level from how many pixels a model unit covers at the part's distance
+				float distance = glm::max(glm::length(carWorldBounds[carVisible[i]].center() - cameraPos), 0.001f);
+				float pixelsPerUnit = SCR_HEIGHT / (2.0f * tan(glm::radians(fov) / 2.0f) * distance);
+				item.lod = selectLod(*item.lods, pixelsPerUnit, item.lod);
+				const MeshLod &lod = (*item.lods)[item.lod];
+
+				// residency feedback : the part spans this many pixels, scaled up to the whole page of an atlas
+				glm::vec3 size = carWorldBounds[carVisible[i]].extents() * 2.0f;
+				float partPixels = pixelsPerUnit * glm::max(size.x, glm::max(size.y, size.z));
+				textures.request(carTexture, partPixels / glm::max(item.uvTransform.x, item.uvTransform.y));
+
+				if (vertexPulling && item.pulledMesh >= 0)
+				{
+					puller.draw(item.pulledMesh, lod, item.model, item.uvTransform);
+					pulledTriangles += lod.indexCount / 3;
+					continue;
+				}
+				glBindVertexArray(item.VAO);
+				renderStats.state();
+				squareShader.setMat4("model", item.model);
+				setPositionDecode(squareShader, item.decode);
+				squareShader.setVec4("uvTransform", item.uvTransform);
+				size_t indexSize = item.indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+				glDrawElementsBaseVertex(GL_TRIANGLES, lod.indexCount, item.indexType, (void*)(lod.indexOffset * indexSize), lod.baseVertex);
+				renderStats.draw(lod.indexCount / 3);
+			}
+
+			// every visible part queued above goes out in a single multi-draw
+			if (puller.queued())
+			{
+				pullingShader->use();
+				pullingShader->setInt("texture1", 0);
+				pullingShader->setMat4("projection", projection);
+				pullingShader->setMat4("view", view);
+				puller.flush();
+				renderStats.state();
+				renderStats.draw(pulledTriangles);
+			}
+		}
+
+		// the --gltf model under the scene's light
+		if (gltfModel.loaded() && frustum.intersects(gltfModel.bounds.transformed(gltfPlacement)))
+		{
+			GpuScope pass(gpuProfiler, "gltf");
+			gltfShader.use();
+			gltfShader.setInt("baseColorTexture", 0);
+			gltfShader.setMat4("projection", projection);
+			gltfShader.setMat4("view", view);
+			gltfShader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+			gltfShader.setVec3("lightPos", lightPos);
+			gltfShader.setVec3("viewPos", cameraPos);
+			gltfModel.draw(gltfShader, gltfPlacement);
+			glBindTexture(GL_TEXTURE_2D, textures.texture(carTexture));
+			renderStats.state(2 + gltfModel.drawCalls * 2); // the program, the car texture again, a texture and a vertex array a primitive
+			renderStats.drawCalls += gltfModel.drawCalls;
+			renderStats.triangles += gltfModel.triangles;
+		}
+
+		// the fleet : every part once for all the cars, skin layers picked per instance
+		if (fleet)
+		{
+			GpuScope pass(gpuProfiler, "fleet");
+
+			// only the cars whose whole bounds pass the frustum and occlusion tests are instanced
+			AABB carBox;
+			for (size_t i = 0; i < carWorldBounds.size(); i++)
+				carBox.grow(carWorldBounds[i]);
+			fleetVisible.clear();
+			float nearest = 100.0f;
+			for (size_t i = 0; i < fleetInstances.size(); i++)
+			{
+				glm::vec3 offset = glm::vec3(fleetInstances[i]);
+				AABB box(carBox.min + offset, carBox.max + offset);
+				if (!frustum.intersects(box) || !occlusion.isVisible(box))
+					continue;
+				fleetVisible.push_back(fleetInstances[i]);
+				nearest = glm::min(nearest, glm::length(box.center() - cameraPos));
+			}
+
+			// the skin levels follow the nearest visible car, the whole array streams as one texture
+			glm::vec3 size = carBox.extents() * 2.0f;
+			float skinPixels = SCR_HEIGHT / (2.0f * tan(glm::radians(fov) / 2.0f) * glm::max(nearest, 0.001f)) * glm::max(size.x, glm::max(size.y, size.z));
+			skins.setWantedLevel(glm::max(0, (int)floor(log2(SKIN_SIZE / glm::max(skinPixels, 1.0f)))));
+
+			if (!fleetVisible.empty())
+			{
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, skins.texture());
+				glActiveTexture(GL_TEXTURE0);
+				fleetShader.use();
+				renderStats.state(2);
+				fleetShader.setMat4("projection", projection);
+				fleetShader.setMat4("view", view);
+				// lit like the --gltf model, the skin layer is the color
+				fleetShader.setVec3("objectColor", 1.0f, 1.0f, 1.0f);
+				fleetShader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+				fleetShader.setVec3("lightPos", lightPos);
+				fleetShader.setVec3("viewPos", cameraPos);
+				glUniform4fv(glGetUniformLocation(fleetShader.ID, "instances"), (GLsizei)fleetVisible.size(), glm::value_ptr(fleetVisible[0]));
+				for (size_t i = 0; i < carDraws.size(); i++)
+				{
+					// each part at the level its nearest visible copy needs
+					DrawItem &item = carDraws[i];
+					float partNearest = 100.0f;
+					for (size_t v = 0; v < fleetVisible.size(); v++)
+						partNearest = glm::min(partNearest, glm::length(carWorldBounds[i].center() + glm::vec3(fleetVisible[v]) - cameraPos));
+					float pixelsPerUnit = SCR_HEIGHT / (2.0f * tan(glm::radians(fov) / 2.0f) * glm::max(partNearest, 0.001f));
+					item.fleetLod = selectLod(*item.lods, pixelsPerUnit, item.fleetLod);
+					const MeshLod &lod = (*item.lods)[item.fleetLod];
+
+					glBindVertexArray(item.VAO);
+					renderStats.state();
+					fleetShader.setMat4("model", item.model);
+					setPositionDecode(fleetShader, item.decode);
+					size_t indexSize = item.indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+					glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, item.indexType, (void*)(lod.indexOffset * indexSize),
+						(GLsizei)fleetVisible.size(), lod.baseVertex);
+					renderStats.draw(lod.indexCount / 3, (unsigned int)fleetVisible.size());
+				}
+			}
+		}
+		else
+			skins.setWantedLevel(-1);
+
+		// also draw the lamp objects, any after the first go round the car at the height of the light
+		{
+			GpuScope pass(gpuProfiler, "lamps");
+			for (unsigned int i = 0; i < lightCount; i++)
+			{
+				model = glm::rotate(glm::mat4(1.0f), glm::two_pi<float>() * i / lightCount, glm::vec3(0.0f, 1.0f, 0.0f));
+				model = glm::translate(model, lightPos);
+				model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
+				AABB lampWorldBounds = lampBounds.transformed(model);
+				if (frustum.intersects(lampWorldBounds) && occlusion.isVisible(lampWorldBounds))
+				{
+					lampShader.use();
+					lampShader.setMat4("projection", projection);
+					lampShader.setMat4("view", view);
+					lampShader.setMat4("model", model);
+					setPositionDecode(lampShader, lampCube.decode);
+
+					lampCube.draw();
+					renderStats.state(2);
+					renderStats.draw(lampCube.triangleCount());
+				}
+			}
+		}
+
+		// the rain
+		unsigned int rainDrawn = 0;
+		{
+			GpuScope pass(gpuProfiler, "rain");
+			particleShader.use();
+			renderStats.state();
+			glm::mat4 modelParticle = glm::mat4(1.0f);
+			glm::mat4 transform = glm::mat4(1.0);
+			transform = glm::scale(transform, glm::vec3(0.0025, 0.005, 0.005));
+			glm::vec4 color = glm::vec4(0.0f, 1.0f, 1.0f, 1.0f);
+
+			particleShader.setMat4("model", modelParticle);
+			particleShader.setMat4("projection", projection);
+			particleShader.setMat4("view", view);
+			particleShader.setMat4("transform", transform);
+			particleShader.setVec4("color", color);
+			setPositionDecode(particleShader, rainDrop.decode);
+			glBindVertexArray(rainDrop.VAO);
+			renderStats.state();
+
+			// every rain drop is a copy of the drop mesh moved by its offset
+			AABB dropBounds = particleBounds.transformed(transform);
+			rainBounds.clear();
+			for (unsigned int i = 0; i < nr_particles; i++)
+				rainBounds.add(glm::vec3(rains[i].offset) + dropBounds.center(), dropBounds.extents());
+			rainBounds.cull(frustum, rainVisible);
+
+			for (unsigned int i = 0; i < nr_particles; i++) {
+				if (rainVisible[i] && occlusion.isVisible(AABB(glm::vec3(rains[i].offset) + dropBounds.min, glm::vec3(rains[i].offset) + dropBounds.max))) {
+					particleShader.setVec4("offset", rains[i].offset);
+					glDrawElements(GL_TRIANGLES, rainDrop.indexCount, rainDrop.indexType, 0);
+					renderStats.draw(rainDrop.indexCount / 3);
+					rainDrawn++;
+				}
+				rains[i].update();
+			}
+		}
+		// the overlay on top, last of the frame. it has the occlusion culling numbers so the O toggle can be compared
+		if (hud)
+		{
+			GpuScope pass(gpuProfiler, "hud");
+			PerfHud::Input input = { nr_particles, rainDrawn, textures.residentBytes() + skins.levelBytes(skins.resident()),
+				occlusion.enabled, occlusion.tested, occlusion.culled };
+			perfHud.draw(hudShader, renderStats, input, SCR_WIDTH, SCR_HEIGHT);
 		}
 
 		// glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
 		// -------------------------------------------------------------------------------
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		frameCount++;
+		gpuProfiler.endFrame();
+		double cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+		if (benchmark)
+			cpuFrameTimes.push_back(cpuMilliseconds);
+		perfHud.addFrame(cpuMilliseconds, gpuProfiler.frameMilliseconds().empty() ? 0.0 : gpuProfiler.frameMilliseconds().back());
+		{
+			PROFILE_SCOPE("swap");
+			if (headless)
+				offscreen.endFrame();
+			else
+			{
+				glfwSwapBuffers(window);
+				glfwPollEvents();
+			}
+		}
+		// the wall clock of the frame includes the swap, or the glFinish of --headless
+		if (benchmark)
+			wallFrameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+	}
+	if (headless)
+	{
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loopStart).count();
+		printf("headless : %u frames in %.1f ms, %.3f ms a frame\n", frameCount, milliseconds, frameCount ? milliseconds / frameCount : 0.0);
+		if (headlessOutput)
+		{
+			std::vector<unsigned char> pixels;
+			offscreen.readPixels(pixels);
+			if (!stbi_write_png(headlessOutput, SCR_WIDTH, SCR_HEIGHT, 4, &pixels[0], SCR_WIDTH * 4))
+				std::cout << headlessOutput << " could not be written" << std::endl;
+		}
 	}
+	if (benchmark)
+	{
+		// the warmup frames are left out of the report, and so are the GPU frames with a bogus
+		// query result : the GPU times that are left are told apart from the warmup by frame number
+		gpuProfiler.finish();
+		std::vector<double> gpuFrameTimes;
+		std::vector<unsigned int> gpuFrames;
+		for (size_t i = 0; i < gpuProfiler.frameMilliseconds().size(); i++)
+			if (gpuProfiler.frameNumbers()[i] >= benchmarkScene.warmup)
+			{
+				gpuFrameTimes.push_back(gpuProfiler.frameMilliseconds()[i]);
+				gpuFrames.push_back(gpuProfiler.frameNumbers()[i] - benchmarkScene.warmup);
+			}
+		size_t warmup = std::min((size_t)benchmarkScene.warmup, cpuFrameTimes.size());
+		cpuFrameTimes.erase(cpuFrameTimes.begin(), cpuFrameTimes.begin() + warmup);
+		wallFrameTimes.erase(wallFrameTimes.begin(), wallFrameTimes.begin() + warmup);
+		FrameTimeStats cpuStats = frameTimeStats(cpuFrameTimes), gpuStats = frameTimeStats(gpuFrameTimes), wallStats = frameTimeStats(wallFrameTimes);
+		printf("benchmark %s : %u frames, cpu mean %.3f p50 %.3f p95 %.3f p99 %.3f max %.3f ms\n", benchmarkScene.name.c_str(), (unsigned int)cpuStats.count,
+			cpuStats.mean, cpuStats.p50, cpuStats.p95, cpuStats.p99, cpuStats.max);
+		printf("benchmark %s : %u frames, gpu mean %.3f p50 %.3f p95 %.3f p99 %.3f max %.3f ms\n", benchmarkScene.name.c_str(), (unsigned int)gpuStats.count,
+			gpuStats.mean, gpuStats.p50, gpuStats.p95, gpuStats.p99, gpuStats.max);
+		if (gpuProfiler.invalidFrames())
+			printf("benchmark %s : %u frames without a GPU time, a query result was longer than its pass could have taken\n", benchmarkScene.name.c_str(), gpuProfiler.invalidFrames());
+		printf("benchmark %s : %u frames, wall mean %.3f p50 %.3f p95 %.3f p99 %.3f max %.3f ms\n", benchmarkScene.name.c_str(), (unsigned int)wallStats.count,
+			wallStats.mean, wallStats.p50, wallStats.p95, wallStats.p99, wallStats.max);
+		writeBenchmarkReport(benchmarkReport, benchmarkScene, cpuFrameTimes, gpuFrameTimes, gpuFrames, wallFrameTimes);
+	}
+	if (tracePath)
+	{
+		gpuProfiler.finish();
+		writeChromeTrace(tracePath);
+	}
+	gpuProfiler.release();
+	perfHud.release();
 
 	// optional: de-allocate all resources once they've outlived their purpose:
 	// ------------------------------------------------------------------------
-	glDeleteVertexArrays(1, &VAOSQ);
-	glDeleteBuffers(1, &VBO);
-	glDeleteVertexArrays(1, &lightVAO);
-	glDeleteBuffers(1, &VBOL);
+	carBody.release();
+	gltfModel.release();
+	lampCube.release();
+	rainDrop.release();
+	geometry.release();
+	puller.release();
+	textures.release(carTexture);
+	skins.release();
+	textures.releaseAll();
 
 	// glfw: terminate, clearing all previously allocated GLFW resources.
 	// ------------------------------------------------------------------
-	glfwTerminate();
+	if (headless)
+		offscreen.destroy();
+	else
+		glfwTerminate();
 	return 0;
 }
 
+// queue a static car part, its local bounds are moved to world space once here
+// ---------------------------------------------------------------------------------------------------------
+void addCarDraw(const char *name, unsigned int VAO, unsigned int indexType, const PositionDecode &decode, int pulledMesh, const std::vector<MeshLod> *lods, const glm::mat4 &model, const AABB &localBounds)
+{
+	DrawItem item;
+	item.name = name;
+	item.VAO = VAO;
+	item.indexType = indexType;
+	item.decode = decode;
+	item.pulledMesh = pulledMesh;
+	item.lods = lods;
+	item.lod = 0;
+	item.fleetLod = 0;
+	item.model = model;
+	item.uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+	carDraws.push_back(item);
+	carWorldBounds.push_back(localBounds.transformed(model));
+}
+
+// the atlas image of a car part : the wheels, rims and lamps share one each
+// ---------------------------------------------------------------------------------------------------------
+const char *atlasPartName(const char *drawName)
+{
+	if (strncmp(drawName, "roda", 4) == 0)
+		return "wheel";
+	if (strncmp(drawName, "velg", 4) == 0)
+		return "rim";
+	if (strncmp(drawName, "lampu", 5) == 0)
+		return "lamp";
+	return drawName;
+}
+
+// positions of quantized meshes are stored relative to their bounds, the vertex shaders scale them back
+// ---------------------------------------------------------------------------------------------------------
+void setPositionDecode(const Shader &shader, const PositionDecode &decode)
+{
+	shader.setVec3("positionScale", decode.scale);
+	shader.setVec3("positionOffset", decode.offset);
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
@@ -740,6 +936,47 @@ void processInput(GLFWwindow *window)
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
+	static bool occlusionKeyDown = false;
+	bool occlusionKey = glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS;
+	if (occlusionKey && !occlusionKeyDown)
+		occlusion.enabled = !occlusion.enabled;
+	occlusionKeyDown = occlusionKey;
+
+	static bool pullingKeyDown = false;
+	bool pullingKey = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+	if (pullingKey && !pullingKeyDown && VertexPuller::supported())
+	{
+		vertexPulling = !vertexPulling;
+		std::cout << "vertex pulling " << (vertexPulling ? "on" : "off") << std::endl;
+	}
+	pullingKeyDown = pullingKey;
+
+	static bool fleetKeyDown = false;
+	bool fleetKey = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+	if (fleetKey && !fleetKeyDown)
+		fleet = !fleet;
+	fleetKeyDown = fleetKey;
+
+	static bool hudKeyDown = false;
+	bool hudKey = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+	if (hudKey && !hudKeyDown)
+		hud = !hud;
+	hudKeyDown = hudKey;
+
+	static bool reportKeyDown = false;
+	bool reportKey = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+	if (reportKey && !reportKeyDown)
+		textureReportRequested = true;
+	reportKeyDown = reportKey;
+
+	bool freeCursor = glfwGetKey(window, GLFW_KEY_LEFT_ALT) == GLFW_PRESS;
+	if (freeCursor != cursorFree)
+	{
+		cursorFree = freeCursor;
+		glfwSetInputMode(window, GLFW_CURSOR, cursorFree ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+		firstMouse = true;
+	}
+
 	float cameraSpeed = 2.5 * deltaTime;
 	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
 		cameraPos += cameraSpeed * cameraFront;
@@ -765,6 +1002,12 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 // -------------------------------------------------------
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
+	cursorX = xpos;
+	cursorY = ypos;
+	// a released cursor points at things instead of turning the camera
+	if (cursorFree)
+		return;
+
 	if (firstMouse)
 	{
 		lastX = xpos;
@@ -781,8 +1024,15 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 	xoffset *= sensitivity;
 	yoffset *= sensitivity;
 
-	yaw += xoffset;
-	pitch += yoffset;
+	setCameraAngles(yaw + xoffset, pitch + yoffset);
+}
+
+// turns the camera to yaw and pitch in degrees, the mouse and the benchmark camera path both steer through here
+// ---------------------------------------------------------------------------------------------------------
+void setCameraAngles(float newYaw, float newPitch)
+{
+	yaw = newYaw;
+	pitch = newPitch;
 
 	// make sure that when pitch is out of bounds, screen doesn't get flipped
 	if (pitch > 89.0f)
@@ -797,6 +1047,14 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 	cameraFront = glm::normalize(front);
 }
 
+// glfw: whenever a mouse button is pressed, this callback is called
+// -------------------------------------------------------
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+		pickRequested = true;
+}
+
 // glfw: whenever the mouse scroll wheel scrolls, this callback is called
 // ----------------------------------------------------------------------
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
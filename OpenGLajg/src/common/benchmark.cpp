@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "benchmark.hpp"
+
+namespace {
+
+// nearest rank : the smallest time at least percent of the frames are not slower than
+double percentile(const std::vector<double> & sorted, double percent){
+	size_t rank = (size_t)(percent / 100.0 * sorted.size() + 0.999999);
+	return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+void writeStatsJSON(FILE * file, const FrameTimeStats & stats){
+	fprintf(file, "{ \"frames\": %u, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+		(unsigned int)stats.count, stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+}
+
+bool byTime(const BenchmarkCameraKey & a, const BenchmarkCameraKey & b){
+	return a.time < b.time;
+}
+
+} // namespace
+
+BenchmarkScene::BenchmarkScene()
+	: name("benchmark"), cars(1), particles(5000), lights(1), width(800), height(600), seed(1),
+	  timestep(1.0f / 60.0f), warmup(60), frames(600)
+{
+}
+
+bool readBenchmarkScene(const char * path, BenchmarkScene & out){
+	out = BenchmarkScene();
+	FILE * file = fopen(path, "r");
+	if (file == NULL){
+		printf("%s could not be opened. Are you in the right directory ?\n", path);
+		return false;
+	}
+	char line[1024], text[256];
+	bool ok = true;
+	int number = 0;
+	while (ok && fgets(line, sizeof(line), file)){
+		number++;
+		char * comment = strchr(line, '#');
+		if (comment)
+			*comment = 0;
+		BenchmarkCameraKey key;
+		if (sscanf(line, " name %255s", text) == 1)
+			out.name = text;
+		else if (sscanf(line, " cars %u", &out.cars) == 1 || sscanf(line, " particles %u", &out.particles) == 1
+			|| sscanf(line, " lights %u", &out.lights) == 1 || sscanf(line, " seed %u", &out.seed) == 1
+			|| sscanf(line, " warmup %u", &out.warmup) == 1 || sscanf(line, " frames %u", &out.frames) == 1)
+			continue;
+		else if (sscanf(line, " size %ux%u", &out.width, &out.height) == 2 && out.width > 0 && out.height > 0)
+			continue;
+		else if (sscanf(line, " timestep %f", &out.timestep) == 1 && out.timestep > 0.0f)
+			continue;
+		else if (sscanf(line, " camera %f %f %f %f %f %f", &key.time, &key.position.x, &key.position.y, &key.position.z, &key.yaw, &key.pitch) == 6)
+			out.camera.push_back(key);
+		else if (line[strspn(line, " \t\r\n")] != 0){
+			printf("%s:%d : expected a scene setting or a camera key\n", path, number);
+			ok = false;
+		}
+	}
+	fclose(file);
+	std::stable_sort(out.camera.begin(), out.camera.end(), byTime);
+	return ok;
+}
+
+void benchmarkCamera(const BenchmarkScene & scene, float time, glm::vec3 & position, float & yaw, float & pitch){
+	const std::vector<BenchmarkCameraKey> & keys = scene.camera;
+	if (keys.empty())
+		return;
+	size_t next = 0;
+	while (next < keys.size() && keys[next].time <= time)
+		next++;
+	const BenchmarkCameraKey & a = keys[next == 0 ? 0 : next - 1];
+	const BenchmarkCameraKey & b = keys[std::min(next, keys.size() - 1)];
+	float t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0f;
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	position = glm::mix(a.position, b.position, t);
+	yaw = a.yaw + (b.yaw - a.yaw) * t;
+	pitch = a.pitch + (b.pitch - a.pitch) * t;
+}
+
+FrameTimeStats frameTimeStats(const std::vector<double> & milliseconds){
+	FrameTimeStats stats = { milliseconds.size(), 0.0, 0.0, 0.0, 0.0, 0.0 };
+	if (milliseconds.empty())
+		return stats;
+	std::vector<double> sorted(milliseconds);
+	std::sort(sorted.begin(), sorted.end());
+	for (size_t i=0; i<sorted.size(); i++)
+		stats.mean += sorted[i];
+	stats.mean /= sorted.size();
+	stats.p50 = percentile(sorted, 50.0);
+	stats.p95 = percentile(sorted, 95.0);
+	stats.p99 = percentile(sorted, 99.0);
+	stats.max = sorted.back();
+	return stats;
+}
+
+bool writeBenchmarkReport(const char * base, const BenchmarkScene & scene, const std::vector<double> & cpu, const std::vector<double> & gpu,
+	const std::vector<unsigned int> & gpu_frames, const std::vector<double> & wall){
+	FrameTimeStats cpuStats = frameTimeStats(cpu), gpuStats = frameTimeStats(gpu), wallStats = frameTimeStats(wall);
+
+	std::string path = std::string(base) + ".csv";
+	FILE * file = fopen(path.c_str(), "w");
+	if (file == NULL){
+		printf("%s could not be written\n", path.c_str());
+		return false;
+	}
+	fprintf(file, "scene,timer,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+	const char * names[3] = { "cpu", "gpu", "wall" };
+	const FrameTimeStats * stats[3] = { &cpuStats, &gpuStats, &wallStats };
+	for (int i=0; i<3; i++)
+		fprintf(file, "%s,%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f\n", scene.name.c_str(), names[i], (unsigned int)stats[i]->count,
+			stats[i]->mean, stats[i]->p50, stats[i]->p95, stats[i]->p99, stats[i]->max);
+	bool ok = fclose(file) == 0;
+
+	path = std::string(base) + ".json";
+	file = fopen(path.c_str(), "w");
+	if (file == NULL){
+		printf("%s could not be written\n", path.c_str());
+		return false;
+	}
+	fprintf(file, "{\n  \"scene\": { \"name\": \"%s\", \"cars\": %u, \"particles\": %u, \"lights\": %u, \"width\": %u, \"height\": %u,"
+		" \"seed\": %u, \"timestep\": %.6f, \"warmup\": %u, \"frames\": %u },\n",
+		scene.name.c_str(), scene.cars, scene.particles, scene.lights, scene.width, scene.height, scene.seed, scene.timestep, scene.warmup, scene.frames);
+	fprintf(file, "  \"cpu_ms\": ");
+	writeStatsJSON(file, cpuStats);
+	fprintf(file, ",\n  \"gpu_ms\": ");
+	writeStatsJSON(file, gpuStats);
+	fprintf(file, ",\n  \"wall_ms\": ");
+	writeStatsJSON(file, wallStats);
+	fprintf(file, ",\n  \"frames\": [");
+	size_t next = 0; // the first gpu time not written yet
+	for (size_t i=0; i<std::max(cpu.size(), wall.size()); i++){
+		fprintf(file, "%s\n    [%.4f, ", i ? "," : "", i < cpu.size() ? cpu[i] : 0.0);
+		if (next < gpu.size() && gpu_frames[next] == i)
+			fprintf(file, "%.4f", gpu[next++]);
+		else
+			fprintf(file, "null");
+		fprintf(file, ", %.4f]", i < wall.size() ? wall[i] : 0.0);
+	}
+	fprintf(file, "\n  ]\n}\n");
+	return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,64 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <vector>
+#include <string>
+
+#include <glm/glm.hpp>
+
+// Benchmark scenes : what application.cpp --benchmark draws, on a fixed timestep with a seeded
+// particle spawn and a scripted camera, so two runs draw the same frames. A scene is a text file
+// of "key value" lines, # starts a comment:
+//   name car_orbit
+//   cars 25                 the car in the middle and a grid of cars around it (the fleet), at most 65
+//   particles 5000          rain drops
+//   lights 1                lamps, the first one lights the scene
+//   size 1280x720
+//   seed 1234
+//   timestep 0.016667       seconds a frame
+//   warmup 60               frames drawn before the measured ones
+//   frames 600              frames measured
+//   camera 0 0 0.5 6 -90 0  a key of the camera path : time x y z yaw pitch, linear in between
+
+struct BenchmarkCameraKey {
+	float time;
+	glm::vec3 position;
+	float yaw, pitch; // degrees, as the mouse look of application.cpp
+};
+
+struct BenchmarkScene {
+	std::string name;
+	unsigned int cars;
+	unsigned int particles;
+	unsigned int lights;
+	unsigned int width, height;
+	unsigned int seed;
+	float timestep;
+	unsigned int warmup;
+	unsigned int frames;
+	std::vector<BenchmarkCameraKey> camera; // by time
+	BenchmarkScene();
+};
+
+// mean and nearest-rank percentiles of frame times in milliseconds
+struct FrameTimeStats {
+	size_t count;
+	double mean, p50, p95, p99, max;
+};
+
+bool readBenchmarkScene(const char * path, BenchmarkScene & out);
+
+// the camera at time seconds, held at the first and the last key outside the path
+void benchmarkCamera(const BenchmarkScene & scene, float time, glm::vec3 & position, float & yaw, float & pitch);
+
+FrameTimeStats frameTimeStats(const std::vector<double> & milliseconds);
+
+// cpu : the frame's work up to the swap, gpu : the sum of its timed passes, wall : frame start to
+// after the swap (the glFinish of --headless), what the frame rate really is
+// base.csv : one row per timer (cpu, gpu, wall) with its statistics, easy to append to a trend sheet
+// base.json : the scene, the statistics and every measured frame. gpu_frames is the frame of each
+// gpu time counted from the first measured one, a frame without a gpu time has null there
+bool writeBenchmarkReport(const char * base, const BenchmarkScene & scene, const std::vector<double> & cpu, const std::vector<double> & gpu,
+	const std::vector<unsigned int> & gpu_frames, const std::vector<double> & wall);
+
+#endif
@@ -0,0 +1,380 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "carprofile.hpp"
+#include "mappedfile.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+const float PI = 3.14159265358979f;
+
+std::string lowercase(std::string text){
+	for (size_t i=0; i<text.size(); i++)
+		text[i] = (char)tolower((unsigned char)text[i]);
+	return text;
+}
+
+bool nameMatches(const std::string & name, const std::string & part){
+	return !part.empty() && lowercase(name).find(lowercase(part)) != std::string::npos;
+}
+
+float cross(const glm::vec2 & a, const glm::vec2 & b){
+	return a.x * b.y - a.y * b.x;
+}
+
+float signedArea(const std::vector<glm::vec2> & polygon){
+	float area = 0.0f;
+	for (size_t i=0; i<polygon.size(); i++)
+		area += cross(polygon[i], polygon[(i + 1) % polygon.size()]);
+	return area * 0.5f;
+}
+
+// x, y of an outline without repeated points, the file closes outlines by repeating the first one
+std::vector<glm::vec2> outline2D(const ProfileOutline & outline){
+	std::vector<glm::vec2> points;
+	for (size_t i=0; i<outline.points.size(); i++){
+		glm::vec2 p(outline.points[i]);
+		if (points.empty() || p != points.back())
+			points.push_back(p);
+	}
+	while (points.size() > 1 && points.front() == points.back())
+		points.pop_back();
+	return points;
+}
+
+bool insideTriangle(const glm::vec2 & p, const glm::vec2 & a, const glm::vec2 & b, const glm::vec2 & c){
+	// counter clockwise triangle, points on an edge count as inside so no ear can cut through them
+	return cross(b - a, p - a) >= 0.0f && cross(c - b, p - b) >= 0.0f && cross(a - c, p - c) >= 0.0f;
+}
+
+struct ProfileMapping {
+	const CarProfileOptions & options;
+
+	explicit ProfileMapping(const CarProfileOptions & options) : options(options) {}
+
+	glm::vec3 point(const glm::vec3 & pixel) const {
+		glm::vec3 d = pixel - options.pixelOrigin;
+		return options.modelOrigin + glm::vec3(d.z * options.scale.z, -d.y * options.scale.y, -d.x * options.scale.x);
+	}
+	glm::vec3 direction(const glm::vec3 & pixel) const {
+		return glm::vec3(pixel.z * options.scale.z, -pixel.y * options.scale.y, -pixel.x * options.scale.x);
+	}
+};
+
+Vertex makeVertex(const glm::vec3 & position, const glm::vec3 & color, const glm::vec2 & uv, const glm::vec3 & normal){
+	Vertex v;
+	v.position = position;
+	v.color = color;
+	v.uv = uv;
+	v.normal = normal;
+	return v;
+}
+
+// appends a triangle facing `outward`, whatever the winding it was given in
+void addTriangle(MeshData & mesh, unsigned int a, unsigned int b, unsigned int c, const glm::vec3 & outward){
+	glm::vec3 n = glm::cross(mesh.vertices[b].position - mesh.vertices[a].position, mesh.vertices[c].position - mesh.vertices[a].position);
+	if (glm::dot(n, outward) < 0.0f)
+		std::swap(b, c);
+	mesh.indices.push_back(a);
+	mesh.indices.push_back(b);
+	mesh.indices.push_back(c);
+}
+
+void addCap(MeshData & mesh, const std::vector<glm::vec2> & outline, const std::vector<unsigned int> & triangles,
+	float z, const glm::vec3 & outward, const ProfileMapping & mapping, const glm::vec3 & color){
+	glm::vec2 lo(outline[0]), hi(outline[0]);
+	for (size_t i=1; i<outline.size(); i++){
+		lo = glm::min(lo, outline[i]);
+		hi = glm::max(hi, outline[i]);
+	}
+	glm::vec2 size = glm::max(hi - lo, glm::vec2(1e-6f));
+	unsigned int base = (unsigned int)mesh.vertices.size();
+	for (size_t i=0; i<outline.size(); i++){
+		glm::vec2 uv((outline[i].x - lo.x) / size.x, (hi.y - outline[i].y) / size.y);
+		mesh.vertices.push_back(makeVertex(mapping.point(glm::vec3(outline[i], z)), color, uv, outward));
+	}
+	for (size_t i=0; i+2<triangles.size(); i+=3)
+		addTriangle(mesh, base + triangles[i], base + triangles[i+1], base + triangles[i+2], outward);
+}
+
+}
+
+CarProfileOptions::CarProfileOptions()
+	: pixelOrigin(19.25f, 70.0f, 21.0f), modelOrigin(0.0f, -0.7f, 0.0f), scale(1.0f / 35.0f, 1.0f / 35.0f, 1.0f / 42.0f),
+	  widthSegments(8), crown(1.5f), creaseAngle(40.0f),
+	  bodyName("samping"), glassName("kaca"), wheelName("roda"),
+	  bodyColor(1.0f), glassColor(0.77f, 1.0f, 1.0f)
+{
+}
+
+bool parseCarProfile(const char * path, std::vector<ProfileOutline> & outlines){
+	PROFILE_SCOPE("parse car profile");
+	outlines.clear();
+	FILE * file = fopen(path, "r");
+	if (file == NULL){
+		printf("%s could not be opened. Are you in the right directory ?\n", path);
+		return false;
+	}
+	char line[1024];
+	int current = -1;
+	int number = 0;
+	bool ok = true;
+	while (fgets(line, sizeof(line), file)){
+		number++;
+		char * text = line;
+		while (*text == ' ' || *text == '\t')
+			text++;
+		size_t length = strlen(text);
+		while (length > 0 && isspace((unsigned char)text[length - 1]))
+			text[--length] = 0;
+		if (length == 0)
+			continue;
+		if (text[0] == '=' ){
+			current = -1; // separator between groups
+			continue;
+		}
+		if (!isdigit((unsigned char)text[0]) && text[0] != '-' && text[0] != '+' && text[0] != '.'){
+			outlines.push_back(ProfileOutline());
+			outlines.back().name = text;
+			current = (int)outlines.size() - 1;
+			continue;
+		}
+		// "x, y, z, u, v," with an optional f suffix, only the position is used
+		float values[3];
+		int count = 0;
+		char * p = text;
+		while (count < 3){
+			char * end;
+			values[count] = (float)strtod(p, &end);
+			if (end == p)
+				break;
+			count++;
+			p = end;
+			while (*p == 'f' || *p == 'F' || *p == ',' || *p == ' ' || *p == '\t')
+				p++;
+		}
+		if (count < 3){
+			printf("%s:%d : expected x, y, z\n", path, number);
+			ok = false;
+			break;
+		}
+		if (current < 0){
+			outlines.push_back(ProfileOutline());
+			current = (int)outlines.size() - 1;
+		}
+		outlines[current].points.push_back(glm::vec3(values[0], values[1], values[2]));
+	}
+	fclose(file);
+	return ok;
+}
+
+bool triangulatePolygon(const std::vector<glm::vec2> & polygon, std::vector<unsigned int> & out_indices){
+	out_indices.clear();
+	std::vector<unsigned int> remaining;
+	for (size_t i=0; i<polygon.size(); i++)
+		remaining.push_back((unsigned int)i);
+	// work counter clockwise, the ear test below assumes it
+	if (signedArea(polygon) < 0.0f)
+		std::reverse(remaining.begin(), remaining.end());
+
+	size_t start = 0;
+	while (remaining.size() > 3){
+		size_t n = remaining.size();
+		bool clipped = false;
+		for (size_t k=0; k<n && !clipped; k++){
+			size_t i = (start + k) % n;
+			unsigned int a = remaining[(i + n - 1) % n], b = remaining[i], c = remaining[(i + 1) % n];
+			float turn = cross(polygon[b] - polygon[a], polygon[c] - polygon[b]);
+			if (turn < 0.0f)
+				continue; // reflex
+			if (turn > 0.0f){
+				bool empty = true;
+				for (size_t j=0; j<n && empty; j++){
+					unsigned int v = remaining[j];
+					if (v == a || v == b || v == c)
+						continue;
+					const glm::vec2 & p = polygon[v];
+					if (p == polygon[a] || p == polygon[b] || p == polygon[c])
+						continue;
+					empty = !insideTriangle(p, polygon[a], polygon[b], polygon[c]);
+				}
+				if (!empty)
+					continue;
+			}
+			// collinear points still get their (flat) triangle, so every outline edge stays an edge
+			// of the result and meets the walls without T-junctions
+			out_indices.push_back(a);
+			out_indices.push_back(b);
+			out_indices.push_back(c);
+			remaining.erase(remaining.begin() + i);
+			// continuing next to the last ear gives fans instead of slivers
+			start = i == 0 ? 0 : i - 1;
+			clipped = true;
+		}
+		if (!clipped)
+			return false;
+	}
+	if (remaining.size() == 3){
+		out_indices.push_back(remaining[0]);
+		out_indices.push_back(remaining[1]);
+		out_indices.push_back(remaining[2]);
+	}
+	return true;
+}
+
+bool buildCarProfile(const std::vector<ProfileOutline> & outlines, const CarProfileOptions & options, CarProfile & out){
+	PROFILE_SCOPE("build car profile");
+	out.body.vertices.clear();
+	out.body.indices.clear();
+	out.wheels.clear();
+	ProfileMapping mapping(options);
+
+	// the silhouette and the width of the car come from the side outlines
+	std::vector<glm::vec2> outline;
+	float zMin = INFINITY, zMax = -INFINITY;
+	for (size_t i=0; i<outlines.size(); i++){
+		if (!nameMatches(outlines[i].name, options.bodyName))
+			continue;
+		if (outline.size() < 3)
+			outline = outline2D(outlines[i]);
+		for (size_t j=0; j<outlines[i].points.size(); j++){
+			zMin = std::min(zMin, outlines[i].points[j].z);
+			zMax = std::max(zMax, outlines[i].points[j].z);
+		}
+	}
+	if (outline.size() < 3 || !(zMax > zMin)){
+		printf("car profile : no \"%s\" outline with a width\n", options.bodyName.c_str());
+		return false;
+	}
+	if (signedArea(outline) < 0.0f)
+		std::reverse(outline.begin(), outline.end());
+	size_t n = outline.size();
+
+	std::vector<unsigned int> triangles;
+	if (!triangulatePolygon(outline, triangles)){
+		printf("car profile : the \"%s\" outline intersects itself\n", options.bodyName.c_str());
+		return false;
+	}
+
+	// window panels span the width along one outline edge, they are matched by their end points
+	std::vector<std::vector<glm::vec2> > glass;
+	for (size_t i=0; i<outlines.size(); i++)
+		if (nameMatches(outlines[i].name, options.glassName))
+			glass.push_back(outline2D(outlines[i]));
+
+	// counter clockwise, so the outward normal of an edge d is (d.y, -d.x)
+	std::vector<glm::vec2> edgeNormal(n), vertexNormal(n);
+	std::vector<float> arc(n + 1, 0.0f);
+	for (size_t i=0; i<n; i++){
+		glm::vec2 d = outline[(i + 1) % n] - outline[i];
+		edgeNormal[i] = glm::normalize(glm::vec2(d.y, -d.x));
+		arc[i + 1] = arc[i] + glm::length(d);
+	}
+	std::vector<bool> crease(n);
+	float creaseCos = std::cos(options.creaseAngle * PI / 180.0f);
+	for (size_t i=0; i<n; i++){
+		const glm::vec2 & before = edgeNormal[(i + n - 1) % n], & after = edgeNormal[i];
+		vertexNormal[i] = glm::normalize(before + after);
+		crease[i] = glm::dot(before, after) < creaseCos;
+	}
+
+	MeshData & mesh = out.body;
+	unsigned int rows = std::max(1u, options.widthSegments) + 1;
+	float width = zMax - zMin;
+
+	// two columns of wall vertices per outline point, one ending the edge before it and one starting
+	// the edge after it. They share normals unless the point is a crease
+	std::vector<unsigned int> columnStart(2 * n);
+	for (size_t i=0; i<n; i++){
+		glm::vec2 p = outline[i];
+		// only upward facing walls (pixel y is down) bulge, the seam with the caps stays closed
+		float lift = options.crown * std::max(0.0f, -vertexNormal[i].y);
+		for (int side=0; side<2; side++){
+			size_t column = 2 * i + side;
+			columnStart[column] = (unsigned int)mesh.vertices.size();
+			size_t edge = side == 0 ? (i + n - 1) % n : i;
+			bool isGlass = false;
+			for (size_t g=0; g<glass.size() && !isGlass; g++){
+				const std::vector<glm::vec2> & panel = glass[g];
+				isGlass = std::find(panel.begin(), panel.end(), outline[edge]) != panel.end()
+					&& std::find(panel.begin(), panel.end(), outline[(edge + 1) % n]) != panel.end();
+			}
+			// the seam at the first point needs u = 1 on the closing edge
+			float u = (side == 0 && i == 0 ? arc[n] : arc[i]) / arc[n];
+			for (unsigned int r=0; r<rows; r++){
+				float t = (float)r / (rows - 1);
+				glm::vec2 q = p + vertexNormal[i] * lift * std::sin(PI * t);
+				mesh.vertices.push_back(makeVertex(mapping.point(glm::vec3(q, zMin + t * width)),
+					isGlass ? options.glassColor : options.bodyColor, glm::vec2(u, t), glm::vec3(0.0f)));
+			}
+		}
+	}
+
+	// walls, with area weighted face normals summed per vertex
+	std::vector<glm::vec3> faceSum(mesh.vertices.size(), glm::vec3(0.0f));
+	for (size_t i=0; i<n; i++){
+		size_t from = 2 * i + 1, to = 2 * ((i + 1) % n);
+		glm::vec3 outward = mapping.direction(glm::vec3(edgeNormal[i], 0.0f));
+		for (unsigned int r=0; r+1<rows; r++){
+			unsigned int a = columnStart[from] + r, b = columnStart[to] + r;
+			addTriangle(mesh, a, b, b + 1, outward);
+			addTriangle(mesh, a, b + 1, a + 1, outward);
+			const unsigned int * tri = &mesh.indices[mesh.indices.size() - 6];
+			for (int k=0; k<6; k+=3){
+				glm::vec3 face = glm::cross(mesh.vertices[tri[k+1]].position - mesh.vertices[tri[k]].position,
+					mesh.vertices[tri[k+2]].position - mesh.vertices[tri[k]].position);
+				for (int m=0; m<3; m++)
+					faceSum[tri[k+m]] += face;
+			}
+		}
+	}
+	// both columns of a smooth point get the sum of the two, a crease keeps them apart
+	for (size_t i=0; i<n; i++){
+		for (unsigned int r=0; r<rows; r++){
+			unsigned int a = columnStart[2 * i] + r, b = columnStart[2 * i + 1] + r;
+			glm::vec3 sa = faceSum[a], sb = faceSum[b];
+			if (!crease[i])
+				sa = sb = sa + sb;
+			mesh.vertices[a].normal = glm::length(sa) > 0.0f ? glm::normalize(sa) : glm::vec3(0.0f, 1.0f, 0.0f);
+			mesh.vertices[b].normal = glm::length(sb) > 0.0f ? glm::normalize(sb) : glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+	}
+
+	// flat caps on both sides
+	addCap(mesh, outline, triangles, zMin, glm::normalize(mapping.direction(glm::vec3(0.0f, 0.0f, -1.0f))), mapping, options.bodyColor);
+	addCap(mesh, outline, triangles, zMax, glm::normalize(mapping.direction(glm::vec3(0.0f, 0.0f, 1.0f))), mapping, options.bodyColor);
+
+	for (size_t i=0; i<outlines.size(); i++){
+		if (!nameMatches(outlines[i].name, options.wheelName) || outlines[i].points.empty())
+			continue;
+		glm::vec3 lo(outlines[i].points[0]), hi(outlines[i].points[0]);
+		for (size_t j=1; j<outlines[i].points.size(); j++){
+			lo = glm::min(lo, outlines[i].points[j]);
+			hi = glm::max(hi, outlines[i].points[j]);
+		}
+		ProfileWheel wheel;
+		wheel.name = outlines[i].name;
+		wheel.centre = mapping.point((lo + hi) * 0.5f);
+		wheel.radius = ((hi.x - lo.x) * options.scale.x + (hi.y - lo.y) * options.scale.y) * 0.25f;
+		out.wheels.push_back(wheel);
+	}
+	return true;
+}
+
+bool loadCarProfile(const char * path, const CarProfileOptions & options, CarProfile & out){
+	std::vector<ProfileOutline> outlines;
+	return parseCarProfile(path, outlines) && buildCarProfile(outlines, options, out);
+}
+
+bool carProfileCacheValid(const char * profile_path, const char * cache_path){
+	return cacheUpToDate(profile_path, cache_path);
+}
@@ -0,0 +1,67 @@
+#ifndef CARPROFILE_HPP
+#define CARPROFILE_HPP
+
+#include <vector>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "mesh.hpp"
+
+// Car geometry from the pixel-space outlines of "koordinat mobil.txt" : a name line followed by
+// "x, y, z, u, v," points per outline, "====" lines between groups. The side silhouette is
+// triangulated into the two side caps and extruded across the width, the walls in between
+// are stitched from the same outline, so the body is closed.
+
+// One named outline of the file, in pixels : x along the car, y down, z across
+struct ProfileOutline {
+	std::string name;
+	std::vector<glm::vec3> points;
+};
+
+struct CarProfileOptions {
+	// model = modelOrigin + scale * offset from pixelOrigin, with pixel x going to model -z,
+	// pixel y (down) to model +y (up) and pixel z to model x
+	glm::vec3 pixelOrigin;
+	glm::vec3 modelOrigin;
+	glm::vec3 scale;          // per pixel axis
+	unsigned int widthSegments; // wall subdivisions across the car
+	float crown;              // pixels the upward facing walls bulge out in the middle, 0 keeps them flat
+	float creaseAngle;        // degrees, outline corners sharper than this get hard normals
+	std::string bodyName;     // outlines whose name contains these (any case) are the side silhouette,
+	std::string glassName;    // the windows
+	std::string wheelName;    // and the wheels
+	glm::vec3 bodyColor;
+	glm::vec3 glassColor;
+
+	// the defaults put the wheel arches on the procedural wheels of application.cpp
+	CarProfileOptions();
+};
+
+// a wheel outline reduced to a circle on one side of the car, in model space
+struct ProfileWheel {
+	std::string name;
+	glm::vec3 centre;
+	float radius;
+};
+
+struct CarProfile {
+	MeshData body;
+	std::vector<ProfileWheel> wheels;
+};
+
+bool parseCarProfile(const char * path, std::vector<ProfileOutline> & outlines);
+
+// Ear clipping of a simple polygon in either winding, the triangles come out counter clockwise.
+// Collinear points are kept (with flat triangles), false when no ear is left (self intersecting input).
+bool triangulatePolygon(const std::vector<glm::vec2> & polygon, std::vector<unsigned int> & out_indices);
+
+bool buildCarProfile(const std::vector<ProfileOutline> & outlines, const CarProfileOptions & options, CarProfile & out);
+
+// parseCarProfile and buildCarProfile in one go
+bool loadCarProfile(const char * path, const CarProfileOptions & options, CarProfile & out);
+
+// true when cache_path exists and is at least as new as profile_path
+bool carProfileCacheValid(const char * profile_path, const char * cache_path);
+
+#endif
@@ -0,0 +1,549 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "gltfloader.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+// Just enough JSON for glTF : a small DOM with objects kept as key/value lists.
+struct JsonValue {
+	enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT } type;
+	double number;
+	bool boolean;
+	std::string string;
+	std::vector<JsonValue> items;                            // ARRAY
+	std::vector<std::pair<std::string, JsonValue> > members; // OBJECT
+
+	JsonValue() : type(NUL), number(0.0), boolean(false) {}
+
+	const JsonValue * find(const char * key) const {
+		for (size_t i=0; i<members.size(); i++)
+			if (members[i].first == key) return &members[i].second;
+		return NULL;
+	}
+	size_t size() const { return items.size(); }
+	const JsonValue & operator[](size_t i) const { return items[i]; }
+
+	double numberOr(const char * key, double fallback) const {
+		const JsonValue * v = find(key);
+		return v && v->type == NUMBER ? v->number : fallback;
+	}
+	int intOr(const char * key, int fallback) const { return (int)numberOr(key, fallback); }
+	// a whole number from 0 to limit, false when it is outside, so that the cast cannot wrap
+	bool sizeIn(const char * key, size_t fallback, size_t limit, size_t & out) const {
+		double v = numberOr(key, (double)fallback);
+		out = v >= 0.0 && v <= (double)limit ? (size_t)v : 0;
+		return v >= 0.0 && v <= (double)limit && v == std::floor(v);
+	}
+	bool boolOr(const char * key, bool fallback) const {
+		const JsonValue * v = find(key);
+		return v && v->type == BOOLEAN ? v->boolean : fallback;
+	}
+	std::string stringOr(const char * key, const char * fallback) const {
+		const JsonValue * v = find(key);
+		return v && v->type == STRING ? v->string : std::string(fallback);
+	}
+	// fills up to n numbers of an array member, returns how many were there
+	size_t numbers(const char * key, float * out, size_t n) const {
+		const JsonValue * v = find(key);
+		if (!v || v->type != ARRAY) return 0;
+		size_t count = std::min(n, v->items.size());
+		for (size_t i=0; i<count; i++) out[i] = (float)v->items[i].number;
+		return count;
+	}
+};
+
+class JsonParser {
+public:
+	JsonParser(const char * begin, const char * end) : p(begin), end(end), depth(0) {}
+
+	bool parse(JsonValue & out){
+		if (!value(out)) return false;
+		skip();
+		return p == end || *p == '\0';
+	}
+
+private:
+	const char * p;
+	const char * end;
+	int depth;
+
+	void skip(){ while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++; }
+
+	bool literal(const char * word){
+		size_t n = strlen(word);
+		if ((size_t)(end - p) < n || memcmp(p, word, n) != 0) return false;
+		p += n;
+		return true;
+	}
+
+	static void appendUtf8(std::string & s, unsigned int c){
+		if (c < 0x80) s += (char)c;
+		else if (c < 0x800){ s += (char)(0xC0 | (c >> 6)); s += (char)(0x80 | (c & 0x3F)); }
+		else if (c < 0x10000){ s += (char)(0xE0 | (c >> 12)); s += (char)(0x80 | ((c >> 6) & 0x3F)); s += (char)(0x80 | (c & 0x3F)); }
+		else { s += (char)(0xF0 | (c >> 18)); s += (char)(0x80 | ((c >> 12) & 0x3F)); s += (char)(0x80 | ((c >> 6) & 0x3F)); s += (char)(0x80 | (c & 0x3F)); }
+	}
+
+	bool hex4(unsigned int & c){
+		if (end - p < 4) return false;
+		c = 0;
+		for (int i=0; i<4; i++, p++){
+			char h = *p;
+			c <<= 4;
+			if (h >= '0' && h <= '9') c |= h - '0';
+			else if (h >= 'a' && h <= 'f') c |= h - 'a' + 10;
+			else if (h >= 'A' && h <= 'F') c |= h - 'A' + 10;
+			else return false;
+		}
+		return true;
+	}
+
+	bool string(std::string & out){
+		p++; // opening quote
+		while (p < end && *p != '"'){
+			if (*p != '\\'){ out += *p++; continue; }
+			if (++p >= end) return false;
+			char e = *p++;
+			switch (e){
+			case '"': out += '"'; break;
+			case '\\': out += '\\'; break;
+			case '/': out += '/'; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u': {
+				unsigned int c;
+				if (!hex4(c)) return false;
+				// surrogate pair
+				if (c >= 0xD800 && c < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u'){
+					unsigned int low;
+					p += 2;
+					if (!hex4(low)) return false;
+					c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+				}
+				appendUtf8(out, c);
+				break;
+			}
+			default: return false;
+			}
+		}
+		if (p >= end) return false;
+		p++;
+		return true;
+	}
+
+	bool value(JsonValue & out){
+		skip();
+		if (p >= end || depth > 64) return false;
+		switch (*p){
+		case '{': {
+			out.type = JsonValue::OBJECT;
+			depth++;
+			p++;
+			skip();
+			if (p < end && *p == '}'){ p++; depth--; return true; }
+			while (true){
+				skip();
+				if (p >= end || *p != '"') return false;
+				out.members.push_back(std::make_pair(std::string(), JsonValue()));
+				if (!string(out.members.back().first)) return false;
+				skip();
+				if (p >= end || *p++ != ':') return false;
+				if (!value(out.members.back().second)) return false;
+				skip();
+				if (p < end && *p == ','){ p++; continue; }
+				if (p < end && *p == '}'){ p++; depth--; return true; }
+				return false;
+			}
+		}
+		case '[': {
+			out.type = JsonValue::ARRAY;
+			depth++;
+			p++;
+			skip();
+			if (p < end && *p == ']'){ p++; depth--; return true; }
+			while (true){
+				out.items.push_back(JsonValue());
+				if (!value(out.items.back())) return false;
+				skip();
+				if (p < end && *p == ','){ p++; continue; }
+				if (p < end && *p == ']'){ p++; depth--; return true; }
+				return false;
+			}
+		}
+		case '"':
+			out.type = JsonValue::STRING;
+			return string(out.string);
+		case 't': out.type = JsonValue::BOOLEAN; out.boolean = true; return literal("true");
+		case 'f': out.type = JsonValue::BOOLEAN; out.boolean = false; return literal("false");
+		case 'n': out.type = JsonValue::NUL; return literal("null");
+		default: {
+			// the JSON chunk is not null terminated, copy the number out before strtod
+			char buffer[64];
+			size_t n = 0;
+			while (p + n < end && n < sizeof(buffer) - 1 && strchr("+-0123456789.eE", p[n])) n++;
+			if (n == 0) return false;
+			memcpy(buffer, p, n);
+			buffer[n] = '\0';
+			char * stop;
+			out.type = JsonValue::NUMBER;
+			out.number = strtod(buffer, &stop);
+			if (stop == buffer) return false;
+			p += stop - buffer;
+			return true;
+		}
+		}
+	}
+};
+
+const unsigned int GLB_MAGIC = 0x46546C67; // "glTF"
+const unsigned int CHUNK_JSON = 0x4E4F534A;
+const unsigned int CHUNK_BIN = 0x004E4942;
+
+const unsigned int GLTF_TRIANGLES = 0x0004;
+const size_t MAX_STRIDE = 252;             // byteStride of a vertex buffer view, per the specification
+const size_t MAX_COUNT = (size_t)1 << 28; // elements of an accessor, far above any model this loads
+
+unsigned int componentCount(const std::string & type){
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2") return 2;
+	if (type == "VEC3") return 3;
+	if (type == "VEC4") return 4;
+	if (type == "MAT2") return 4;
+	if (type == "MAT3") return 9;
+	if (type == "MAT4") return 16;
+	return 0;
+}
+
+size_t componentSize(unsigned int componentType){
+	switch (componentType){
+	case 0x1400: case 0x1401: return 1; // GL_BYTE, GL_UNSIGNED_BYTE
+	case 0x1402: case 0x1403: return 2; // GL_SHORT, GL_UNSIGNED_SHORT
+	case 0x1405: case 0x1406: return 4; // GL_UNSIGNED_INT, GL_FLOAT
+	default: return 0;
+	}
+}
+
+int attributeSlot(const std::string & name){
+	if (name == "POSITION") return GLTF_POSITION;
+	if (name == "COLOR_0") return GLTF_COLOR_0;
+	if (name == "TEXCOORD_0") return GLTF_TEXCOORD_0;
+	if (name == "NORMAL") return GLTF_NORMAL;
+	if (name == "TANGENT") return GLTF_TANGENT;
+	return -1;
+}
+
+}
+
+size_t gltfElementSize(const GltfAccessor & accessor){
+	return componentSize(accessor.componentType) * accessor.components;
+}
+
+namespace {
+
+// every index of an index accessor has to name one of the vertex_count vertices
+bool indicesInRange(const unsigned char * binary, const std::vector<GltfBufferView> & views, const GltfAccessor & accessor, size_t vertex_count){
+	size_t size = componentSize(accessor.componentType);
+	if (accessor.components != 1 || (accessor.componentType != 0x1401 && accessor.componentType != 0x1403 && accessor.componentType != 0x1405))
+		return false; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT scalars
+	if (accessor.bufferView < 0)
+		return accessor.count == 0 || vertex_count > 0; // all zeros
+	const GltfBufferView & view = views[accessor.bufferView];
+	const unsigned char * element = binary + view.offset + accessor.offset;
+	size_t stride = view.stride ? view.stride : size;
+	for (size_t i=0; i<accessor.count; i++, element += stride){
+		unsigned int index = 0;
+		if (size == 1) index = element[0];
+		else if (size == 2){ unsigned short v; memcpy(&v, element, 2); index = v; }
+		else memcpy(&index, element, 4);
+		if (index >= vertex_count)
+			return false;
+	}
+	return true;
+}
+
+}
+
+bool GltfFile::open(const char * path){
+	PROFILE_SCOPE("open glTF");
+	close();
+	if (!file.open(path))
+		return false;
+	const unsigned char * bytes = file.data();
+	size_t size = file.size();
+
+	unsigned int header[3];
+	if (size < 20){
+		printf("%s is not a binary glTF file\n", path);
+		close();
+		return false;
+	}
+	memcpy(header, bytes, sizeof(header));
+	if (header[0] != GLB_MAGIC || header[1] != 2 || header[2] > size){
+		printf("%s is not a binary glTF 2.0 file\n", path);
+		close();
+		return false;
+	}
+	size = header[2];
+
+	// chunks : JSON first, then an optional BIN, unknown chunks are skipped
+	const char * json = NULL;
+	size_t jsonSize = 0;
+	for (size_t offset = 12; offset + 8 <= size;){
+		unsigned int chunk[2];
+		memcpy(chunk, bytes + offset, sizeof(chunk));
+		offset += 8;
+		if (chunk[0] > size - offset) break;
+		if (chunk[1] == CHUNK_JSON && !json){ json = (const char *)bytes + offset; jsonSize = chunk[0]; }
+		else if (chunk[1] == CHUNK_BIN && !binary){ binary = bytes + offset; binarySize = chunk[0]; }
+		offset += (chunk[0] + 3) & ~3u;
+	}
+	JsonValue root;
+	if (!json || !JsonParser(json, json + jsonSize).parse(root) || root.type != JsonValue::OBJECT){
+		printf("%s : invalid JSON chunk\n", path);
+		close();
+		return false;
+	}
+
+	bool valid = true;
+	const JsonValue * list;
+
+	if ((list = root.find("buffers"))){
+		for (size_t i=0; i<list->size(); i++){
+			if ((*list)[i].find("uri")){
+				printf("%s : external buffers are not supported\n", path);
+				valid = false;
+			}
+		}
+	}
+
+	if ((list = root.find("bufferViews"))){
+		for (size_t i=0; i<list->size(); i++){
+			const JsonValue & v = (*list)[i];
+			GltfBufferView view;
+			size_t stride = 0;
+			valid = v.sizeIn("byteOffset", 0, binarySize, view.offset) && valid;
+			valid = v.sizeIn("byteLength", 0, binarySize, view.length) && valid;
+			valid = v.sizeIn("byteStride", 0, MAX_STRIDE, stride) && valid;
+			view.stride = (unsigned int)stride;
+			view.target = (unsigned int)v.intOr("target", 0);
+			valid = valid && v.intOr("buffer", 0) == 0 && view.length <= binarySize - view.offset;
+			bufferViews.push_back(view);
+		}
+	}
+
+	if ((list = root.find("accessors"))){
+		for (size_t i=0; i<list->size(); i++){
+			const JsonValue & a = (*list)[i];
+			GltfAccessor accessor;
+			accessor.bufferView = a.intOr("bufferView", -1);
+			valid = a.sizeIn("byteOffset", 0, binarySize, accessor.offset) && valid;
+			accessor.componentType = (unsigned int)a.intOr("componentType", 0);
+			accessor.components = componentCount(a.stringOr("type", ""));
+			valid = a.sizeIn("count", 0, MAX_COUNT, accessor.count) && valid;
+			accessor.normalized = a.boolOr("normalized", false);
+			accessor.min = accessor.max = glm::vec3(0.0f);
+			accessor.hasBounds = a.numbers("min", &accessor.min[0], 3) == 3 && a.numbers("max", &accessor.max[0], 3) == 3;
+			if (a.find("sparse")){
+				printf("%s : sparse accessors are not supported\n", path);
+				valid = false;
+			}
+			size_t element = gltfElementSize(accessor);
+			if (element == 0 || accessor.bufferView >= (int)bufferViews.size())
+				valid = false;
+			else if (accessor.bufferView >= 0 && accessor.count > 0){
+				// the last element has to end inside the view. offset and count are bounded, so nothing wraps
+				const GltfBufferView & view = bufferViews[accessor.bufferView];
+				size_t stride = view.stride ? view.stride : element;
+				valid = valid && accessor.offset <= view.length && element <= view.length - accessor.offset
+					&& (accessor.count - 1) * stride <= view.length - accessor.offset - element;
+			}
+			accessors.push_back(accessor);
+		}
+	}
+
+	if ((list = root.find("meshes"))){
+		for (size_t i=0; i<list->size(); i++){
+			const JsonValue & m = (*list)[i];
+			GltfMesh mesh;
+			mesh.name = m.stringOr("name", "");
+			const JsonValue * primitives = m.find("primitives");
+			for (size_t k=0; primitives && k<primitives->size(); k++){
+				const JsonValue & p = (*primitives)[k];
+				GltfPrimitive primitive;
+				for (int a=0; a<GLTF_ATTRIBUTE_COUNT; a++) primitive.attributes[a] = -1;
+				const JsonValue * attributes = p.find("attributes");
+				for (size_t a=0; attributes && a<attributes->members.size(); a++){
+					int slot = attributeSlot(attributes->members[a].first);
+					if (slot >= 0) primitive.attributes[slot] = (int)attributes->members[a].second.number;
+				}
+				primitive.indices = p.intOr("indices", -1);
+				primitive.material = p.intOr("material", -1);
+				primitive.mode = (unsigned int)p.intOr("mode", GLTF_TRIANGLES);
+				for (int a=0; a<GLTF_ATTRIBUTE_COUNT; a++)
+					valid = valid && primitive.attributes[a] < (int)accessors.size();
+				valid = valid && primitive.attributes[GLTF_POSITION] >= 0 && primitive.indices < (int)accessors.size();
+				// every attribute has one element a vertex, and the indices stay among the vertices
+				if (valid){
+					size_t vertices = accessors[primitive.attributes[GLTF_POSITION]].count;
+					for (int a=0; a<GLTF_ATTRIBUTE_COUNT; a++)
+						valid = valid && (primitive.attributes[a] < 0 || accessors[primitive.attributes[a]].count == vertices);
+					if (valid && primitive.indices >= 0 && !indicesInRange(binary, bufferViews, accessors[primitive.indices], vertices)){
+						printf("%s : mesh %u has indices past its %u vertices\n", path, (unsigned int)i, (unsigned int)vertices);
+						valid = false;
+					}
+				}
+				mesh.primitives.push_back(primitive);
+			}
+			meshes.push_back(mesh);
+		}
+	}
+
+	// textures only matter as the indirection from a material to its image
+	std::vector<int> textureImages;
+	if ((list = root.find("textures")))
+		for (size_t i=0; i<list->size(); i++)
+			textureImages.push_back((*list)[i].intOr("source", -1));
+
+	if ((list = root.find("images"))){
+		for (size_t i=0; i<list->size(); i++){
+			GltfImage image;
+			image.bufferView = (*list)[i].intOr("bufferView", -1);
+			image.mimeType = (*list)[i].stringOr("mimeType", "");
+			if (image.bufferView >= (int)bufferViews.size()) valid = false;
+			images.push_back(image);
+		}
+	}
+
+	if ((list = root.find("materials"))){
+		for (size_t i=0; i<list->size(); i++){
+			const JsonValue & m = (*list)[i];
+			GltfMaterial material;
+			material.name = m.stringOr("name", "");
+			material.baseColorFactor = glm::vec4(1.0f);
+			material.metallicFactor = 1.0f;
+			material.roughnessFactor = 1.0f;
+			material.baseColorImage = -1;
+			if (const JsonValue * pbr = m.find("pbrMetallicRoughness")){
+				pbr->numbers("baseColorFactor", &material.baseColorFactor[0], 4);
+				material.metallicFactor = (float)pbr->numberOr("metallicFactor", 1.0);
+				material.roughnessFactor = (float)pbr->numberOr("roughnessFactor", 1.0);
+				if (const JsonValue * texture = pbr->find("baseColorTexture")){
+					int t = texture->intOr("index", -1);
+					if (t >= 0 && t < (int)textureImages.size()) material.baseColorImage = textureImages[t];
+				}
+			}
+			material.doubleSided = m.boolOr("doubleSided", false);
+			material.blend = m.stringOr("alphaMode", "OPAQUE") == "BLEND";
+			valid = valid && material.baseColorImage < (int)images.size();
+			materials.push_back(material);
+		}
+	}
+
+	if ((list = root.find("nodes"))){
+		for (size_t i=0; i<list->size(); i++){
+			const JsonValue & n = (*list)[i];
+			GltfNode node;
+			node.name = n.stringOr("name", "");
+			node.mesh = n.intOr("mesh", -1);
+			if (const JsonValue * children = n.find("children"))
+				for (size_t c=0; c<children->size(); c++)
+					node.children.push_back((int)(*children)[c].number);
+			float matrix[16];
+			if (n.numbers("matrix", matrix, 16) == 16){
+				node.local = glm::make_mat4(matrix); // column major, like glm
+			}else{
+				glm::vec3 translation(0.0f), scale(1.0f);
+				float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }; // x y z w
+				n.numbers("translation", &translation[0], 3);
+				n.numbers("scale", &scale[0], 3);
+				n.numbers("rotation", rotation, 4);
+				glm::quat q(rotation[3], rotation[0], rotation[1], rotation[2]);
+				node.local = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(q) * glm::scale(glm::mat4(1.0f), scale);
+			}
+			valid = valid && node.mesh < (int)meshes.size();
+			nodes.push_back(node);
+		}
+	}
+
+	// the nodes have to form a forest : a parent at most and no node its own ancestor, the
+	// recursions over the children would never end otherwise
+	std::vector<int> parent(nodes.size(), -1);
+	for (size_t i=0; i<nodes.size(); i++){
+		for (size_t c=0; c<nodes[i].children.size(); c++){
+			int child = nodes[i].children[c];
+			if (child < 0 || child >= (int)nodes.size())
+				valid = false;
+			else if (parent[child] != -1){
+				printf("%s : node %d has more than one parent\n", path, child);
+				valid = false;
+			}else
+				parent[child] = (int)i;
+		}
+	}
+	if (valid){
+		// with a parent at most, a cycle is what cannot be reached from the nodes without one
+		std::vector<int> stack;
+		for (size_t i=0; i<nodes.size(); i++)
+			if (parent[i] == -1) stack.push_back((int)i);
+		size_t reached = 0;
+		while (!stack.empty()){
+			int n = stack.back();
+			stack.pop_back();
+			reached++;
+			stack.insert(stack.end(), nodes[n].children.begin(), nodes[n].children.end());
+		}
+		if (reached != nodes.size()){
+			printf("%s : the nodes do not form a tree\n", path);
+			valid = false;
+		}
+	}
+
+	// the default scene, or every node without a parent when there is none
+	const JsonValue * scenes = root.find("scenes");
+	int scene = root.intOr("scene", 0);
+	if (scenes && scene >= 0 && scene < (int)scenes->size()){
+		if (const JsonValue * sceneNodes = (*scenes)[scene].find("nodes"))
+			for (size_t i=0; i<sceneNodes->size(); i++)
+				roots.push_back((int)(*sceneNodes)[i].number);
+	}else{
+		for (size_t i=0; i<nodes.size(); i++)
+			if (parent[i] == -1) roots.push_back((int)i);
+	}
+	for (size_t i=0; i<roots.size(); i++)
+		valid = valid && roots[i] >= 0 && roots[i] < (int)nodes.size() && parent[roots[i]] == -1;
+
+	if (!valid){
+		printf("%s : references outside the file or unsupported features\n", path);
+		close();
+		return false;
+	}
+	return true;
+}
+
+void GltfFile::close(){
+	file.close();
+	binary = NULL;
+	binarySize = 0;
+	bufferViews.clear();
+	accessors.clear();
+	meshes.clear();
+	materials.clear();
+	images.clear();
+	nodes.clear();
+	roots.clear();
+}
@@ -0,0 +1,108 @@
+#ifndef GLTFLOADER_HPP
+#define GLTFLOADER_HPP
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "mappedfile.hpp"
+
+// Binary glTF 2.0 (.glb) reader without dependencies.
+// The JSON chunk is parsed into the structures below, the BIN chunk stays in the memory
+// mapping : buffer views are byte ranges of it that can be handed to glBufferData as they are.
+// Only the embedded buffer is supported, external or data: URIs are rejected.
+
+// vertex attributes the loader knows, the values are the shader locations used by this project
+enum GltfAttribute {
+	GLTF_POSITION = 0,
+	GLTF_COLOR_0 = 1,
+	GLTF_TEXCOORD_0 = 2,
+	GLTF_NORMAL = 3,
+	GLTF_TANGENT = 4,
+	GLTF_ATTRIBUTE_COUNT = 5
+};
+
+struct GltfBufferView {
+	size_t offset;        // into the BIN chunk
+	size_t length;
+	unsigned int stride;  // 0 when tightly packed
+	unsigned int target;  // GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER or 0 when not given
+};
+
+struct GltfAccessor {
+	int bufferView;            // -1 for accessors without data (all zeros)
+	size_t offset;             // inside the buffer view
+	unsigned int componentType; // GL enum : GL_BYTE ... GL_FLOAT
+	unsigned int components;   // 1 (SCALAR) to 4 (VEC4), 16 for MAT4
+	size_t count;
+	bool normalized;
+	bool hasBounds;            // min / max given, mandatory for POSITION
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct GltfPrimitive {
+	int attributes[GLTF_ATTRIBUTE_COUNT]; // accessor per GltfAttribute, -1 when absent
+	int indices;                          // accessor, -1 for non indexed
+	int material;                         // -1 for the default material
+	unsigned int mode;                    // GL primitive type, GL_TRIANGLES by default
+};
+
+struct GltfMesh {
+	std::string name;
+	std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfMaterial {
+	std::string name;
+	glm::vec4 baseColorFactor;
+	float metallicFactor;
+	float roughnessFactor;
+	int baseColorImage;  // image index through the texture, -1 when untextured
+	bool doubleSided;
+	bool blend;          // alphaMode BLEND
+};
+
+struct GltfImage {
+	int bufferView;      // encoded PNG / JPEG bytes
+	std::string mimeType;
+};
+
+struct GltfNode {
+	std::string name;
+	int mesh;            // -1 for pure transform nodes
+	std::vector<int> children;
+	glm::mat4 local;     // matrix, or translation * rotation * scale
+};
+
+class GltfFile {
+public:
+	std::vector<GltfBufferView> bufferViews;
+	std::vector<GltfAccessor> accessors;
+	std::vector<GltfMesh> meshes;
+	std::vector<GltfMaterial> materials;
+	std::vector<GltfImage> images;
+	std::vector<GltfNode> nodes;
+	std::vector<int> roots; // nodes of the default scene
+
+	GltfFile() : binary(NULL), binarySize(0) {}
+
+	bool open(const char * path);
+	void close();
+
+	// bytes of a buffer view inside the mapping, valid until close()
+	const unsigned char * data(const GltfBufferView & view) const { return binary + view.offset; }
+	const unsigned char * data(int bufferView) const { return binary + bufferViews[bufferView].offset; }
+
+private:
+	MappedFile file;
+	const unsigned char * binary;
+	size_t binarySize;
+};
+
+// bytes of one accessor element
+size_t gltfElementSize(const GltfAccessor & accessor);
+
+#endif
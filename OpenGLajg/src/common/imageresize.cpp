@@ -0,0 +1,124 @@
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include <stb_image_resize.h>
+
+#include "imageresize.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+const char * FILTER_NAMES[] = { "box", "triangle", "mitchell", "catmullrom" };
+const stbir_filter FILTERS[] = { STBIR_FILTER_BOX, STBIR_FILTER_TRIANGLE, STBIR_FILTER_MITCHELL, STBIR_FILTER_CATMULLROM };
+
+// output rows a thread takes at a time
+const unsigned int BAND_ROWS = 32;
+
+// rows [y, y + rows) of the level below source. the band is the matching stretch of the source
+// (stbir_resize_region), the filter still reads the rows around it, so bands meet without seams
+void resizeBand(const unsigned char * source, unsigned int width, unsigned int height, unsigned char * target, unsigned int target_width,
+	unsigned int target_height, unsigned int y, unsigned int rows, const MipChainOptions & options){
+	stbir_filter filter = FILTERS[options.filter];
+	stbir_resize_region(source, width, height, 0, target + (size_t)y * target_width * 4, target_width, rows, 0, STBIR_TYPE_UINT8, 4, 3, 0,
+		STBIR_EDGE_CLAMP, STBIR_EDGE_CLAMP, filter, filter, options.srgb ? STBIR_COLORSPACE_SRGB : STBIR_COLORSPACE_LINEAR, NULL,
+		0.0f, (float)y / target_height, 1.0f, (float)(y + rows) / target_height);
+}
+
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start){
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+} // namespace
+
+bool resizeImage(const unsigned char * pixels, unsigned int width, unsigned int height, unsigned int channels,
+	unsigned char * out, unsigned int out_width, unsigned int out_height, bool srgb){
+	PROFILE_SCOPE("resize image");
+	int alpha = channels == 4 ? 3 : STBIR_ALPHA_CHANNEL_NONE;
+	if (srgb)
+		return stbir_resize_uint8_srgb(pixels, width, height, 0, out, out_width, out_height, 0, channels, alpha, 0) != 0;
+	return stbir_resize_uint8_generic(pixels, width, height, 0, out, out_width, out_height, 0, channels, alpha, 0,
+		STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT, STBIR_COLORSPACE_LINEAR, NULL) != 0;
+}
+
+MipChainOptions::MipChainOptions()
+	: filter(MIP_FILTER_MITCHELL), srgb(true), threads(0)
+{
+}
+
+void generateMipChain(const unsigned char * rgba, unsigned int width, unsigned int height, const MipChainOptions & options,
+	TextureImage & out, MipChainStats * stats){
+	PROFILE_SCOPE("generate mip chain");
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	out.format = TEXTURE_RGBA8;
+	out.width = width;
+	out.height = height;
+	out.levels.clear();
+	out.data.clear();
+	// every level is allocated first, the bands write into place
+	for (unsigned int w = width, h = height;; w = std::max(1u, w / 2), h = std::max(1u, h / 2)){
+		addTextureLevel(out, w, h);
+		if (w == 1 && h == 1)
+			break;
+	}
+	memcpy(&out.data[0], rgba, out.levels[0].size);
+
+	unsigned int threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+	if (stats){
+		stats->levels = (unsigned int)out.levels.size();
+		stats->threads = threads;
+		stats->levelMilliseconds.clear();
+	}
+	for (size_t i=1; i<out.levels.size(); i++){
+		std::chrono::high_resolution_clock::time_point levelStart = std::chrono::high_resolution_clock::now();
+		const TextureLevel & source = out.levels[i - 1];
+		const TextureLevel & target = out.levels[i];
+		const unsigned char * sourcePixels = &out.data[source.offset];
+		unsigned char * targetPixels = &out.data[target.offset];
+		unsigned int bands = (target.height + BAND_ROWS - 1) / BAND_ROWS;
+		std::atomic<unsigned int> next(0);
+		auto work = [&](){
+			for (unsigned int band = next++; band < bands; band = next++){
+				unsigned int y = band * BAND_ROWS;
+				resizeBand(sourcePixels, source.width, source.height, targetPixels, target.width, target.height, y,
+					std::min(BAND_ROWS, target.height - y), options);
+			}
+		};
+		// the small levels are not worth a thread
+		std::vector<std::thread> workers;
+		for (unsigned int t=1; t<std::min(threads, bands); t++)
+			workers.push_back(std::thread(work));
+		work();
+		for (size_t t=0; t<workers.size(); t++)
+			workers[t].join();
+		if (stats)
+			stats->levelMilliseconds.push_back(millisecondsSince(levelStart));
+	}
+	if (stats)
+		stats->milliseconds = millisecondsSince(start);
+}
+
+MipFilter parseMipFilter(const char * name, MipFilter fallback){
+	for (int i=0; i<4; i++)
+		if (strcmp(name, FILTER_NAMES[i]) == 0)
+			return (MipFilter)i;
+	return fallback;
+}
+
+const char * mipFilterName(MipFilter filter){
+	return FILTER_NAMES[filter];
+}
+
+std::string mipCachePath(const char * source_path, const MipChainOptions & options){
+	std::string path(source_path);
+	size_t slash = path.find_last_of("/\\");
+	size_t dot = path.find_last_of('.');
+	if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+		path.erase(dot);
+	return path + "." + mipFilterName(options.filter) + (options.srgb ? ".srgb" : ".linear") + ".mips.dds";
+}
@@ -0,0 +1,52 @@
+#ifndef IMAGERESIZE_HPP
+#define IMAGERESIZE_HPP
+
+#include <vector>
+
+#include "texturefile.hpp"
+
+// Image resampling with the bundled stb_image_resize, which keeps its implementation here.
+// 8 bit images, any channel count, rows tightly packed.
+
+// srgb filters colour in linear light, the fourth channel of 4 channel images is taken as
+// straight alpha and the colour weighted by it
+bool resizeImage(const unsigned char * pixels, unsigned int width, unsigned int height, unsigned int channels,
+	unsigned char * out, unsigned int out_width, unsigned int out_height, bool srgb);
+
+// the downsampling filters of stb_image_resize 0.96, which has no Kaiser window : Mitchell is
+// the sharpest one that does not ring, Catmull-Rom is sharper still and rings a little
+enum MipFilter {
+	MIP_FILTER_BOX,
+	MIP_FILTER_TRIANGLE,
+	MIP_FILTER_MITCHELL,
+	MIP_FILTER_CATMULLROM
+};
+
+struct MipChainOptions {
+	MipFilter filter;
+	bool srgb;             // colour in linear light, false for data (normals, masks)
+	unsigned int threads;  // 0 for one per core
+	MipChainOptions();
+};
+
+struct MipChainStats {
+	unsigned int levels;
+	unsigned int threads;
+	double milliseconds;
+	std::vector<double> levelMilliseconds; // from level 1 on
+};
+
+// RGBA8 image with level 0 copied from rgba and every further level resampled from the one above
+// it, down to 1x1. each level is cut into bands of rows that the threads filter side by side, the
+// result does not depend on the number of threads
+void generateMipChain(const unsigned char * rgba, unsigned int width, unsigned int height, const MipChainOptions & options,
+	TextureImage & out, MipChainStats * stats = NULL);
+
+MipFilter parseMipFilter(const char * name, MipFilter fallback);
+const char * mipFilterName(MipFilter filter);
+
+// where generated chains of source images are kept : the source path ending in
+// .<filter>.<srgb|linear>.mips.dds, so a chain made with other options is never picked up
+std::string mipCachePath(const char * source_path, const MipChainOptions & options);
+
+#endif
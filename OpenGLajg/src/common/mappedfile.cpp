@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <limits.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <sys/stat.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "mappedfile.hpp"
+
+MappedFile::MappedFile() : bytes(NULL), length(0)
+#ifdef _WIN32
+	, file(INVALID_HANDLE_VALUE), mapping(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile(){
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char * path){
+	close();
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE){
+		printf("%s could not be opened. Are you in the right directory ?\n", path);
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size)){
+		close();
+		return false;
+	}
+	length = (size_t)file_size.QuadPart;
+	if (length == 0)
+		return true; // empty files cannot be mapped, but are valid
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL){
+		printf("%s could not be mapped\n", path);
+		close();
+		return false;
+	}
+	bytes = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (bytes == NULL){
+		printf("%s could not be mapped\n", path);
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close(){
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mapping) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+	bytes = NULL;
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+	length = 0;
+}
+
+#else
+
+bool MappedFile::open(const char * path){
+	close();
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0){
+		printf("%s could not be opened. Are you in the right directory ?\n", path);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0){
+		::close(fd);
+		return false;
+	}
+	length = (size_t)st.st_size;
+	if (length == 0){
+		::close(fd);
+		return true;
+	}
+	void * p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps its own reference
+	if (p == MAP_FAILED){
+		printf("%s could not be mapped\n", path);
+		length = 0;
+		return false;
+	}
+	madvise(p, length, MADV_SEQUENTIAL);
+	bytes = (const unsigned char *)p;
+	return true;
+}
+
+void MappedFile::close(){
+	if (bytes) munmap((void *)bytes, length);
+	bytes = NULL;
+	length = 0;
+}
+
+#endif
+
+bool cacheUpToDate(const char * source_path, const char * cache_path){
+#ifdef _WIN32
+	struct _stat64 source, cache;
+	if (_stat64(cache_path, &cache) != 0)
+		return false;
+	return _stat64(source_path, &source) != 0 || cache.st_mtime >= source.st_mtime;
+#else
+	struct stat source, cache;
+	if (stat(cache_path, &cache) != 0)
+		return false;
+	return stat(source_path, &source) != 0 || cache.st_mtime >= source.st_mtime;
+#endif
+}
+
+std::string canonicalPath(const char * path){
+#ifdef _WIN32
+	char full[_MAX_PATH];
+	if (_fullpath(full, path, _MAX_PATH) == NULL)
+		return path;
+	std::string result(full);
+	for (size_t i=0; i<result.size(); i++)
+		result[i] = result[i] == '\\' ? '/' : (char)tolower((unsigned char)result[i]);
+	return result;
+#else
+	char full[PATH_MAX];
+	if (realpath(path, full) == NULL)
+		return path;
+	return full;
+#endif
+}
@@ -0,0 +1,40 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap on POSIX, a file mapping on Windows).
+// The contents stay valid until close() or destruction.
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const char * path);
+	void close();
+
+	const unsigned char * data() const { return bytes; }
+	size_t size() const { return length; }
+
+private:
+	MappedFile(const MappedFile &);
+	MappedFile & operator=(const MappedFile &);
+
+	const unsigned char * bytes;
+	size_t length;
+#ifdef _WIN32
+	void * file;
+	void * mapping;
+#endif
+};
+
+// true when cache_path exists and is at least as new as source_path (or the source is gone),
+// the modification time check behind the cooked files the runtime prefers over their sources
+bool cacheUpToDate(const char * source_path, const char * cache_path);
+
+// absolute path with . and .. resolved (and links on POSIX; lower case with / separators on
+// Windows), so two spellings of one file compare equal. the path as given when it does not exist
+std::string canonicalPath(const char * path);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Vertex layout of the car shaders (vertex.vs) : 11 floats, matching the attribute
+// locations 0 position, 1 color, 2 texture coordinate, 3 normal
+struct Vertex {
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec2 uv;
+	glm::vec3 normal;
+};
+
+// Indexed triangle list
+struct MeshData {
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+};
+
+#endif
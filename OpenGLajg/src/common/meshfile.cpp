@@ -0,0 +1,443 @@
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "meshfile.hpp"
+#include "meshoptimize.hpp"
+#include "profiler.hpp"
+
+static_assert(sizeof(MeshLod) == 16, "the LOD table is written as MeshLod structs");
+static_assert(sizeof(MeshFileHeader) == 256, "the header layout is part of the file format");
+
+namespace {
+
+unsigned long long alignUp(unsigned long long offset){
+	return (offset + MESH_FILE_ALIGNMENT - 1) & ~(unsigned long long)(MESH_FILE_ALIGNMENT - 1);
+}
+
+bool validLayout(const MeshLayout & layout){
+	if (layout.attributeCount == 0 || layout.attributeCount > MESH_MAX_ATTRIBUTES || layout.stride == 0)
+		return false;
+	for (unsigned int i=0; i<layout.attributeCount; i++){
+		const MeshAttribute & a = layout.attributes[i];
+		unsigned int size = meshAttributeSize(a);
+		if (size == 0 || a.offset + size > layout.stride)
+			return false;
+	}
+	return true;
+}
+
+// every index of a range, moved by baseVertex, has to name one of the vertices
+bool indicesInRange(const unsigned char * indices, unsigned int indexSize, unsigned int first, unsigned int count, int baseVertex, unsigned int vertexCount){
+	for (unsigned int i=first; i<first + count; i++){
+		unsigned int index = indexSize == 2 ? ((const unsigned short *)indices)[i] : ((const unsigned int *)indices)[i];
+		long long vertex = (long long)index + baseVertex;
+		if (vertex < 0 || vertex >= vertexCount)
+			return false;
+	}
+	return true;
+}
+
+// round to nearest even, overflow goes to infinity and small values to half denormals
+unsigned short floatToHalf(float value){
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int magnitude = bits & 0x7fffffff;
+	if (magnitude >= 0x7f800000) // infinity or NaN
+		return (unsigned short)(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+	if (magnitude >= 0x477ff000) // 65520 and up round past the largest half
+		return (unsigned short)(sign | 0x7c00);
+	if (magnitude < 0x38800000){ // below 2^-14, denormal half
+		if (magnitude < 0x33000000)
+			return (unsigned short)sign;
+		unsigned int mantissa = (magnitude & 0x7fffff) | 0x800000;
+		unsigned int shift = 126 - (magnitude >> 23);
+		unsigned int half = mantissa >> shift;
+		unsigned int rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+		if (rest > halfway || (rest == halfway && (half & 1)))
+			half++;
+		return (unsigned short)(sign | half);
+	}
+	// rebias the exponent from 127 to 15, a rounding carry moves into the exponent on its own
+	unsigned int half = (magnitude - 0x38000000) >> 13;
+	unsigned int rest = magnitude & 0x1fff;
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+		half++;
+	return (unsigned short)(sign | half);
+}
+
+unsigned int packSigned10(float value){
+	value = std::min(std::max(value, -1.0f), 1.0f);
+	return (unsigned int)(int)std::floor(value * 511.0f + 0.5f) & 0x3ff;
+}
+
+unsigned int packUnsigned(float value, float scale){
+	value = std::min(std::max(value, 0.0f), 1.0f);
+	return (unsigned int)(value * scale + 0.5f);
+}
+
+// post-transform cache statistics of the finest level
+VertexCacheStats cacheStats(const MeshView & mesh){
+	unsigned int count = mesh.lods ? mesh.lods[0].indexCount : mesh.indexCount;
+	std::vector<unsigned int> indices(count);
+	for (unsigned int i=0; i<count; i++)
+		indices[i] = mesh.indexSize == 2 ? ((const unsigned short *)mesh.indices)[i] : ((const unsigned int *)mesh.indices)[i];
+	return analyzeVertexCache(indices.empty() ? NULL : &indices[0], count, mesh.vertexCount);
+}
+
+}
+
+MeshAttribute meshAttribute(unsigned int location, unsigned int components, unsigned int type, unsigned int offset, bool normalized){
+	MeshAttribute a;
+	a.location = location;
+	a.components = components;
+	a.type = type;
+	a.normalized = normalized ? 1 : 0;
+	a.offset = offset;
+	return a;
+}
+
+unsigned int meshAttributeSize(const MeshAttribute & attribute){
+	if (attribute.components < 1 || attribute.components > 4)
+		return 0;
+	switch (attribute.type){
+	case MESH_BYTE:
+	case MESH_UNSIGNED_BYTE:      return attribute.components;
+	case MESH_SHORT:
+	case MESH_UNSIGNED_SHORT:
+	case MESH_HALF_FLOAT:         return attribute.components * 2;
+	case MESH_FLOAT:              return attribute.components * 4;
+	case MESH_INT_2_10_10_10_REV: return attribute.components == 4 ? 4 : 0;
+	default:                      return 0;
+	}
+}
+
+void computeMeshBounds(MeshView & mesh){
+	for (int k=0; k<3; k++){
+		mesh.boundsMin[k] = mesh.vertexCount ? FLT_MAX : 0.0f;
+		mesh.boundsMax[k] = mesh.vertexCount ? -FLT_MAX : 0.0f;
+	}
+	const MeshAttribute & position = mesh.layout.attributes[0];
+	if (position.type != MESH_FLOAT || position.components < 3)
+		return;
+	const unsigned char * vertex = (const unsigned char *)mesh.vertices + position.offset;
+	for (unsigned int i=0; i<mesh.vertexCount; i++, vertex += mesh.layout.stride){
+		float p[3];
+		memcpy(p, vertex, sizeof(p));
+		for (int k=0; k<3; k++){
+			if (p[k] < mesh.boundsMin[k]) mesh.boundsMin[k] = p[k];
+			if (p[k] > mesh.boundsMax[k]) mesh.boundsMax[k] = p[k];
+		}
+	}
+}
+
+void buildMeshLods(MeshView & mesh, std::vector<unsigned int> & chain, std::vector<MeshLod> & lods, size_t min_triangles){
+	PROFILE_SCOPE("build mesh LODs");
+	std::vector<unsigned int> source(mesh.indexCount);
+	for (unsigned int i=0; i<mesh.indexCount; i++)
+		source[i] = mesh.indexSize == 2 ? ((const unsigned short *)mesh.indices)[i] : ((const unsigned int *)mesh.indices)[i];
+	const float * positions = (const float *)((const unsigned char *)mesh.vertices + mesh.layout.attributes[0].offset);
+	buildLodChain(positions, mesh.vertexCount, mesh.layout.stride / sizeof(float), source, chain, lods, 0.5f, min_triangles);
+	mesh.indices = chain.empty() ? NULL : &chain[0];
+	mesh.indexCount = (unsigned int)chain.size();
+	mesh.indexSize = sizeof(unsigned int);
+	mesh.lods = lods.empty() ? NULL : &lods[0];
+	mesh.lodCount = (unsigned int)lods.size();
+}
+
+void optimizeMeshView(MeshView & mesh, std::vector<unsigned char> & vertices, std::vector<unsigned int> & indices){
+	PROFILE_SCOPE("optimize mesh");
+	if (mesh.indexCount == 0 || !mesh.indices)
+		return;
+	std::vector<unsigned int> source(mesh.indexCount);
+	for (unsigned int i=0; i<mesh.indexCount; i++)
+		source[i] = mesh.indexSize == 2 ? ((const unsigned short *)mesh.indices)[i] : ((const unsigned int *)mesh.indices)[i];
+
+	// levels are drawn on their own, so each range is ordered on its own
+	const float * positions = (const float *)((const unsigned char *)mesh.vertices + mesh.layout.attributes[0].offset);
+	MeshLod all = { 0, mesh.indexCount, 0, 0.0f };
+	const MeshLod * lods = mesh.lods ? mesh.lods : &all;
+	unsigned int lodCount = mesh.lods ? mesh.lodCount : 1;
+	std::vector<unsigned int> level;
+	for (unsigned int l=0; l<lodCount; l++){
+		optimizeOverdraw(&source[lods[l].indexOffset], lods[l].indexCount, positions, mesh.vertexCount, mesh.layout.stride / sizeof(float), level);
+		std::copy(level.begin(), level.end(), source.begin() + lods[l].indexOffset);
+	}
+
+	// the finest level comes first in the index buffer, so it decides the vertex order
+	size_t vertexCount = optimizeVertexFetch(&source[0], source.size(), mesh.vertices, mesh.vertexCount, mesh.layout.stride, vertices);
+	indices.swap(source);
+	mesh.vertices = vertices.empty() ? NULL : &vertices[0];
+	mesh.vertexCount = (unsigned int)vertexCount;
+	mesh.indices = &indices[0];
+	mesh.indexSize = sizeof(unsigned int);
+}
+
+void quantizeMeshView(MeshView & mesh, std::vector<unsigned char> & vertices){
+	MeshLayout layout;
+	memset(&layout, 0, sizeof(layout));
+	layout.attributeCount = mesh.layout.attributeCount;
+	for (unsigned int i=0; i<mesh.layout.attributeCount; i++){
+		const MeshAttribute & a = mesh.layout.attributes[i];
+		MeshAttribute packed = a;
+		if (a.type == MESH_FLOAT){
+			if (i == 0 && a.location == 0 && a.components == 3)
+				packed = meshAttribute(a.location, 4, MESH_UNSIGNED_SHORT, 0, true);
+			else if (a.location == 1 && a.components >= 3)
+				packed = meshAttribute(a.location, 4, MESH_UNSIGNED_BYTE, 0, true);
+			else if (a.location == 2 && a.components == 2)
+				packed = meshAttribute(a.location, 2, MESH_HALF_FLOAT, 0);
+			else if (a.location == 3 && a.components == 3)
+				packed = meshAttribute(a.location, 4, MESH_INT_2_10_10_10_REV, 0, true);
+		}
+		// every attribute stays 4 byte aligned
+		packed.offset = layout.stride;
+		layout.stride += (meshAttributeSize(packed) + 3) & ~3u;
+		layout.attributes[i] = packed;
+	}
+
+	float extent[3];
+	for (int k=0; k<3; k++)
+		extent[k] = mesh.boundsMax[k] > mesh.boundsMin[k] ? mesh.boundsMax[k] - mesh.boundsMin[k] : 0.0f;
+
+	vertices.assign((size_t)mesh.vertexCount * layout.stride, 0);
+	for (unsigned int v=0; v<mesh.vertexCount; v++){
+		const unsigned char * source = (const unsigned char *)mesh.vertices + (size_t)v * mesh.layout.stride;
+		unsigned char * target = &vertices[(size_t)v * layout.stride];
+		for (unsigned int i=0; i<layout.attributeCount; i++){
+			const MeshAttribute & from = mesh.layout.attributes[i];
+			const MeshAttribute & to = layout.attributes[i];
+			const unsigned char * in = source + from.offset;
+			unsigned char * out = target + to.offset;
+			if (from.type == to.type){
+				memcpy(out, in, meshAttributeSize(from));
+				continue;
+			}
+			float f[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+			memcpy(f, in, from.components * sizeof(float));
+			if (to.type == MESH_UNSIGNED_SHORT){
+				unsigned short q[4] = { 0, 0, 0, 0 };
+				for (int k=0; k<3; k++)
+					q[k] = extent[k] > 0.0f ? (unsigned short)packUnsigned((f[k] - mesh.boundsMin[k]) / extent[k], 65535.0f) : 0;
+				memcpy(out, q, sizeof(q));
+			} else if (to.type == MESH_UNSIGNED_BYTE){
+				for (int k=0; k<4; k++)
+					out[k] = (unsigned char)packUnsigned(f[k], 255.0f);
+			} else if (to.type == MESH_HALF_FLOAT){
+				unsigned short h[2] = { floatToHalf(f[0]), floatToHalf(f[1]) };
+				memcpy(out, h, sizeof(h));
+			} else {
+				float length = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+				float scale = length > 0.0f ? 1.0f / length : 0.0f;
+				unsigned int packed = packSigned10(f[0] * scale) | packSigned10(f[1] * scale) << 10 | packSigned10(f[2] * scale) << 20;
+				memcpy(out, &packed, sizeof(packed));
+			}
+		}
+	}
+	mesh.layout = layout;
+	mesh.vertices = vertices.empty() ? NULL : &vertices[0];
+}
+
+bool meshPositionsQuantized(const MeshLayout & layout){
+	return layout.attributeCount > 0 && layout.attributes[0].type == MESH_UNSIGNED_SHORT && layout.attributes[0].normalized;
+}
+
+void narrowMeshIndices(MeshView & mesh, std::vector<unsigned short> & storage){
+	if (mesh.indexSize != 4 || mesh.indexCount == 0 || mesh.vertexCount > 0x10000)
+		return;
+	for (unsigned int i=0; i<mesh.lodCount; i++)
+		if (mesh.lods[i].baseVertex != 0)
+			return;
+	const unsigned int * wide = (const unsigned int *)mesh.indices;
+	storage.assign(wide, wide + mesh.indexCount);
+	mesh.indices = &storage[0];
+	mesh.indexSize = 2;
+}
+
+void decodeMeshPositions(const MeshView & mesh, std::vector<float> & positions){
+	positions.resize((size_t)mesh.vertexCount * 3);
+	const MeshAttribute & position = mesh.layout.attributes[0];
+	bool quantized = meshPositionsQuantized(mesh.layout);
+	const unsigned char * vertex = (const unsigned char *)mesh.vertices + position.offset;
+	for (unsigned int i=0; i<mesh.vertexCount; i++, vertex += mesh.layout.stride){
+		float * p = &positions[(size_t)i * 3];
+		if (quantized){
+			unsigned short q[3];
+			memcpy(q, vertex, sizeof(q));
+			for (int k=0; k<3; k++)
+				p[k] = mesh.boundsMin[k] + (mesh.boundsMax[k] - mesh.boundsMin[k]) * (q[k] / 65535.0f);
+		} else {
+			memcpy(p, vertex, 3 * sizeof(float));
+		}
+	}
+}
+
+MeshView meshDataView(const MeshData & data){
+	MeshView mesh = MeshView();
+	mesh.layout.stride = sizeof(Vertex);
+	mesh.layout.attributeCount = 4;
+	mesh.layout.attributes[0] = meshAttribute(0, 3, MESH_FLOAT, offsetof(Vertex, position));
+	mesh.layout.attributes[1] = meshAttribute(1, 3, MESH_FLOAT, offsetof(Vertex, color));
+	mesh.layout.attributes[2] = meshAttribute(2, 2, MESH_FLOAT, offsetof(Vertex, uv));
+	mesh.layout.attributes[3] = meshAttribute(3, 3, MESH_FLOAT, offsetof(Vertex, normal));
+	mesh.vertices = data.vertices.empty() ? NULL : &data.vertices[0];
+	mesh.vertexCount = (unsigned int)data.vertices.size();
+	mesh.indices = data.indices.empty() ? NULL : &data.indices[0];
+	mesh.indexCount = (unsigned int)data.indices.size();
+	mesh.indexSize = sizeof(unsigned int);
+	computeMeshBounds(mesh);
+	return mesh;
+}
+
+bool cookMeshFile(const char * path, MeshView mesh, bool lods, bool quantize, MeshCookStats * stats){
+	PROFILE_SCOPE("cook mesh file");
+	std::vector<unsigned int> chain, optimizedIndices;
+	std::vector<MeshLod> levels;
+	std::vector<unsigned char> optimizedVertices, quantizedVertices;
+	std::vector<unsigned short> narrow;
+	MeshCookStats cooked;
+	memset(&cooked, 0, sizeof(cooked));
+	cooked.strideBefore = mesh.layout.stride;
+	if (lods && mesh.indexCount)
+		buildMeshLods(mesh, chain, levels, 8);
+	if (mesh.indexCount){
+		cooked.before = cacheStats(mesh);
+		optimizeMeshView(mesh, optimizedVertices, optimizedIndices);
+		cooked.after = cacheStats(mesh);
+	}
+	if (quantize)
+		quantizeMeshView(mesh, quantizedVertices);
+	cooked.strideAfter = mesh.layout.stride;
+	narrowMeshIndices(mesh, narrow);
+	cooked.vertexCount = mesh.vertexCount;
+	cooked.indexCount = mesh.indexCount;
+	cooked.indexSize = mesh.indexSize;
+	cooked.lodCount = mesh.lodCount;
+	if (stats)
+		*stats = cooked;
+	return writeMeshFile(path, mesh);
+}
+
+bool writeMeshFile(const char * path, const MeshView & mesh){
+	if (!validLayout(mesh.layout) || (mesh.indexCount && mesh.indexSize != 2 && mesh.indexSize != 4)){
+		printf("%s : invalid mesh layout\n", path);
+		return false;
+	}
+
+	MeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "MESH", 4);
+	header.version = MESH_FILE_VERSION;
+	header.headerSize = sizeof(MeshFileHeader);
+	header.vertexCount = mesh.vertexCount;
+	header.indexCount = mesh.indexCount;
+	header.indexSize = mesh.indexCount ? mesh.indexSize : 0;
+	header.lodCount = mesh.lods ? mesh.lodCount : 0;
+	memcpy(header.boundsMin, mesh.boundsMin, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, mesh.boundsMax, sizeof(header.boundsMax));
+	header.layout = mesh.layout;
+	unsigned long long vertexBytes = (unsigned long long)mesh.vertexCount * mesh.layout.stride;
+	unsigned long long indexBytes = (unsigned long long)header.indexCount * header.indexSize;
+	unsigned long long lodBytes = (unsigned long long)header.lodCount * sizeof(MeshLod);
+	header.vertexOffset = alignUp(sizeof(MeshFileHeader));
+	header.indexOffset = alignUp(header.vertexOffset + vertexBytes);
+	header.lodOffset = alignUp(header.indexOffset + indexBytes);
+	header.fileSize = header.lodOffset + lodBytes;
+
+	FILE * file = fopen(path, "wb");
+	if (file == NULL){
+		printf("%s could not be opened for writing\n", path);
+		return false;
+	}
+	static const char padding[MESH_FILE_ALIGNMENT] = {};
+	unsigned long long written = 0;
+	bool ok = true;
+	// each blob is padded up to its offset before being written
+	const void * blobs[4] = { &header, mesh.vertices, mesh.indices, mesh.lods };
+	const unsigned long long offsets[4] = { 0, header.vertexOffset, header.indexOffset, header.lodOffset };
+	const unsigned long long sizes[4] = { sizeof(header), vertexBytes, indexBytes, lodBytes };
+	for (int i=0; i<4 && ok; i++){
+		if (sizes[i] == 0) continue;
+		ok = fwrite(padding, 1, (size_t)(offsets[i] - written), file) == offsets[i] - written
+		  && fwrite(blobs[i], 1, (size_t)sizes[i], file) == sizes[i];
+		written = offsets[i] + sizes[i];
+	}
+	// empty trailing blobs still own their aligned offset, the file always ends at fileSize
+	if (ok && written < header.fileSize)
+		ok = fwrite(padding, 1, (size_t)(header.fileSize - written), file) == header.fileSize - written;
+	ok = fclose(file) == 0 && ok;
+	if (!ok)
+		printf("%s : write failed\n", path);
+	return ok;
+}
+
+bool MeshFile::open(const char * path){
+	PROFILE_SCOPE("open mesh file");
+	close();
+	if (!file.open(path))
+		return false;
+
+	const unsigned char * data = file.data();
+	size_t size = file.size();
+	MeshFileHeader header;
+	if (size < sizeof(header)){
+		printf("%s is not a mesh file\n", path);
+		close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, "MESH", 4) != 0 || header.version != MESH_FILE_VERSION || header.headerSize < sizeof(header)){
+		printf("%s is not a version %u mesh file\n", path, MESH_FILE_VERSION);
+		close();
+		return false;
+	}
+
+	unsigned long long vertexBytes = (unsigned long long)header.vertexCount * header.layout.stride;
+	unsigned long long indexBytes = (unsigned long long)header.indexCount * header.indexSize;
+	unsigned long long lodBytes = (unsigned long long)header.lodCount * sizeof(MeshLod);
+	bool valid = validLayout(header.layout)
+		&& (header.indexCount == 0 || header.indexSize == 2 || header.indexSize == 4)
+		&& header.fileSize <= size
+		&& header.vertexOffset % MESH_FILE_ALIGNMENT == 0 && header.indexOffset % MESH_FILE_ALIGNMENT == 0 && header.lodOffset % MESH_FILE_ALIGNMENT == 0
+		// offsets come from the file, offset + bytes could wrap
+		&& header.vertexOffset <= size && vertexBytes <= size - header.vertexOffset
+		&& header.indexOffset <= size && indexBytes <= size - header.indexOffset
+		&& header.lodOffset <= size && lodBytes <= size - header.lodOffset;
+	// every level has to stay inside the index buffer and its indices inside the vertex buffer,
+	// without levels the whole index buffer is drawn
+	for (unsigned int i=0; valid && i<header.lodCount; i++){
+		MeshLod lod;
+		memcpy(&lod, data + header.lodOffset + i * sizeof(MeshLod), sizeof(lod));
+		valid = (unsigned long long)lod.indexOffset + lod.indexCount <= header.indexCount
+			&& indicesInRange(data + header.indexOffset, header.indexSize, lod.indexOffset, lod.indexCount, lod.baseVertex, header.vertexCount);
+	}
+	if (valid && header.lodCount == 0)
+		valid = indicesInRange(data + header.indexOffset, header.indexSize, 0, header.indexCount, 0, header.vertexCount);
+	if (!valid){
+		printf("%s is truncated or corrupt\n", path);
+		close();
+		return false;
+	}
+
+	mesh.layout = header.layout;
+	mesh.vertices = data + header.vertexOffset;
+	mesh.vertexCount = header.vertexCount;
+	mesh.indices = header.indexCount ? data + header.indexOffset : NULL;
+	mesh.indexCount = header.indexCount;
+	mesh.indexSize = header.indexSize;
+	mesh.lods = header.lodCount ? (const MeshLod *)(data + header.lodOffset) : NULL;
+	mesh.lodCount = header.lodCount;
+	memcpy(mesh.boundsMin, header.boundsMin, sizeof(mesh.boundsMin));
+	memcpy(mesh.boundsMax, header.boundsMax, sizeof(mesh.boundsMax));
+	return true;
+}
+
+void MeshFile::close(){
+	file.close();
+	memset(&mesh, 0, sizeof(mesh));
+}
@@ -0,0 +1,151 @@
+#ifndef MESHFILE_HPP
+#define MESHFILE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "meshsimplify.hpp"
+#include "meshoptimize.hpp"
+#include "mappedfile.hpp"
+#include "mesh.hpp"
+
+// Binary mesh container (.mesh), little endian :
+//   MeshFileHeader | vertex blob | index blob | LOD table
+// every blob starts on a MESH_FILE_ALIGNMENT boundary, so the vertex and index data can be
+// handed to glBufferData straight from the memory mapping.
+
+const unsigned int MESH_FILE_VERSION = 1;
+const unsigned int MESH_FILE_ALIGNMENT = 64;
+const unsigned int MESH_MAX_ATTRIBUTES = 8;
+
+// attribute types use the OpenGL enum values, so they go to glVertexAttribPointer as they are
+enum MeshAttributeType {
+	MESH_BYTE = 0x1400,
+	MESH_UNSIGNED_BYTE = 0x1401,
+	MESH_SHORT = 0x1402,
+	MESH_UNSIGNED_SHORT = 0x1403,
+	MESH_FLOAT = 0x1406,
+	MESH_HALF_FLOAT = 0x140B,
+	MESH_INT_2_10_10_10_REV = 0x8D9F
+};
+
+struct MeshAttribute {
+	unsigned int location;   // shader attribute location
+	unsigned int components; // 1 to 4
+	unsigned int type;       // MeshAttributeType
+	unsigned int normalized; // 0 or 1, for integer types
+	unsigned int offset;     // bytes from the start of the vertex
+};
+
+// interleaved vertex layout
+struct MeshLayout {
+	unsigned int stride;
+	unsigned int attributeCount;
+	MeshAttribute attributes[MESH_MAX_ATTRIBUTES];
+};
+
+// what a mesh file holds, pointing either into a mapped file or into memory that is about to be written
+struct MeshView {
+	MeshLayout layout;
+	const void * vertices;
+	unsigned int vertexCount;
+	const void * indices;     // may be NULL for non indexed meshes
+	unsigned int indexCount;
+	unsigned int indexSize;   // 2 or 4 bytes
+	const MeshLod * lods;     // may be NULL, a single level covering every index is implied then
+	unsigned int lodCount;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct MeshFileHeader {
+	char magic[4];             // "MESH"
+	unsigned int version;      // MESH_FILE_VERSION
+	unsigned int headerSize;   // sizeof(MeshFileHeader), lets readers skip fields added later
+	unsigned int vertexCount;
+	unsigned int indexCount;
+	unsigned int indexSize;
+	unsigned int lodCount;
+	float boundsMin[3];
+	float boundsMax[3];
+	MeshLayout layout;
+	unsigned int reserved;     // 0, keeps the offsets 8 byte aligned
+	unsigned long long vertexOffset; // byte offsets from the start of the file
+	unsigned long long indexOffset;
+	unsigned long long lodOffset;
+	unsigned long long fileSize;
+};
+
+// attribute helper for building layouts
+MeshAttribute meshAttribute(unsigned int location, unsigned int components, unsigned int type, unsigned int offset, bool normalized = false);
+
+// bytes taken by one attribute
+unsigned int meshAttributeSize(const MeshAttribute & attribute);
+
+// bounds of the first attribute, which has to be a float position
+void computeMeshBounds(MeshView & mesh);
+
+// Replaces the indices of a mesh by a simplified LOD chain (see buildLodChain), the view then
+// points into chain and lods. Positions have to be the first attribute and stored as floats.
+void buildMeshLods(MeshView & mesh, std::vector<unsigned int> & chain, std::vector<MeshLod> & lods, size_t min_triangles = 32);
+
+// Vertex cache and overdraw order for every LOD range, then vertex fetch order over the whole
+// index buffer (see meshoptimize.hpp). The view then points into vertices and indices (32 bit).
+// Positions have to be the first attribute and stored as floats.
+void optimizeMeshView(MeshView & mesh, std::vector<unsigned char> & vertices, std::vector<unsigned int> & indices);
+
+// Packs the float attributes into the compact layout, by shader location :
+//   0 position : 4 x unsigned short, normalized, relative to the mesh bounds (w is 0)
+//   1 color    : 4 x unsigned byte, normalized, alpha 1
+//   2 uv       : 2 x half float
+//   3 normal   : GL_INT_2_10_10_10_REV, normalized
+// other attributes are copied as they are. The bounds have to be set (computeMeshBounds) and stay
+// in the view, a vertex shader gets the position back as boundsMin + (boundsMax - boundsMin) * stored.
+// The view then points into vertices. Run it last, the other passes expect float positions.
+void quantizeMeshView(MeshView & mesh, std::vector<unsigned char> & vertices);
+
+// true when the positions are stored relative to the bounds (see quantizeMeshView)
+bool meshPositionsQuantized(const MeshLayout & layout);
+
+// Switches to 16 bit indices when every vertex can be addressed with them, the view then points into storage
+void narrowMeshIndices(MeshView & mesh, std::vector<unsigned short> & storage);
+
+// Positions of every vertex as x, y, z floats, quantized ones are decoded with the bounds
+void decodeMeshPositions(const MeshView & mesh, std::vector<float> & positions);
+
+// View of a MeshData (mesh.hpp) in the layout of the car shaders, with its bounds
+MeshView meshDataView(const MeshData & data);
+
+bool writeMeshFile(const char * path, const MeshView & mesh);
+
+// what cookMeshFile did, statistics are of the finest level
+struct MeshCookStats {
+	VertexCacheStats before;
+	VertexCacheStats after;
+	unsigned int strideBefore;
+	unsigned int strideAfter;
+	unsigned int vertexCount; // as written
+	unsigned int indexCount;
+	unsigned int indexSize;
+	unsigned int lodCount;
+};
+
+// The offline pipeline : an optional LOD chain (buildMeshLods), vertex cache, overdraw and fetch
+// order (optimizeMeshView), quantization (quantizeMeshView), 16 bit indices when they fit, then writeMeshFile
+bool cookMeshFile(const char * path, MeshView mesh, bool lods, bool quantize, MeshCookStats * stats = NULL);
+
+// Read-only view of a mapped .mesh file, the data stays valid until close()
+class MeshFile {
+public:
+	MeshFile() { close(); }
+
+	bool open(const char * path);
+	void close();
+	const MeshView & view() const { return mesh; }
+
+private:
+	MappedFile file;
+	MeshView mesh;
+};
+
+#endif
@@ -0,0 +1,255 @@
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include "meshoptimize.hpp"
+
+namespace {
+
+// triangles around every vertex, as offsets into one flat array
+struct Adjacency {
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> counts;
+	std::vector<unsigned int> triangles;
+
+	Adjacency(const unsigned int * indices, size_t index_count, size_t vertex_count)
+		: offsets(vertex_count + 1, 0), counts(vertex_count, 0), triangles(index_count)
+	{
+		for (size_t i=0; i<index_count; i++)
+			counts[indices[i]]++;
+		for (size_t v=0; v<vertex_count; v++)
+			offsets[v+1] = offsets[v] + counts[v];
+		std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i=0; i<index_count; i++)
+			triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+	}
+};
+
+// misses of a FIFO cache over a range of triangles, the cache state is kept between calls
+struct FifoCache {
+	std::vector<unsigned int> stamp; // time the vertex entered the cache
+	unsigned int time;
+	unsigned int size;
+
+	FifoCache(size_t vertex_count, unsigned int cache_size) : stamp(vertex_count, 0), time(cache_size + 1), size(cache_size) {}
+
+	// empties the cache without touching every vertex : all stamps become too old
+	void reset(){ time += size + 1; }
+
+	// 1 when the vertex had to be transformed
+	unsigned int access(unsigned int v){
+		if (time - stamp[v] > size){
+			stamp[v] = time++;
+			return 1;
+		}
+		return 0;
+	}
+};
+
+}
+
+VertexCacheStats analyzeVertexCache(
+	const unsigned int * indices, size_t index_count,
+	size_t vertex_count,
+	unsigned int cache_size
+){
+	VertexCacheStats stats;
+	stats.transformed = 0;
+	FifoCache cache(vertex_count, cache_size);
+	std::vector<bool> used(vertex_count, false);
+	size_t unique = 0;
+	for (size_t i=0; i<index_count; i++){
+		stats.transformed += cache.access(indices[i]);
+		if (!used[indices[i]]){ used[indices[i]] = true; unique++; }
+	}
+	stats.acmr = index_count ? (float)stats.transformed / (index_count / 3) : 0.0f;
+	stats.atvr = unique ? (float)stats.transformed / unique : 0.0f;
+	return stats;
+}
+
+void optimizeVertexCache(
+	const unsigned int * indices, size_t index_count,
+	size_t vertex_count,
+	std::vector<unsigned int> & out_indices,
+	std::vector<unsigned int> * out_clusters,
+	unsigned int cache_size
+){
+	size_t triangle_count = index_count / 3;
+	out_indices.clear();
+	out_indices.reserve(triangle_count * 3);
+	if (out_clusters) out_clusters->clear();
+	if (triangle_count == 0) return;
+
+	Adjacency adjacency(indices, index_count, vertex_count);
+	std::vector<unsigned int> live(adjacency.counts);
+	std::vector<unsigned int> cache_time(vertex_count, 0);
+	std::vector<bool> emitted(triangle_count, false);
+	std::vector<unsigned int> dead_end; // recently used vertices, where to continue when a fan runs dry
+	std::vector<unsigned int> candidates;
+	unsigned int time = cache_size + 1;
+	size_t cursor = 0;
+
+	// start on the first referenced vertex
+	int fan = (int)indices[0];
+	if (out_clusters) out_clusters->push_back(0);
+	while (fan >= 0){
+		candidates.clear();
+		// emit every remaining triangle around the fanning vertex
+		for (unsigned int k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; k++){
+			unsigned int t = adjacency.triangles[k];
+			if (emitted[t]) continue;
+			emitted[t] = true;
+			for (int c=0; c<3; c++){
+				unsigned int v = indices[t*3 + c];
+				out_indices.push_back(v);
+				dead_end.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cache_time[v] > cache_size)
+					cache_time[v] = time++;
+			}
+		}
+
+		// next fan : the candidate still in cache that will stay there for its remaining triangles,
+		// preferring the oldest one
+		int next = -1;
+		unsigned int best = 0;
+		for (size_t i=0; i<candidates.size(); i++){
+			unsigned int v = candidates[i];
+			if (live[v] == 0) continue;
+			unsigned int priority = 0;
+			if (time - cache_time[v] + 2 * live[v] <= cache_size)
+				priority = time - cache_time[v];
+			if (next < 0 || priority > best){
+				best = priority;
+				next = (int)v;
+			}
+		}
+
+		if (next < 0){
+			// dead end : back up through recently used vertices, then scan for anything left
+			while (!dead_end.empty() && next < 0){
+				unsigned int v = dead_end.back();
+				dead_end.pop_back();
+				if (live[v] > 0) next = (int)v;
+			}
+			while (next < 0 && cursor < vertex_count){
+				if (live[cursor] > 0) next = (int)cursor;
+				cursor++;
+			}
+			// a jump to a different part of the mesh is a hard cluster boundary
+			if (next >= 0 && out_clusters)
+				out_clusters->push_back((unsigned int)(out_indices.size() / 3));
+		}
+		fan = next;
+	}
+}
+
+void optimizeOverdraw(
+	const unsigned int * indices, size_t index_count,
+	const float * positions, size_t vertex_count, size_t stride,
+	std::vector<unsigned int> & out_indices,
+	float threshold,
+	unsigned int cache_size
+){
+	std::vector<unsigned int> ordered, hard;
+	optimizeVertexCache(indices, index_count, vertex_count, ordered, &hard, cache_size);
+	size_t triangle_count = ordered.size() / 3;
+	out_indices.clear();
+	if (triangle_count == 0) return;
+	hard.push_back((unsigned int)triangle_count);
+
+	// soft boundaries : inside a hard cluster, cut wherever the cache cost so far is already close to
+	// the cost of the whole cluster, so sorting the pieces does not throw away the vertex reuse
+	std::vector<unsigned int> clusters;
+	FifoCache cache(vertex_count, cache_size);
+	for (size_t h=0; h+1<hard.size(); h++){
+		unsigned int begin = hard[h], end = hard[h+1];
+		cache.reset();
+		unsigned int misses = 0;
+		for (unsigned int t=begin; t<end; t++)
+			for (int c=0; c<3; c++) misses += cache.access(ordered[t*3 + c]);
+		float cluster_acmr = (float)misses / (end - begin);
+
+		cache.reset();
+		unsigned int start = begin, running = 0;
+		clusters.push_back(begin);
+		for (unsigned int t=begin; t<end; t++){
+			for (int c=0; c<3; c++) running += cache.access(ordered[t*3 + c]);
+			if (t + 1 < end && (float)running / (t + 1 - start) <= cluster_acmr * threshold){
+				clusters.push_back(t + 1);
+				start = t + 1;
+				running = 0;
+				cache.reset();
+			}
+		}
+	}
+	clusters.push_back((unsigned int)triangle_count);
+
+	// area weighted centre and normal of the mesh and of every cluster
+	struct Cluster { unsigned int begin, end; float sort; };
+	std::vector<Cluster> order(clusters.size() - 1);
+	glm::vec3 mesh_centre(0.0f);
+	float mesh_area = 0.0f;
+	std::vector<glm::vec3> centres(order.size()), normals(order.size());
+	for (size_t c=0; c<order.size(); c++){
+		glm::vec3 centre(0.0f), normal(0.0f);
+		float area = 0.0f;
+		for (unsigned int t=clusters[c]; t<clusters[c+1]; t++){
+			const float * a = positions + ordered[t*3] * stride;
+			const float * b = positions + ordered[t*3 + 1] * stride;
+			const float * d = positions + ordered[t*3 + 2] * stride;
+			glm::vec3 p0(a[0], a[1], a[2]), p1(b[0], b[1], b[2]), p2(d[0], d[1], d[2]);
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+			float triangle_area = glm::length(n);
+			centre += (p0 + p1 + p2) * (triangle_area / 3.0f);
+			normal += n;
+			area += triangle_area;
+		}
+		mesh_centre += centre;
+		mesh_area += area;
+		centres[c] = area > 0.0f ? centre / area : centre;
+		float len = glm::length(normal);
+		normals[c] = len > 0.0f ? normal / len : normal;
+		order[c].begin = clusters[c];
+		order[c].end = clusters[c+1];
+	}
+	if (mesh_area > 0.0f) mesh_centre /= mesh_area;
+	for (size_t c=0; c<order.size(); c++)
+		order[c].sort = glm::dot(centres[c] - mesh_centre, normals[c]);
+
+	// outward facing clusters on the outside of the mesh are drawn first
+	std::stable_sort(order.begin(), order.end(), [](const Cluster & a, const Cluster & b){ return a.sort > b.sort; });
+	out_indices.reserve(ordered.size());
+	for (size_t c=0; c<order.size(); c++)
+		out_indices.insert(out_indices.end(), ordered.begin() + order[c].begin * 3, ordered.begin() + order[c].end * 3);
+
+	// small meshes made of many disconnected pieces lose more reuse between the sorted clusters
+	// than the threshold allows, they keep the cache order
+	float sorted_acmr = analyzeVertexCache(&out_indices[0], out_indices.size(), vertex_count, cache_size).acmr;
+	float cache_acmr = analyzeVertexCache(&ordered[0], ordered.size(), vertex_count, cache_size).acmr;
+	if (sorted_acmr > cache_acmr * threshold)
+		out_indices.swap(ordered);
+}
+
+size_t optimizeVertexFetch(
+	unsigned int * indices, size_t index_count,
+	const void * vertices, size_t vertex_count, size_t vertex_size,
+	std::vector<unsigned char> & out_vertices
+){
+	std::vector<unsigned int> remap(vertex_count, ~0u);
+	unsigned int next = 0;
+	for (size_t i=0; i<index_count; i++){
+		unsigned int & r = remap[indices[i]];
+		if (r == ~0u) r = next++;
+		indices[i] = r;
+	}
+	out_vertices.resize((size_t)next * vertex_size);
+	const unsigned char * source = (const unsigned char *)vertices;
+	for (size_t v=0; v<vertex_count; v++)
+		if (remap[v] != ~0u)
+			memcpy(&out_vertices[(size_t)remap[v] * vertex_size], source + v * vertex_size, vertex_size);
+	return next;
+}
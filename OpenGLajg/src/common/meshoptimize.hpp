@@ -0,0 +1,55 @@
+#ifndef MESHOPTIMIZE_HPP
+#define MESHOPTIMIZE_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Post-transform vertex cache statistics of a FIFO cache with cache_size entries.
+// acmr : vertex shader invocations per triangle (0.5 is the ideal for large regular meshes, 3 the worst)
+// atvr : invocations per referenced vertex (1 is the ideal)
+struct VertexCacheStats {
+	float acmr;
+	float atvr;
+	size_t transformed;
+};
+
+VertexCacheStats analyzeVertexCache(
+	const unsigned int * indices, size_t index_count,
+	size_t vertex_count,
+	unsigned int cache_size = 16
+);
+
+// Reorder triangles for the post-transform cache with Tipsify
+// (Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+// out_clusters, when given, receives the first triangle of every run that started
+// after the algorithm had to jump to an unconnected part of the mesh.
+void optimizeVertexCache(
+	const unsigned int * indices, size_t index_count,
+	size_t vertex_count,
+	std::vector<unsigned int> & out_indices,
+	std::vector<unsigned int> * out_clusters = 0,
+	unsigned int cache_size = 16
+);
+
+// Cache optimization followed by overdraw ordering : the Tipsify runs are split further where the
+// cache is still warm enough (ACMR within `threshold` of the run), then the clusters are sorted so
+// the ones facing away from the mesh centre come first and occlude the rest.
+// Positions are the first three floats of every vertex, stride is in floats.
+void optimizeOverdraw(
+	const unsigned int * indices, size_t index_count,
+	const float * positions, size_t vertex_count, size_t stride,
+	std::vector<unsigned int> & out_indices,
+	float threshold = 1.05f,
+	unsigned int cache_size = 16
+);
+
+// Vertex fetch order : vertices are moved into first-use order of `indices`, the indices are
+// rewritten in place. Unreferenced vertices are dropped, returns the new vertex count.
+// vertex_size is in bytes, out_vertices receives the reordered vertex data.
+size_t optimizeVertexFetch(
+	unsigned int * indices, size_t index_count,
+	const void * vertices, size_t vertex_count, size_t vertex_size,
+	std::vector<unsigned char> & out_vertices
+);
+
+#endif
@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "meshsimplify.hpp"
+
+// Greedy edge collapse after Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics".
+// Only half-edge collapses are done (a vertex is merged into one of its neighbours),
+// which keeps the original vertex buffer valid for every level.
+
+namespace {
+
+// symmetric 4x4 matrix, upper triangle
+struct Quadric {
+	double a[10];
+
+	Quadric(){ for (int i=0; i<10; i++) a[i] = 0.0; }
+
+	static Quadric plane(double x, double y, double z, double w, double weight){
+		Quadric q;
+		q.a[0] = x*x*weight; q.a[1] = x*y*weight; q.a[2] = x*z*weight; q.a[3] = x*w*weight;
+		q.a[4] = y*y*weight; q.a[5] = y*z*weight; q.a[6] = y*w*weight;
+		q.a[7] = z*z*weight; q.a[8] = z*w*weight;
+		q.a[9] = w*w*weight;
+		return q;
+	}
+
+	void add(const Quadric & o){ for (int i=0; i<10; i++) a[i] += o.a[i]; }
+
+	// squared distance of p to the planes summed in this quadric
+	double error(const glm::vec3 & p) const {
+		double x = p.x, y = p.y, z = p.z;
+		return a[0]*x*x + 2*a[1]*x*y + 2*a[2]*x*z + 2*a[3]*x
+		     + a[4]*y*y + 2*a[5]*y*z + 2*a[6]*y
+		     + a[7]*z*z + 2*a[8]*z
+		     + a[9];
+	}
+};
+
+struct Collapse {
+	double cost;
+	unsigned int from, to;
+	unsigned int fromVersion, toVersion;
+	bool operator<(const Collapse & o) const { return cost > o.cost; } // min heap
+};
+
+struct PositionHash {
+	size_t operator()(const glm::vec3 & p) const {
+		size_t h = 0;
+		for (int i=0; i<3; i++){
+			union { float f; unsigned int u; } c;
+			c.f = p[i] == 0.0f ? 0.0f : p[i]; // -0 and +0 weld
+			h = h * 83492791u ^ c.u;
+		}
+		return h;
+	}
+};
+
+const double BORDER_WEIGHT = 10.0;
+
+// squared difference of the floats after the position (normal, uv, color...) of two vertices
+double attributeDistance(const float * positions, size_t stride, unsigned int a, unsigned int b){
+	double d = 0.0;
+	for (size_t k=3; k<stride; k++){
+		double e = positions[a*stride+k] - positions[b*stride+k];
+		d += e*e;
+	}
+	return d;
+}
+
+}
+
+float simplifyMesh(
+	const float * positions, size_t vertex_count, size_t stride,
+	const std::vector<unsigned int> & indices,
+	size_t target_triangles,
+	std::vector<unsigned int> & out_indices
+){
+	out_indices.clear();
+	size_t triangle_count = indices.size() / 3;
+	if (triangle_count <= target_triangles){
+		out_indices = indices;
+		return 0.0f;
+	}
+
+	std::vector<glm::vec3> points(vertex_count);
+	for (size_t i=0; i<vertex_count; i++)
+		points[i] = glm::vec3(positions[i*stride], positions[i*stride+1], positions[i*stride+2]);
+
+	// weld vertices that share a position, the remaining "representatives" are what gets collapsed
+	std::vector<unsigned int> weld(vertex_count);
+	std::unordered_map<glm::vec3, unsigned int, PositionHash> first_at;
+	first_at.reserve(vertex_count);
+	for (size_t i=0; i<vertex_count; i++){
+		auto it = first_at.insert(std::make_pair(points[i], (unsigned int)i));
+		weld[i] = it.first->second;
+	}
+
+	std::vector<unsigned int> tris(indices.size());
+	for (size_t i=0; i<indices.size(); i++)
+		tris[i] = weld[indices[i]];
+	// the original vertices used at each representative, the candidates for corners that collapse onto it
+	std::vector<std::vector<unsigned int> > welded(vertex_count);
+	for (size_t i=0; i<indices.size(); i++){
+		std::vector<unsigned int> & at = welded[tris[i]];
+		if (std::find(at.begin(), at.end(), indices[i]) == at.end())
+			at.push_back(indices[i]);
+	}
+
+	std::vector<bool> tri_alive(triangle_count, true);
+	size_t alive_count = 0;
+	std::vector<std::vector<unsigned int> > vertex_tris(vertex_count);
+	std::vector<Quadric> quadrics(vertex_count);
+
+	for (size_t t=0; t<triangle_count; t++){
+		unsigned int a = tris[3*t], b = tris[3*t+1], c = tris[3*t+2];
+		if (a == b || b == c || a == c){
+			tri_alive[t] = false;
+			continue;
+		}
+		alive_count++;
+		vertex_tris[a].push_back((unsigned int)t);
+		vertex_tris[b].push_back((unsigned int)t);
+		vertex_tris[c].push_back((unsigned int)t);
+		glm::vec3 n = glm::cross(points[b] - points[a], points[c] - points[a]);
+		float len = glm::length(n);
+		if (len <= 0.0f)
+			continue;
+		n /= len;
+		Quadric q = Quadric::plane(n.x, n.y, n.z, -glm::dot(n, points[a]), 1.0);
+		quadrics[a].add(q);
+		quadrics[b].add(q);
+		quadrics[c].add(q);
+	}
+
+	// border edges (used by one triangle) get a plane perpendicular to the surface so the outline stays put
+	std::unordered_map<unsigned long long, int> edge_use;
+	for (size_t t=0; t<triangle_count; t++){
+		if (!tri_alive[t]) continue;
+		for (int e=0; e<3; e++){
+			unsigned int a = tris[3*t+e], b = tris[3*t+(e+1)%3];
+			unsigned long long key = a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+			edge_use[key]++;
+		}
+	}
+	for (size_t t=0; t<triangle_count; t++){
+		if (!tri_alive[t]) continue;
+		unsigned int v[3] = { tris[3*t], tris[3*t+1], tris[3*t+2] };
+		glm::vec3 n = glm::cross(points[v[1]] - points[v[0]], points[v[2]] - points[v[0]]);
+		for (int e=0; e<3; e++){
+			unsigned int a = v[e], b = v[(e+1)%3];
+			unsigned long long key = a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+			if (edge_use[key] != 1) continue;
+			glm::vec3 edge = points[b] - points[a];
+			glm::vec3 side = glm::cross(edge, n);
+			float len = glm::length(side);
+			if (len <= 0.0f) continue;
+			side /= len;
+			Quadric q = Quadric::plane(side.x, side.y, side.z, -glm::dot(side, points[a]), BORDER_WEIGHT);
+			quadrics[a].add(q);
+			quadrics[b].add(q);
+		}
+	}
+
+	std::vector<unsigned int> version(vertex_count, 0);
+	std::priority_queue<Collapse> heap;
+
+	// cheapest direction of collapsing the edge a-b
+	auto push_edge = [&](unsigned int a, unsigned int b){
+		Quadric q = quadrics[a];
+		q.add(quadrics[b]);
+		double to_b = q.error(points[b]);
+		double to_a = q.error(points[a]);
+		Collapse c;
+		if (to_b <= to_a){ c.cost = to_b; c.from = a; c.to = b; }
+		else             { c.cost = to_a; c.from = b; c.to = a; }
+		c.fromVersion = version[c.from];
+		c.toVersion = version[c.to];
+		heap.push(c);
+	};
+
+	for (size_t t=0; t<triangle_count; t++){
+		if (!tri_alive[t]) continue;
+		for (int e=0; e<3; e++){
+			unsigned int a = tris[3*t+e], b = tris[3*t+(e+1)%3];
+			if (a < b) push_edge(a, b);
+			else {
+				// edges seen only from the other side would be lost otherwise
+				unsigned long long key = ((unsigned long long)b << 32) | a;
+				if (edge_use[key] == 1) push_edge(a, b);
+			}
+		}
+	}
+
+	double last_error = 0.0;
+	while (alive_count > target_triangles && !heap.empty()){
+		Collapse c = heap.top();
+		heap.pop();
+		if (c.fromVersion != version[c.from] || c.toVersion != version[c.to])
+			continue; // stale entry, an endpoint changed since it was queued
+
+		// moving `from` onto `to` must not flip any triangle that stays alive
+		bool flips = false;
+		for (unsigned int t : vertex_tris[c.from]){
+			if (!tri_alive[t]) continue;
+			unsigned int * v = &tris[3*t];
+			if (v[0] == c.to || v[1] == c.to || v[2] == c.to) continue; // collapses away
+			glm::vec3 p[3], q[3];
+			for (int k=0; k<3; k++){
+				p[k] = points[v[k]];
+				q[k] = v[k] == c.from ? points[c.to] : p[k];
+			}
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			if (glm::dot(before, after) <= 0.0f){ flips = true; break; }
+		}
+		if (flips) continue;
+
+		last_error = std::max(last_error, c.cost);
+		for (unsigned int t : vertex_tris[c.from]){
+			if (!tri_alive[t]) continue;
+			unsigned int * v = &tris[3*t];
+			for (int k=0; k<3; k++)
+				if (v[k] == c.from) v[k] = c.to;
+			if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]){
+				tri_alive[t] = false;
+				alive_count--;
+			} else {
+				vertex_tris[c.to].push_back(t);
+			}
+		}
+		vertex_tris[c.from].clear();
+		quadrics[c.to].add(quadrics[c.from]);
+		version[c.from]++;
+		version[c.to]++;
+
+		// requeue the edges around the merged vertex with the new quadric
+		std::vector<unsigned int> & around = vertex_tris[c.to];
+		size_t kept = 0;
+		for (size_t i=0; i<around.size(); i++){
+			unsigned int t = around[i];
+			if (!tri_alive[t]) continue;
+			around[kept++] = t;
+			for (int k=0; k<3; k++){
+				unsigned int n = tris[3*t+k];
+				if (n != c.to) push_edge(c.to, n);
+			}
+		}
+		around.resize(kept);
+	}
+
+	// a corner keeps its original vertex, and so its normal, uv and color seams, unless it collapsed.
+	// then it takes the vertex at the new position whose attributes are closest to its own
+	out_indices.reserve(alive_count * 3);
+	for (size_t t=0; t<triangle_count; t++){
+		if (!tri_alive[t]) continue;
+		for (size_t i=3*t; i<3*t+3; i++){
+			unsigned int source = indices[i];
+			if (weld[source] == tris[i]){
+				out_indices.push_back(source);
+				continue;
+			}
+			const std::vector<unsigned int> & at = welded[tris[i]];
+			unsigned int best = at[0];
+			double best_distance = attributeDistance(positions, stride, source, best);
+			for (size_t j=1; j<at.size() && best_distance > 0.0; j++){
+				double distance = attributeDistance(positions, stride, source, at[j]);
+				if (distance < best_distance){ best = at[j]; best_distance = distance; }
+			}
+			out_indices.push_back(best);
+		}
+	}
+
+	// every corner that did not collapse has to come out with the attributes it went in with
+	size_t corner = 0, mismatches = 0;
+	for (size_t t=0; t<triangle_count; t++){
+		if (!tri_alive[t]) continue;
+		for (size_t i=3*t; i<3*t+3; i++, corner++)
+			if (weld[indices[i]] == tris[i] && attributeDistance(positions, stride, indices[i], out_indices[corner]) != 0.0)
+				mismatches++;
+	}
+	if (mismatches)
+		printf("simplifyMesh: %u corners lost their attributes\n", (unsigned int)mismatches);
+	return (float)std::sqrt(std::max(last_error, 0.0));
+}
+
+
+void buildLodChain(
+	const float * positions, size_t vertex_count, size_t stride,
+	const std::vector<unsigned int> & indices,
+	std::vector<unsigned int> & out_indices,
+	std::vector<MeshLod> & out_lods,
+	float ratio,
+	size_t min_triangles,
+	size_t max_levels
+){
+	out_indices.clear();
+	out_lods.clear();
+
+	MeshLod lod0;
+	lod0.indexOffset = 0;
+	lod0.indexCount = (unsigned int)indices.size();
+	lod0.baseVertex = 0;
+	lod0.error = 0.0f;
+	out_indices = indices;
+	out_lods.push_back(lod0);
+
+	// every level is simplified from the original, not from the previous level, so errors do not stack up
+	size_t triangles = indices.size() / 3;
+	float error = 0.0f;
+	std::vector<unsigned int> level;
+	while (out_lods.size() < max_levels && triangles > min_triangles){
+		size_t target = std::max(min_triangles, (size_t)(triangles * ratio));
+		error = std::max(error, simplifyMesh(positions, vertex_count, stride, indices, target, level));
+		size_t got = level.size() / 3;
+		if (got >= triangles) break; // nothing left that can be collapsed without flipping
+		MeshLod lod;
+		lod.indexOffset = (unsigned int)out_indices.size();
+		lod.indexCount = (unsigned int)level.size();
+		lod.baseVertex = 0;
+		lod.error = error;
+		out_indices.insert(out_indices.end(), level.begin(), level.end());
+		out_lods.push_back(lod);
+		triangles = got;
+	}
+}
+
+
+int selectLod(
+	const std::vector<MeshLod> & lods,
+	float pixels_per_unit,
+	int current_lod,
+	float pixel_tolerance,
+	float hysteresis
+){
+	if (lods.empty()) return 0;
+	int best = 0;
+	for (int i=(int)lods.size()-1; i>0; i--){
+		float pixels = lods[i].error * pixels_per_unit;
+		// coarser than what is shown now has to clear the tolerance by the hysteresis margin
+		float limit = i > current_lod ? pixel_tolerance * (1.0f - hysteresis) : pixel_tolerance;
+		if (pixels <= limit){
+			best = i;
+			break;
+		}
+	}
+	return best;
+}
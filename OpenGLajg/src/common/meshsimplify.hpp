@@ -0,0 +1,52 @@
+#ifndef MESHSIMPLIFY_H
+#define MESHSIMPLIFY_H
+
+#include <vector>
+#include <cstddef>
+
+// One level of detail : a range of the concatenated LOD index buffer
+struct MeshLod {
+	unsigned int indexOffset;
+	unsigned int indexCount;
+	int baseVertex; // added to every index, for levels that live in a shared vertex buffer
+	float error; // largest distance from the original surface, in model units
+};
+
+// Simplify an indexed triangle mesh down to target_triangles with quadric error metrics.
+// Vertices are never moved or created, the result only references existing vertices,
+// so every LOD can share the vertex buffer of the original mesh.
+// Vertices with the same position are welded first, so de-indexed meshes work as well.
+// Returns the error of the last collapse.
+float simplifyMesh(
+	const float * positions, size_t vertex_count, size_t stride, // stride in floats, position first
+	const std::vector<unsigned int> & indices,
+	size_t target_triangles,
+	std::vector<unsigned int> & out_indices
+);
+
+// Build a LOD chain : level 0 is the input, every next level keeps about `ratio` of the
+// triangles of the previous one, stopping at min_triangles or max_levels.
+// All levels are appended to out_indices, out_lods describes their ranges.
+void buildLodChain(
+	const float * positions, size_t vertex_count, size_t stride,
+	const std::vector<unsigned int> & indices,
+	std::vector<unsigned int> & out_indices,
+	std::vector<MeshLod> & out_lods,
+	float ratio = 0.5f,
+	size_t min_triangles = 32,
+	size_t max_levels = 8
+);
+
+// Pick a LOD from the projected error : the coarsest level whose error covers at most
+// `pixel_tolerance` pixels. Switching to a coarser level needs the error to be
+// `hysteresis` (fraction) below the tolerance, so a mesh at the boundary does not flicker.
+// pixels_per_unit is viewport_height / (2 * tan(fovy / 2) * distance).
+int selectLod(
+	const std::vector<MeshLod> & lods,
+	float pixels_per_unit,
+	int current_lod,
+	float pixel_tolerance = 1.0f,
+	float hysteresis = 0.25f
+);
+
+#endif
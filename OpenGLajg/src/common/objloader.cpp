@@ -2,20 +2,329 @@
 #include <stdio.h>
 #include <string>
 #include <cstring>
+#include <climits>
+#include <cmath>
+#include <thread>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 
 #include "objloader.hpp"
+#include "mappedfile.hpp"
+#include "profiler.hpp"
 
-// Very, VERY simple OBJ loader.
-// Here is a short list of features a real function would provide : 
-// - Binary files. Reading a model should be just a few memcpy's away, not parsing a file at runtime. In short : OBJ is not very great.
+// Fast OBJ loader.
+// The file is memory mapped and split into line aligned chunks that are parsed in parallel,
+// every chunk keeps its own attribute arrays which are concatenated afterwards.
+// Supported : v, vt, vn and f with any polygon size (triangulated as a fan),
+// v, v/vt, v//vn and v/vt/vn corners, negative (relative) indices.
+// Everything else (o, g, s, usemtl, mtllib, l, p, comments) is skipped.
+// loadOBJ returns flat triangles for glDrawArrays, loadOBJIndexed merges identical
+// v/vt/vn corners into an interleaved vertex buffer plus a 16 or 32 bit index buffer.
+// Still missing compared to a real asset pipeline :
+// - Binary files. Reading a model should be just a few memcpy's away, not parsing a file at runtime.
 // - Animations & bones (includes bones weights)
-// - Multiple UVs
-// - All attributes should be optional, not "forced"
-// - More stable. Change a line in the OBJ file and it crashes.
-// - More secure. Change another line and you can inject code.
-// - Loading from memory, stream, etc
+// - Multiple UVs, materials
+
+namespace {
+
+const int MISSING = INT_MIN;
+
+// numbers are parsed by hand : no locale, no null terminator needed, and std::from_chars
+// for floating point is not available with every compiler this project is built with
+const double POW10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isDigit(char c){ return (unsigned char)(c - '0') < 10; }
+
+inline const char * skipBlanks(const char * p, const char * end){
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	return p;
+}
+
+// rare inputs : more than 19 significant digits, keeps the first 19
+bool parseFloatLong(const char *& p, const char * end, unsigned long long & mantissa, int & exponent){
+	const char * s = p;
+	int digits = 0;
+	bool any = false;
+	mantissa = 0;
+	exponent = 0;
+	for (; s < end && isDigit(*s); s++){
+		any = true;
+		if (digits < 19){ mantissa = mantissa * 10 + (*s - '0'); if (mantissa) digits++; }
+		else exponent++;
+	}
+	if (s < end && *s == '.'){
+		for (s++; s < end && isDigit(*s); s++){
+			any = true;
+			if (digits < 19){ mantissa = mantissa * 10 + (*s - '0'); if (mantissa) digits++; exponent--; }
+		}
+	}
+	p = s;
+	return any;
+}
+
+// decimal or scientific notation, exact for up to 19 significant digits and exponents within 1e22
+bool parseFloat(const char *& p, const char * end, float & out){
+	const char * s = skipBlanks(p, end);
+	bool negative = false;
+	if (s < end && (*s == '-' || *s == '+')){ negative = *s == '-'; s++; }
+
+	const char * start = s;
+	unsigned long long mantissa = 0;
+	int exponent = 0;
+	for (; s < end && isDigit(*s); s++)
+		mantissa = mantissa * 10 + (*s - '0');
+	size_t digits = s - start;
+	if (s < end && *s == '.'){
+		const char * fraction = ++s;
+		for (; s < end && isDigit(*s); s++)
+			mantissa = mantissa * 10 + (*s - '0');
+		exponent = -(int)(s - fraction);
+		digits += s - fraction;
+	}
+	if (digits == 0) return false;
+	if (digits > 19){
+		s = start;
+		parseFloatLong(s, end, mantissa, exponent);
+	}
+	if (s < end && (*s == 'e' || *s == 'E')){
+		const char * e = s + 1;
+		bool exponent_negative = false;
+		if (e < end && (*e == '-' || *e == '+')){ exponent_negative = *e == '-'; e++; }
+		if (e < end && isDigit(*e)){
+			int value = 0;
+			for (; e < end && isDigit(*e); e++)
+				if (value < 10000) value = value * 10 + (*e - '0');
+			exponent += exponent_negative ? -value : value;
+			s = e;
+		}
+	}
+
+	double value = (double)mantissa;
+	if (mantissa != 0 && exponent != 0){
+		if (exponent < 0 && exponent >= -22) value /= POW10[-exponent];
+		else if (exponent > 0 && exponent <= 22) value *= POW10[exponent];
+		else value *= std::pow(10.0, (double)exponent);
+	}
+	out = (float)(negative ? -value : value);
+	p = s;
+	return true;
+}
+
+bool parseInt(const char *& p, const char * end, int & out){
+	const char * s = p;
+	bool negative = false;
+	if (s < end && (*s == '-' || *s == '+')){ negative = *s == '-'; s++; }
+	if (s >= end || !isDigit(*s)) return false;
+	long long value = 0;
+	for (; s < end && isDigit(*s); s++)
+		if (value <= INT_MAX) value = value * 10 + (*s - '0');
+	if (value > INT_MAX) return false;
+	out = negative ? -(int)value : (int)value;
+	p = s;
+	return true;
+}
+
+// attributes and triangulated corners of a part of the file
+struct ObjChunk {
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<int> corners; // (v, vt, vn) per corner, 0 based, MISSING when absent
+	// corner entries that came from negative indices and hold indices local to this chunk
+	std::vector<size_t> relative;
+	size_t bad_line; // offset of the first line that could not be parsed, 0 when fine
+	bool ok;
+};
+
+// one corner of a face : v, v/vt, v//vn or v/vt/vn
+bool parseCorner(const char *& p, const char * end, const ObjChunk & chunk, int out[3], bool is_relative[3]){
+	const size_t counts[3] = { chunk.positions.size(), chunk.uvs.size(), chunk.normals.size() };
+	for (int k=0; k<3; k++){
+		out[k] = MISSING;
+		is_relative[k] = false;
+	}
+	for (int k=0; k<3; k++){
+		if (k > 0){
+			if (p >= end || *p != '/') break;
+			p++;
+			if (p < end && *p == '/') continue; // empty vt
+		}
+		int index;
+		if (!parseInt(p, end, index) || index == 0) return false;
+		if (index > 0) out[k] = index - 1;
+		else { out[k] = (int)counts[k] + index; is_relative[k] = true; } // may point before this chunk, fixed when merging
+	}
+	return true;
+}
+
+void parseChunk(const char * begin, const char * end, const char * file_begin, ObjChunk & chunk){
+	PROFILE_SCOPE("parse OBJ chunk");
+	chunk.ok = true;
+	chunk.bad_line = 0;
+	// rough guess from the size, a vertex line is around 30 bytes, faces need a bit more
+	size_t guess = (size_t)(end - begin) / 64;
+	chunk.positions.reserve(guess);
+	chunk.corners.reserve(guess * 6);
+
+	std::vector<int> face;
+	std::vector<unsigned char> face_relative;
+	const char * p = begin;
+	while (p < end){
+		p = skipBlanks(p, end);
+		const char * line_end = (const char *)memchr(p, '\n', end - p);
+		if (!line_end) line_end = end;
+		bool good = true;
+
+		if (p + 1 < line_end && p[0] == 'v'){
+			const char * q = p + 2;
+			if (p[1] == ' ' || p[1] == '\t'){
+				glm::vec3 v;
+				q = p + 1;
+				good = parseFloat(q, line_end, v.x) && parseFloat(q, line_end, v.y) && parseFloat(q, line_end, v.z);
+				chunk.positions.push_back(v);
+			}else if (p[1] == 't'){
+				glm::vec2 uv(0.0f);
+				good = parseFloat(q, line_end, uv.x);
+				parseFloat(q, line_end, uv.y); // 1D texture coordinates leave v at 0
+				uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
+				chunk.uvs.push_back(uv);
+			}else if (p[1] == 'n'){
+				glm::vec3 n;
+				good = parseFloat(q, line_end, n.x) && parseFloat(q, line_end, n.y) && parseFloat(q, line_end, n.z);
+				chunk.normals.push_back(n);
+			}
+		}else if (p + 1 < line_end && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')){
+			face.clear();
+			face_relative.clear();
+			const char * q = skipBlanks(p + 1, line_end);
+			while (good && q < line_end && *q != '\r' && *q != '#'){
+				int corner[3];
+				bool is_relative[3];
+				good = parseCorner(q, line_end, chunk, corner, is_relative);
+				for (int k=0; k<3; k++){
+					face.push_back(corner[k]);
+					face_relative.push_back(is_relative[k]);
+				}
+				q = skipBlanks(q, line_end);
+			}
+			if (face.size() < 9) good = false;
+			if (good){
+				// fan triangulation, fine for the convex polygons exporters write
+				size_t corner_count = face.size() / 3;
+				for (size_t i=1; i+1<corner_count; i++){
+					const size_t fan[3] = { 0, i, i+1 };
+					for (int c=0; c<3; c++)
+						for (int k=0; k<3; k++){
+							if (face_relative[fan[c]*3+k])
+								chunk.relative.push_back(chunk.corners.size());
+							chunk.corners.push_back(face[fan[c]*3+k]);
+						}
+				}
+			}
+		}
+
+		if (!good && chunk.ok){
+			chunk.ok = false;
+			chunk.bad_line = (size_t)(p - file_begin);
+		}
+		p = line_end + 1;
+	}
+}
+
+// the whole file : attributes and triangulated corners with resolved, validated indices
+struct ObjData {
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<int> corners; // (v, vt, vn) per corner, vt and vn may be MISSING
+};
+
+bool parseOBJ(const char * path, ObjData & out){
+	PROFILE_SCOPE("parse OBJ");
+	printf("Loading OBJ file %s...\n", path);
+
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+	const char * data = (const char *)file.data();
+	size_t size = file.size();
+
+	// one chunk per core, but not smaller than a megabyte so small files skip the threads
+	size_t chunk_count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), size >> 20));
+	std::vector<const char *> bounds(chunk_count + 1);
+	bounds[0] = data;
+	bounds[chunk_count] = data + size;
+	for (size_t i=1; i<chunk_count; i++){
+		const char * p = std::max(bounds[i-1], data + size / chunk_count * i);
+		const char * newline = (const char *)memchr(p, '\n', data + size - p);
+		bounds[i] = newline ? newline + 1 : data + size;
+	}
+
+	std::vector<ObjChunk> chunks(chunk_count);
+	std::vector<std::thread> workers;
+	for (size_t i=1; i<chunk_count; i++)
+		workers.push_back(std::thread(parseChunk, bounds[i], bounds[i+1], data, std::ref(chunks[i])));
+	parseChunk(bounds[0], bounds[1], data, chunks[0]);
+	for (size_t i=0; i<workers.size(); i++)
+		workers[i].join();
+
+	for (size_t i=0; i<chunk_count; i++){
+		if (!chunks[i].ok){
+			size_t line = 1 + std::count(data, data + chunks[i].bad_line, '\n');
+			printf("%s:%u : line can't be read by our parser\n", path, (unsigned int)line);
+			return false;
+		}
+	}
+
+	// concatenate the attributes, indices from negative references are shifted by what the previous chunks declared
+	std::vector<glm::vec3> & temp_vertices = out.positions;
+	std::vector<glm::vec2> & temp_uvs = out.uvs;
+	std::vector<glm::vec3> & temp_normals = out.normals;
+	std::vector<int> & corners = out.corners;
+	size_t corner_total = 0;
+	for (size_t i=0; i<chunk_count; i++)
+		corner_total += chunks[i].corners.size();
+	for (size_t i=0; i<chunk_count; i++){
+		ObjChunk & chunk = chunks[i];
+		const int base[3] = { (int)temp_vertices.size(), (int)temp_uvs.size(), (int)temp_normals.size() };
+		for (size_t r=0; r<chunk.relative.size(); r++){
+			size_t entry = chunk.relative[r];
+			chunk.corners[entry] += base[entry % 3];
+		}
+		if (i == 0){
+			// the first chunk needs no shifting, take its arrays as they are
+			corners.swap(chunk.corners);
+			temp_vertices.swap(chunk.positions);
+			temp_uvs.swap(chunk.uvs);
+			temp_normals.swap(chunk.normals);
+			corners.reserve(corner_total);
+			continue;
+		}
+		corners.insert(corners.end(), chunk.corners.begin(), chunk.corners.end());
+		temp_vertices.insert(temp_vertices.end(), chunk.positions.begin(), chunk.positions.end());
+		temp_uvs.insert(temp_uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		temp_normals.insert(temp_normals.end(), chunk.normals.begin(), chunk.normals.end());
+		std::vector<int>().swap(chunk.corners);
+	}
+
+	const int counts[3] = { (int)temp_vertices.size(), (int)temp_uvs.size(), (int)temp_normals.size() };
+	for (size_t i=0; i<corners.size(); i++){
+		int index = corners[i];
+		if (index == MISSING && i % 3 != 0) continue;
+		if (index < 0 || index >= counts[i % 3]){
+			printf("%s : face references a missing vertex\n", path);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
 
 bool loadOBJ(
 	const char * path, 
@@ -23,90 +332,133 @@ bool loadOBJ(
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals
 ){
-	printf("Loading OBJ file %s...\n", path);
+	PROFILE_SCOPE("load OBJ");
+	ObjData obj;
+	if (!parseOBJ(path, obj))
+		return false;
+	const std::vector<glm::vec3> & temp_vertices = obj.positions;
+	const std::vector<glm::vec2> & temp_uvs = obj.uvs;
+	const std::vector<glm::vec3> & temp_normals = obj.normals;
+	const std::vector<int> & corners = obj.corners;
 
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-	std::vector<glm::vec3> temp_vertices; 
-	std::vector<glm::vec2> temp_uvs;
-	std::vector<glm::vec3> temp_normals;
+	// For each vertex of each triangle, missing uvs are 0 and missing normals are the face normal
+	size_t vertex_count = corners.size() / 3;
+	size_t first = out_vertices.size();
+	out_vertices.resize(first + vertex_count);
+	out_uvs     .resize(first + vertex_count);
+	out_normals .resize(first + vertex_count);
+	for (size_t t=0; t<vertex_count; t+=3){
+		const int * c = &corners[t*3];
+		glm::vec3 face_normal(0.0f);
+		if (c[2] == MISSING || c[5] == MISSING || c[8] == MISSING){
+			glm::vec3 n = glm::cross(temp_vertices[c[3]] - temp_vertices[c[0]], temp_vertices[c[6]] - temp_vertices[c[0]]);
+			float len = glm::length(n);
+			if (len > 0.0f) face_normal = n / len;
+		}
+		for (int k=0; k<3; k++, c+=3){
+			size_t o = first + t + k;
+			out_vertices[o] = temp_vertices[c[0]];
+			out_uvs[o]      = c[1] == MISSING ? glm::vec2(0.0f) : temp_uvs[c[1]];
+			out_normals[o]  = c[2] == MISSING ? face_normal : temp_normals[c[2]];
+		}
+	}
+	return true;
+}
 
 
-	FILE * file = fopen(path, "r");
-	if( file == NULL ){
-		printf("Impossible to open the file ! Are you in the right path ? See Tutorial 1 for details\n");
-		getchar();
+
+namespace {
+
+inline unsigned int hashCorner(const int * c){
+	unsigned int h = (unsigned int)c[0] * 0x9E3779B1u;
+	h ^= ((unsigned int)c[1] + 0x7F4A7C15u) * 0x85EBCA77u;
+	h ^= ((unsigned int)c[2] + 0x165667B1u) * 0xC2B2AE3Du;
+	return h ^ (h >> 15);
+}
+
+template <typename Index>
+void emitIndices(const std::vector<unsigned int> & remap, std::vector<Index> & out){
+	out.resize(remap.size());
+	for (size_t i=0; i<remap.size(); i++)
+		out[i] = (Index)remap[i];
+}
+
+}
+
+bool loadOBJIndexed(
+	const char * path,
+	IndexedMesh & out_mesh
+){
+	PROFILE_SCOPE("load indexed OBJ");
+	ObjData obj;
+	if (!parseOBJ(path, obj))
 		return false;
-	}
+	const std::vector<int> & corners = obj.corners;
+	size_t corner_count = corners.size() / 3;
 
-	while( 1 ){
-
-		char lineHeader[128];
-		// read the first word of the line
-		int res = fscanf(file, "%s", lineHeader);
-		if (res == EOF)
-			break; // EOF = End Of File. Quit the loop.
-
-		// else : parse lineHeader
-		
-		if ( strcmp( lineHeader, "v" ) == 0 ){
-			glm::vec3 vertex;
-			fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z );
-			temp_vertices.push_back(vertex);
-		}else if ( strcmp( lineHeader, "vt" ) == 0 ){
-			glm::vec2 uv;
-			fscanf(file, "%f %f\n", &uv.x, &uv.y );
-			uv.y = -uv.y; // Invert V coordinate since we will only use DDS texture, which are inverted. Remove if you want to use TGA or BMP loaders.
-			temp_uvs.push_back(uv);
-		}else if ( strcmp( lineHeader, "vn" ) == 0 ){
-			glm::vec3 normal;
-			fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z );
-			temp_normals.push_back(normal);
-		}else if ( strcmp( lineHeader, "f" ) == 0 ){
-			std::string vertex1, vertex2, vertex3;
-			unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-			int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &vertexIndex[0], &uvIndex[0], &normalIndex[0], &vertexIndex[1], &uvIndex[1], &normalIndex[1], &vertexIndex[2], &uvIndex[2], &normalIndex[2] );
-			if (matches != 9){
-				printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-				fclose(file);
-				return false;
+	// open addressing table of (v, vt, vn) -> output vertex, linear probing, load factor below 1/2
+	size_t capacity = 16;
+	while (capacity < corner_count * 2) capacity <<= 1;
+	const unsigned int EMPTY = ~0u;
+	std::vector<unsigned int> table(capacity, EMPTY);
+	std::vector<unsigned int> first_corner; // output vertex -> the corner it was created from
+	first_corner.reserve(corner_count / 4);
+	std::vector<unsigned int> remap(corner_count);
+
+	for (size_t i=0; i<corner_count; i++){
+		const int * c = &corners[i*3];
+		size_t slot = hashCorner(c) & (capacity - 1);
+		while (true){
+			unsigned int v = table[slot];
+			if (v == EMPTY){
+				v = (unsigned int)first_corner.size();
+				table[slot] = v;
+				first_corner.push_back((unsigned int)i);
+				remap[i] = v;
+				break;
 			}
-			vertexIndices.push_back(vertexIndex[0]);
-			vertexIndices.push_back(vertexIndex[1]);
-			vertexIndices.push_back(vertexIndex[2]);
-			uvIndices    .push_back(uvIndex[0]);
-			uvIndices    .push_back(uvIndex[1]);
-			uvIndices    .push_back(uvIndex[2]);
-			normalIndices.push_back(normalIndex[0]);
-			normalIndices.push_back(normalIndex[1]);
-			normalIndices.push_back(normalIndex[2]);
-		}else{
-			// Probably a comment, eat up the rest of the line
-			char stupidBuffer[1000];
-			fgets(stupidBuffer, 1000, file);
+			const int * o = &corners[first_corner[v]*3];
+			if (o[0] == c[0] && o[1] == c[1] && o[2] == c[2]){
+				remap[i] = v;
+				break;
+			}
+			slot = (slot + 1) & (capacity - 1);
 		}
+	}
+	std::vector<unsigned int>().swap(table);
 
+	// a shared vertex cannot carry a face normal, positions without one get the area weighted average instead
+	std::vector<glm::vec3> smooth;
+	for (size_t t=0; t<corner_count; t+=3){
+		const int * c = &corners[t*3];
+		if (c[2] != MISSING && c[5] != MISSING && c[8] != MISSING) continue;
+		if (smooth.empty()) smooth.assign(obj.positions.size(), glm::vec3(0.0f));
+		glm::vec3 n = glm::cross(obj.positions[c[3]] - obj.positions[c[0]], obj.positions[c[6]] - obj.positions[c[0]]);
+		smooth[c[0]] += n;
+		smooth[c[3]] += n;
+		smooth[c[6]] += n;
 	}
 
-	// For each vertex of each triangle
-	for( unsigned int i=0; i<vertexIndices.size(); i++ ){
-
-		// Get the indices of its attributes
-		unsigned int vertexIndex = vertexIndices[i];
-		unsigned int uvIndex = uvIndices[i];
-		unsigned int normalIndex = normalIndices[i];
-		
-		// Get the attributes thanks to the index
-		glm::vec3 vertex = temp_vertices[ vertexIndex-1 ];
-		glm::vec2 uv = temp_uvs[ uvIndex-1 ];
-		glm::vec3 normal = temp_normals[ normalIndex-1 ];
-		
-		// Put the attributes in buffers
-		out_vertices.push_back(vertex);
-		out_uvs     .push_back(uv);
-		out_normals .push_back(normal);
-	
+	out_mesh.vertices.resize(first_corner.size());
+	for (size_t v=0; v<first_corner.size(); v++){
+		const int * c = &corners[first_corner[v]*3];
+		ObjVertex & vertex = out_mesh.vertices[v];
+		vertex.position = obj.positions[c[0]];
+		vertex.uv = c[1] == MISSING ? glm::vec2(0.0f) : obj.uvs[c[1]];
+		if (c[2] != MISSING){
+			vertex.normal = obj.normals[c[2]];
+		}else{
+			float len = glm::length(smooth[c[0]]);
+			vertex.normal = len > 0.0f ? smooth[c[0]] / len : glm::vec3(0.0f);
+		}
 	}
-	fclose(file);
+
+	out_mesh.indices16.clear();
+	out_mesh.indices32.clear();
+	if (out_mesh.vertices.size() <= 0x10000)
+		emitIndices(remap, out_mesh.indices16);
+	else
+		emitIndices(remap, out_mesh.indices32);
 	return true;
 }
 
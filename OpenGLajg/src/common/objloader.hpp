@@ -1,6 +1,11 @@
 #ifndef OBJLOADER_H
 #define OBJLOADER_H
 
+#include <vector>
+#include <glm/glm.hpp>
+
+// Triangulates polygons, missing uvs become (0,0) and missing normals the face normal.
+// The output is not indexed, three vertices per triangle are appended to the vectors.
 bool loadOBJ(
 	const char * path, 
 	std::vector<glm::vec3> & out_vertices, 
@@ -8,7 +13,31 @@ bool loadOBJ(
 	std::vector<glm::vec3> & out_normals
 );
 
+// Interleaved vertex of an indexed OBJ mesh, 32 bytes
+struct ObjVertex {
+	glm::vec3 position;
+	glm::vec2 uv;
+	glm::vec3 normal;
+};
+
+// Unique vertices and their triangle list. Meshes with at most 65536 vertices
+// fill indices16 (GL_UNSIGNED_SHORT), larger ones indices32 (GL_UNSIGNED_INT).
+struct IndexedMesh {
+	std::vector<ObjVertex> vertices;
+	std::vector<unsigned short> indices16;
+	std::vector<unsigned int> indices32;
 
+	size_t indexCount() const { return indices16.empty() ? indices32.size() : indices16.size(); }
+	size_t indexSize() const { return indices16.empty() ? sizeof(unsigned int) : sizeof(unsigned short); }
+	const void * indexData() const { return indices16.empty() ? (indices32.empty() ? 0 : (const void *)&indices32[0]) : (const void *)&indices16[0]; }
+};
+
+// Same parser as loadOBJ, but corners referencing the same v/vt/vn are merged into one vertex,
+// in order of first use. Positions without a normal get the average of the adjacent face normals.
+bool loadOBJIndexed(
+	const char * path,
+	IndexedMesh & out_mesh
+);
 
 bool loadAssImp(
 	const char * path, 
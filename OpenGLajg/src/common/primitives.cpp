@@ -0,0 +1,115 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "primitives.hpp"
+
+static const float PI = 3.14159265358979f;
+
+static Vertex makeVertex(const glm::vec3 & position, const glm::vec3 & color, const glm::vec2 & uv, const glm::vec3 & normal){
+	Vertex v;
+	v.position = position;
+	v.color = color;
+	v.uv = uv;
+	v.normal = normal;
+	return v;
+}
+
+// centre + ring fan at height z, normal along +Z or -Z
+static void addCap(MeshData & mesh, float radius, float z, unsigned int segments, const glm::vec3 & color, bool front){
+	unsigned int center = (unsigned int)mesh.vertices.size();
+	glm::vec3 normal(0.0f, 0.0f, front ? 1.0f : -1.0f);
+	mesh.vertices.push_back(makeVertex(glm::vec3(0.0f, 0.0f, z), color, glm::vec2(0.5f, 0.5f), normal));
+	for (unsigned int i=0; i<segments; i++){
+		float a = 2.0f * PI * i / segments;
+		float c = std::cos(a), s = std::sin(a);
+		mesh.vertices.push_back(makeVertex(glm::vec3(radius * c, radius * s, z), color, glm::vec2(0.5f + 0.5f * c, 0.5f + 0.5f * s), normal));
+	}
+	for (unsigned int i=0; i<segments; i++){
+		unsigned int a = center + 1 + i;
+		unsigned int b = center + 1 + (i + 1) % segments;
+		// counter clockwise seen from the side the normal points to
+		mesh.indices.push_back(center);
+		mesh.indices.push_back(front ? a : b);
+		mesh.indices.push_back(front ? b : a);
+	}
+}
+
+MeshData makeDisc(float radius, unsigned int segments, const glm::vec3 & color){
+	MeshData mesh;
+	segments = std::max(segments, 3u);
+	addCap(mesh, radius, 0.0f, segments, color, true);
+	return mesh;
+}
+
+MeshData makeCylinder(float radius, float depth, unsigned int segments, const glm::vec3 & color, bool caps){
+	MeshData mesh;
+	segments = std::max(segments, 3u);
+
+	// the seam column is duplicated so U can run from 0 to 1
+	for (unsigned int i=0; i<=segments; i++){
+		float u = (float)i / segments;
+		float a = 2.0f * PI * u;
+		glm::vec3 normal(std::cos(a), std::sin(a), 0.0f);
+		glm::vec3 p = normal * radius;
+		mesh.vertices.push_back(makeVertex(p, color, glm::vec2(u, 0.0f), normal));
+		mesh.vertices.push_back(makeVertex(p - glm::vec3(0.0f, 0.0f, depth), color, glm::vec2(u, 1.0f), normal));
+	}
+	for (unsigned int i=0; i<segments; i++){
+		unsigned int front0 = 2 * i, back0 = 2 * i + 1;
+		unsigned int front1 = 2 * (i + 1), back1 = 2 * (i + 1) + 1;
+		mesh.indices.push_back(front0); mesh.indices.push_back(back0); mesh.indices.push_back(front1);
+		mesh.indices.push_back(front1); mesh.indices.push_back(back0); mesh.indices.push_back(back1);
+	}
+
+	if (caps){
+		addCap(mesh, radius, 0.0f, segments, color, true);
+		addCap(mesh, radius, -depth, segments, color, false);
+	}
+	return mesh;
+}
+
+MeshData makeTorus(float radius, float tube_radius, unsigned int ring_segments, unsigned int tube_segments, const glm::vec3 & color){
+	MeshData mesh;
+	ring_segments = std::max(ring_segments, 3u);
+	tube_segments = std::max(tube_segments, 3u);
+
+	for (unsigned int i=0; i<=ring_segments; i++){
+		float u = (float)i / ring_segments;
+		float a = 2.0f * PI * u;
+		glm::vec3 dir(std::cos(a), std::sin(a), 0.0f);
+		for (unsigned int j=0; j<=tube_segments; j++){
+			float v = (float)j / tube_segments;
+			float b = 2.0f * PI * v;
+			glm::vec3 normal = dir * std::cos(b) + glm::vec3(0.0f, 0.0f, std::sin(b));
+			glm::vec3 p = dir * radius + normal * tube_radius;
+			mesh.vertices.push_back(makeVertex(p, color, glm::vec2(u, v), normal));
+		}
+	}
+	unsigned int row = tube_segments + 1;
+	for (unsigned int i=0; i<ring_segments; i++){
+		for (unsigned int j=0; j<tube_segments; j++){
+			unsigned int a = i * row + j, b = (i + 1) * row + j;
+			mesh.indices.push_back(a); mesh.indices.push_back(b); mesh.indices.push_back(a + 1);
+			mesh.indices.push_back(a + 1); mesh.indices.push_back(b); mesh.indices.push_back(b + 1);
+		}
+	}
+	return mesh;
+}
+
+void appendMesh(MeshData & dst, const MeshData & src, const glm::vec3 & offset){
+	unsigned int base = (unsigned int)dst.vertices.size();
+	for (size_t i=0; i<src.vertices.size(); i++){
+		Vertex v = src.vertices[i];
+		v.position += offset;
+		dst.vertices.push_back(v);
+	}
+	for (size_t i=0; i<src.indices.size(); i++)
+		dst.indices.push_back(base + src.indices[i]);
+}
+
+float tessellationError(float radius, unsigned int segments){
+	return radius * (1.0f - std::cos(PI / std::max(segments, 3u)));
+}
@@ -0,0 +1,27 @@
+#ifndef PRIMITIVES_HPP
+#define PRIMITIVES_HPP
+
+#include "mesh.hpp"
+
+// Procedural primitives, centred on the origin with their axis along +Z.
+// segments is the number of subdivisions around the axis (at least 3).
+// All of them come with smooth normals and texture coordinates.
+
+// Flat disc in the XY plane facing +Z, UVs map the disc into the unit square
+MeshData makeDisc(float radius, unsigned int segments, const glm::vec3 & color);
+
+// Cylinder from z = 0 to z = -depth (like the wheels), optionally closed with caps.
+// The side U wraps once around, V runs along the axis.
+MeshData makeCylinder(float radius, float depth, unsigned int segments, const glm::vec3 & color, bool caps = true);
+
+// Torus around the Z axis, ring_segments around the axis, tube_segments around the tube
+MeshData makeTorus(float radius, float tube_radius, unsigned int ring_segments, unsigned int tube_segments, const glm::vec3 & color);
+
+// Append src to dst, moved by offset
+void appendMesh(MeshData & dst, const MeshData & src, const glm::vec3 & offset = glm::vec3(0.0f));
+
+// Largest distance between a circle of this radius and its polygon with that many segments,
+// i.e. the geometric error of a tessellation level
+float tessellationError(float radius, unsigned int segments);
+
+#endif
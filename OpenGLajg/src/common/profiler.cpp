@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <vector>
+#include <string>
+
+#include "profiler.hpp"
+
+namespace {
+
+// names are literals of this code base, the escaping is for paths and quotes in track names
+void writeJSONString(FILE * file, const char * text){
+	fputc('"', file);
+	for (const char * c=text; *c; c++){
+		if (*c == '"' || *c == '\\')
+			fputc('\\', file);
+		if ((unsigned char)*c >= 0x20)
+			fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+} // namespace
+
+bool writeChromeTrace(const char * path){
+	FILE * file = fopen(path, "w");
+	if (file == NULL){
+		printf("%s could not be written\n", path);
+		return false;
+	}
+	ProfileRegistry & registry = profileRegistry();
+	std::vector<ProfileEvent> events;
+	size_t total = 0;
+	bool first = true;
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (size_t i=0; i<registry.tracks.size(); i++){
+		const ProfileTrack & track = *registry.tracks[i];
+		// the track's name and its place in the viewer, in the order the tracks were made
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", track.id);
+		writeJSONString(file, track.name.c_str());
+		fprintf(file, "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", track.id, track.id);
+		first = false;
+		track.snapshot(events);
+		for (size_t e=0; e<events.size(); e++){
+			fprintf(file, ",\n{\"name\":");
+			writeJSONString(file, events[e].name);
+			fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}", track.id, events[e].start, events[e].duration);
+		}
+		total += events.size();
+	}
+	fprintf(file, "\n]}\n");
+	bool ok = fclose(file) == 0;
+	if (ok)
+		printf("%s : %u events on %u tracks\n", path, (unsigned int)total, (unsigned int)registry.tracks.size());
+	return ok;
+}
@@ -0,0 +1,141 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// CPU scopes for finding where frame and load time goes. PROFILE_SCOPE("name") times the rest of
+// the block and records it on the track of the calling thread. every thread writes its own ring of
+// the last CAPACITY events with one atomic store and no lock, only its first event takes the lock
+// that registers the track. nothing is recorded until enableProfiler(true), a disabled scope reads
+// one atomic. writeChromeTrace (profiler.cpp) saves every track as Chrome trace_event JSON, which
+// chrome://tracing and Perfetto open. names are never copied : string literals only.
+// Recording is header only so tools built from the instrumented loaders need no extra source.
+
+struct ProfileEvent {
+	const char * name;
+	long long start;    // microseconds of profileClock()
+	long long duration;
+};
+
+// the events of one thread (or of the GPU), written by that thread alone
+class ProfileTrack {
+public:
+	static const size_t CAPACITY = 1 << 14;
+
+	ProfileTrack(const std::string & name, unsigned int id) : name(name), id(id), events(CAPACITY), written(0) {}
+
+	void record(const char * event, long long start, long long duration){
+		size_t index = written.load(std::memory_order_relaxed);
+		ProfileEvent & slot = events[index % CAPACITY];
+		slot.name = event;
+		slot.start = start;
+		slot.duration = duration;
+		written.store(index + 1, std::memory_order_release);
+	}
+
+	// the events still in the ring, oldest first. the owner may keep recording meanwhile,
+	// whatever it overwrote during the copy is dropped
+	void snapshot(std::vector<ProfileEvent> & out) const {
+		size_t end = written.load(std::memory_order_acquire);
+		size_t begin = end > CAPACITY ? end - CAPACITY : 0;
+		std::vector<ProfileEvent> copy;
+		for (size_t i=begin; i<end; i++)
+			copy.push_back(events[i % CAPACITY]);
+		size_t after = written.load(std::memory_order_acquire);
+		size_t firstIntact = after > CAPACITY ? after - CAPACITY : 0;
+		size_t skip = firstIntact > begin ? firstIntact - begin : 0;
+		out.assign(copy.begin() + std::min(skip, copy.size()), copy.end());
+	}
+
+	std::string name;
+	unsigned int id;
+
+private:
+	std::vector<ProfileEvent> events;
+	std::atomic<size_t> written;
+};
+
+// every track ever made, kept after their threads end so a capture still has them
+struct ProfileRegistry {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<ProfileTrack> > tracks;
+};
+inline ProfileRegistry & profileRegistry(){
+	static ProfileRegistry registry;
+	return registry;
+}
+
+inline std::atomic<bool> & profilerEnabledFlag(){
+	static std::atomic<bool> enabled(false);
+	return enabled;
+}
+inline bool profilerEnabled(){ return profilerEnabledFlag().load(std::memory_order_relaxed); }
+inline void enableProfiler(bool enabled){ profilerEnabledFlag().store(enabled); }
+
+// microseconds since the first call
+inline long long profileClock(){
+	static const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// a track that is not a thread, the GPU passes of GpuProfiler.h
+inline ProfileTrack * newProfileTrack(const std::string & name){
+	ProfileRegistry & registry = profileRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.tracks.push_back(std::unique_ptr<ProfileTrack>(new ProfileTrack(name, (unsigned int)registry.tracks.size() + 1)));
+	return registry.tracks.back().get();
+}
+
+// a thread gets its track with its first event, threads that never record cost nothing
+struct ThreadProfile {
+	ProfileTrack * track;
+	const char * name;
+};
+inline ThreadProfile & threadProfile(){
+	static thread_local ThreadProfile profile = { NULL, "thread" };
+	return profile;
+}
+inline ProfileTrack & threadProfileTrack(){
+	ThreadProfile & profile = threadProfile();
+	if (profile.track == NULL)
+		profile.track = newProfileTrack(profile.name);
+	return *profile.track;
+}
+// the name the calling thread's track has in the capture, a literal
+inline void setProfileThreadName(const char * name){
+	ThreadProfile & profile = threadProfile();
+	profile.name = name;
+	if (profile.track){
+		std::lock_guard<std::mutex> lock(profileRegistry().mutex);
+		profile.track->name = name;
+	}
+}
+
+class ProfileScope {
+public:
+	explicit ProfileScope(const char * event) : name(profilerEnabled() ? event : NULL), start(name ? profileClock() : 0) {}
+	~ProfileScope(){
+		if (name)
+			threadProfileTrack().record(name, start, profileClock() - start);
+	}
+private:
+	const char * name;
+	long long start;
+	ProfileScope(const ProfileScope &);
+	ProfileScope & operator=(const ProfileScope &);
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+// every track as Chrome trace_event JSON : complete ("X") events, one tid per track
+bool writeChromeTrace(const char * path);
+
+#endif
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <stb_rect_pack.h>
+
+#include "textureatlas.hpp"
+#include "texturecook.hpp"
+#include "imageresize.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+unsigned int roundUp(unsigned int value, unsigned int multiple){
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+// copies an image into its cell of a page, the edge pixels repeated over the rest of the cell
+void blitWithGutter(const AtlasImage & image, const AtlasPlacement & placement, const stbrp_rect & cell, unsigned int grid, unsigned int page_size, unsigned char * page){
+	unsigned int left = cell.x * grid, bottom = cell.y * grid;
+	for (unsigned int py=bottom; py<bottom + cell.h * grid; py++){
+		unsigned int sy = std::min(std::max(py, placement.y) - placement.y, image.height - 1);
+		const unsigned char * source = image.rgba + (size_t)sy * image.width * 4;
+		unsigned char * row = page + ((size_t)py * page_size + left) * 4;
+		for (unsigned int px=left; px<placement.x; px++, row += 4)
+			memcpy(row, source, 4);
+		memcpy(row, source, (size_t)image.width * 4);
+		row += image.width * 4;
+		for (unsigned int px=placement.x + image.width; px<left + cell.w * grid; px++, row += 4)
+			memcpy(row, source + (image.width - 1) * 4, 4);
+	}
+}
+
+} // namespace
+
+AtlasOptions::AtlasOptions()
+	: pageSize(2048), padding(8), levels(0)
+{
+}
+
+unsigned int atlasMipLevels(unsigned int padding){
+	unsigned int levels = 1;
+	while ((2u << (levels - 1)) <= padding)
+		levels++;
+	return levels;
+}
+
+bool packAtlas(const std::vector<AtlasImage> & images, const AtlasOptions & options, TextureAtlas & out){
+	PROFILE_SCOPE("pack atlas");
+	out.pages.clear();
+	out.placements.clear();
+	unsigned int padding = std::max(1u, options.padding);
+	unsigned int levels = options.levels ? std::min(options.levels, atlasMipLevels(padding)) : atlasMipLevels(padding);
+	// images start on a grid of the footprint of one pixel of the last level, 4 pixels at
+	// least so block compression never mixes two images
+	unsigned int grid = std::max(4u, 1u << (levels - 1));
+	padding = roundUp(padding, grid);
+	unsigned int cells = options.pageSize / grid;
+
+	// stb_rect_pack works in grid cells, an image takes its size plus the gutter on both sides
+	std::vector<stbrp_rect> rects(images.size());
+	for (size_t i=0; i<images.size(); i++){
+		rects[i].id = (int)i;
+		rects[i].w = (stbrp_coord)(roundUp(images[i].width + padding * 2, grid) / grid);
+		rects[i].h = (stbrp_coord)(roundUp(images[i].height + padding * 2, grid) / grid);
+		rects[i].was_packed = 0;
+		if (rects[i].w > cells || rects[i].h > cells){
+			printf("%s (%ux%u with its gutter) does not fit a %u pixel atlas page\n", images[i].name.c_str(), images[i].width, images[i].height, options.pageSize);
+			return false;
+		}
+	}
+	out.placements.resize(images.size());
+
+	// a page at a time, whatever did not fit goes on the next one
+	std::vector<stbrp_node> nodes(cells);
+	std::vector<stbrp_rect> waiting = rects;
+	while (!waiting.empty()){
+		stbrp_context context;
+		stbrp_init_target(&context, cells, cells, &nodes[0], (int)nodes.size());
+		stbrp_pack_rects(&context, &waiting[0], (int)waiting.size());
+
+		unsigned int page = (unsigned int)out.pages.size();
+		std::vector<unsigned char> pixels((size_t)options.pageSize * options.pageSize * 4, 0);
+		std::vector<stbrp_rect> left;
+		for (size_t i=0; i<waiting.size(); i++){
+			if (!waiting[i].was_packed){
+				left.push_back(waiting[i]);
+				continue;
+			}
+			const AtlasImage & image = images[waiting[i].id];
+			AtlasPlacement & placement = out.placements[waiting[i].id];
+			placement.name = image.name;
+			placement.page = page;
+			placement.x = waiting[i].x * grid + padding;
+			placement.y = waiting[i].y * grid + padding;
+			placement.width = image.width;
+			placement.height = image.height;
+			placement.uvScale[0] = (float)image.width / options.pageSize;
+			placement.uvScale[1] = (float)image.height / options.pageSize;
+			placement.uvOffset[0] = (float)placement.x / options.pageSize;
+			placement.uvOffset[1] = (float)placement.y / options.pageSize;
+			blitWithGutter(image, placement, waiting[i], grid, options.pageSize, &pixels[0]);
+		}
+
+		// the pages filter like every other texture (Mitchell in linear light), cut to the levels the gutters keep apart
+		out.pages.push_back(TextureImage());
+		if (levels > 1)
+			generateMipChain(&pixels[0], options.pageSize, options.pageSize, MipChainOptions(), out.pages.back());
+		else
+			singleLevelImage(&pixels[0], options.pageSize, options.pageSize, out.pages.back());
+		TextureImage & chain = out.pages.back();
+		if (chain.levels.size() > levels){
+			chain.data.resize(chain.levels[levels].offset);
+			chain.levels.resize(levels);
+		}
+		waiting.swap(left);
+	}
+	return true;
+}
+
+void rewriteAtlasUVs(float * uvs, size_t count, size_t stride, const AtlasPlacement & placement){
+	for (size_t i=0; i<count; i++, uvs += stride){
+		uvs[0] = placement.uvOffset[0] + placement.uvScale[0] * uvs[0];
+		uvs[1] = placement.uvOffset[1] + placement.uvScale[1] * uvs[1];
+	}
+}
+
+bool writeAtlasManifest(const char * path, const TextureAtlas & atlas, const std::vector<std::string> & page_files){
+	FILE * file = fopen(path, "w");
+	if (file == NULL){
+		printf("%s could not be written\n", path);
+		return false;
+	}
+	for (size_t i=0; i<atlas.pages.size(); i++)
+		fprintf(file, "page %u %s %u %u\n", (unsigned int)i, page_files[i].c_str(), atlas.pages[i].width, atlas.pages[i].height);
+	for (size_t i=0; i<atlas.placements.size(); i++){
+		const AtlasPlacement & p = atlas.placements[i];
+		fprintf(file, "image %s %u %u %u %u %u\n", p.name.c_str(), p.page, p.x, p.y, p.width, p.height);
+	}
+	return fclose(file) == 0;
+}
+
+bool readAtlasManifest(const char * path, std::vector<std::string> & page_files, std::vector<AtlasPlacement> & placements){
+	PROFILE_SCOPE("read atlas manifest");
+	page_files.clear();
+	placements.clear();
+	FILE * file = fopen(path, "r");
+	if (file == NULL)
+		return false;
+	std::string directory(path);
+	size_t slash = directory.find_last_of("/\\");
+	directory = slash == std::string::npos ? std::string() : directory.substr(0, slash + 1);
+
+	std::vector<unsigned int> sizes; // width and height of every page
+	char line[1024], name[512];
+	unsigned int index, width, height;
+	bool ok = true;
+	int number = 0;
+	while (ok && fgets(line, sizeof(line), file)){
+		number++;
+		AtlasPlacement p;
+		if (sscanf(line, "page %u %511s %u %u", &index, name, &width, &height) == 4 && index == page_files.size()){
+			page_files.push_back(strpbrk(name, "/\\") ? std::string(name) : directory + name);
+			sizes.push_back(width);
+			sizes.push_back(height);
+		}
+		else if (sscanf(line, "image %511s %u %u %u %u %u", name, &p.page, &p.x, &p.y, &p.width, &p.height) == 6 && p.page < page_files.size()){
+			p.name = name;
+			p.uvScale[0] = (float)p.width / sizes[p.page * 2];
+			p.uvScale[1] = (float)p.height / sizes[p.page * 2 + 1];
+			p.uvOffset[0] = (float)p.x / sizes[p.page * 2];
+			p.uvOffset[1] = (float)p.y / sizes[p.page * 2 + 1];
+			placements.push_back(p);
+		}
+		else if (line[strspn(line, " \t\r\n")] != 0){
+			printf("%s:%d : expected a page or an image line\n", path, number);
+			ok = false;
+		}
+	}
+	fclose(file);
+	return ok;
+}
+
+const AtlasPlacement * findAtlasPlacement(const std::vector<AtlasPlacement> & placements, const char * name){
+	for (size_t i=0; i<placements.size(); i++)
+		if (placements[i].name == name)
+			return &placements[i];
+	return NULL;
+}
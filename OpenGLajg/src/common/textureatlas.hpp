@@ -0,0 +1,61 @@
+#ifndef TEXTUREATLAS_HPP
+#define TEXTUREATLAS_HPP
+
+#include <vector>
+#include <string>
+
+#include "texturefile.hpp"
+
+// Texture atlases : many small part textures packed into a few square pages with the bundled
+// stb_rect_pack, so every part of the car samples one texture. Each image sits on a grid of
+// 2^(levels-1) pixels inside a gutter of repeated edge pixels, which keeps its footprint whole
+// (and off the 4x4 blocks of its neighbours) down the mip chain. A part keeps its own 0..1 UVs
+// and a scale and offset into its page, applied per draw or baked into the mesh.
+// tools/atlaspack writes the pages next to a text manifest:
+//   page <index> <file> <width> <height>
+//   image <name> <page> <x> <y> <width> <height>   pixels of the image itself, without the gutter
+
+struct AtlasImage {
+	std::string name;
+	unsigned int width;
+	unsigned int height;
+	const unsigned char * rgba; // rows in the order the pages should store them
+};
+
+struct AtlasPlacement {
+	std::string name;
+	unsigned int page;
+	unsigned int x, y; // the image without its gutter
+	unsigned int width, height;
+	float uvScale[2];  // page uv = uvOffset + uvScale * part uv
+	float uvOffset[2];
+};
+
+struct AtlasOptions {
+	unsigned int pageSize; // pixels, square pages
+	unsigned int padding;  // gutter pixels on every side of an image at level 0
+	unsigned int levels;   // mip levels of the pages, 0 for as many as the padding keeps apart
+	AtlasOptions();
+};
+
+struct TextureAtlas {
+	std::vector<TextureImage> pages; // RGBA8 with their mip chains
+	std::vector<AtlasPlacement> placements; // in the order of the images
+};
+
+// levels where every image still has at least one gutter pixel : log2(padding) + 1
+unsigned int atlasMipLevels(unsigned int padding);
+
+// false when an image (with its gutter) is larger than a page
+bool packAtlas(const std::vector<AtlasImage> & images, const AtlasOptions & options, TextureAtlas & out);
+
+// moves count uv pairs, stride floats apart, into the placement : for meshes that are only ever
+// drawn with the atlas
+void rewriteAtlasUVs(float * uvs, size_t count, size_t stride, const AtlasPlacement & placement);
+
+bool writeAtlasManifest(const char * path, const TextureAtlas & atlas, const std::vector<std::string> & page_files);
+// page files come back relative to the manifest's directory when they were written as bare names
+bool readAtlasManifest(const char * path, std::vector<std::string> & page_files, std::vector<AtlasPlacement> & placements);
+const AtlasPlacement * findAtlasPlacement(const std::vector<AtlasPlacement> & placements, const char * name);
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+#include "texturecook.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+double millisecondsSince(std::chrono::high_resolution_clock::time_point start){
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// one row of blocks of one level, the unit of work of compressTexture
+struct BlockRow {
+	unsigned int level;
+	unsigned int y; // in blocks
+};
+
+void compressBlockRow(const TextureImage & rgba, TextureImage & out, const BlockRow & row, bool alpha, int mode){
+	const TextureLevel & source = rgba.levels[row.level];
+	const TextureLevel & target = out.levels[row.level];
+	const unsigned char * pixels = &rgba.data[source.offset];
+	unsigned int blocks = (source.width + 3) / 4;
+	size_t blockBytes = alpha ? 16 : 8;
+	unsigned char * dest = &out.data[target.offset] + blockBytes * blocks * row.y;
+	unsigned char block[64];
+	for (unsigned int bx=0; bx<blocks; bx++, dest += blockBytes){
+		for (unsigned int y=0; y<4; y++){
+			unsigned int sy = std::min(row.y * 4 + y, source.height - 1);
+			for (unsigned int x=0; x<4; x++){
+				unsigned int sx = std::min(bx * 4 + x, source.width - 1);
+				memcpy(block + (y * 4 + x) * 4, pixels + ((size_t)sy * source.width + sx) * 4, 4);
+			}
+		}
+		stb_compress_dxt_block(dest, block, alpha ? 1 : 0, mode);
+	}
+}
+
+} // namespace
+
+TextureCookOptions::TextureCookOptions()
+	: mips(true), alpha(-1), highQuality(false), flip(true), threads(0)
+{
+}
+
+void singleLevelImage(const unsigned char * rgba, unsigned int width, unsigned int height, TextureImage & out){
+	out.format = TEXTURE_RGBA8;
+	out.width = width;
+	out.height = height;
+	out.levels.clear();
+	out.data.clear();
+	memcpy(addTextureLevel(out, width, height), rgba, textureLevelSize(TEXTURE_RGBA8, width, height));
+}
+
+void compressTexture(const TextureImage & rgba, unsigned int format, bool high_quality, unsigned int threads, TextureImage & out){
+	PROFILE_SCOPE("compress texture");
+	out.format = format;
+	out.width = rgba.width;
+	out.height = rgba.height;
+	out.levels.clear();
+	out.data.clear();
+	std::vector<BlockRow> rows;
+	for (unsigned int i=0; i<rgba.levels.size(); i++){
+		addTextureLevel(out, rgba.levels[i].width, rgba.levels[i].height);
+		for (unsigned int y=0; y<(rgba.levels[i].height + 3) / 4; y++){
+			BlockRow row = { i, y };
+			rows.push_back(row);
+		}
+	}
+
+	// the threads take rows in order from a shared counter, small levels at the end even the load out
+	bool alpha = format == TEXTURE_BC3;
+	int mode = high_quality ? STB_DXT_HIGHQUAL : STB_DXT_NORMAL;
+	std::atomic<size_t> next(0);
+	auto work = [&](){
+		for (size_t i = next++; i < rows.size(); i = next++)
+			compressBlockRow(rgba, out, rows[i], alpha, mode);
+	};
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = (unsigned int)std::min<size_t>(threads, rows.size());
+	std::vector<std::thread> workers;
+	for (unsigned int i=1; i<threads; i++)
+		workers.push_back(std::thread(work));
+	work();
+	for (size_t i=0; i<workers.size(); i++)
+		workers[i].join();
+}
+
+bool cookTexture(const char * source_path, const char * output_path, const TextureCookOptions & options, TextureCookStats * stats){
+	PROFILE_SCOPE("cook texture");
+	TextureCookStats cooked;
+	memset(&cooked, 0, sizeof(cooked));
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	int width, height, channels;
+	unsigned char * pixels = stbi_load(source_path, &width, &height, &channels, 4);
+	if (pixels == NULL){
+		printf("%s could not be decoded : %s\n", source_path, stbi_failure_reason());
+		return false;
+	}
+	// stbi_set_flip_vertically_on_load is a global, the rows are flipped here instead
+	if (options.flip)
+		flipImageRows(pixels, (size_t)width * 4, height);
+	unsigned int format = options.alpha == 1 ? TEXTURE_BC3 : TEXTURE_BC1;
+	if (options.alpha < 0){
+		for (size_t i=3; i<(size_t)width * height * 4; i += 4){
+			if (pixels[i] != 255){
+				format = TEXTURE_BC3;
+				break;
+			}
+		}
+	}
+	cooked.decodeMs = millisecondsSince(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	TextureImage chain;
+	if (options.mips)
+		generateMipChain(pixels, width, height, options.mipChain, chain);
+	else
+		singleLevelImage(pixels, width, height, chain);
+	stbi_image_free(pixels);
+	cooked.mipMs = millisecondsSince(start);
+
+	start = std::chrono::high_resolution_clock::now();
+	TextureImage compressed;
+	compressTexture(chain, format, options.highQuality, options.threads, compressed);
+	cooked.compressMs = millisecondsSince(start);
+
+	cooked.format = format;
+	cooked.levels = (unsigned int)compressed.levels.size();
+	cooked.sourceBytes = chain.data.size();
+	cooked.cookedBytes = compressed.data.size();
+	if (stats)
+		*stats = cooked;
+	return writeTextureFile(output_path, compressed);
+}
@@ -0,0 +1,41 @@
+#ifndef TEXTURECOOK_HPP
+#define TEXTURECOOK_HPP
+
+#include "texturefile.hpp"
+#include "imageresize.hpp"
+
+// CPU side of tools/texcook : mip chains of RGBA8 images and BC1 / BC3 block compression
+// with the bundled stb_dxt, spread over threads by rows of blocks
+
+struct TextureCookOptions {
+	bool mips;            // a full chain down to 1x1
+	MipChainOptions mipChain; // filter of the chain, linear light for colour
+	int alpha;            // -1 picks BC3 only when some pixel is not opaque, 0 forces BC1, 1 forces BC3
+	bool highQuality;     // STB_DXT_HIGHQUAL refinement, ~30% slower
+	bool flip;            // store the rows bottom first, the way TextureStreamer loads the sources by default
+	unsigned int threads; // 0 for one per core
+	TextureCookOptions();
+};
+
+// what cookTexture did, the VRAM figures count the whole chain
+struct TextureCookStats {
+	unsigned int format;
+	unsigned int levels;
+	size_t sourceBytes; // the source as the runtime uploads it : RGBA8 with a generated chain
+	size_t cookedBytes;
+	double decodeMs;
+	double mipMs;         // threads and filter as in options.mipChain
+	double compressMs;
+};
+
+// RGBA8 image of the single level copied from rgba, for images without mips. the chains of
+// cookTexture and packAtlas come from generateMipChain
+void singleLevelImage(const unsigned char * rgba, unsigned int width, unsigned int height, TextureImage & out);
+
+// BC1 or BC3 copy of every level of an RGBA8 image, edge blocks are padded by repeating the last row and column
+void compressTexture(const TextureImage & rgba, unsigned int format, bool high_quality, unsigned int threads, TextureImage & out);
+
+// source image (anything stb_image reads) to a DDS or KTX file by extension
+bool cookTexture(const char * source_path, const char * output_path, const TextureCookOptions & options, TextureCookStats * stats = NULL);
+
+#endif
@@ -0,0 +1,540 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "texturefile.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+const unsigned int DDS_MAGIC = 0x20534444; // "DDS "
+const unsigned int FOURCC_DXT1 = 0x31545844;
+const unsigned int FOURCC_DXT5 = 0x35545844;
+
+// DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT, plus the size flag
+const unsigned int DDSD_BASE = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+const unsigned int DDSD_PITCH = 0x8;
+const unsigned int DDSD_LINEARSIZE = 0x80000;
+const unsigned int DDPF_ALPHAPIXELS = 0x1;
+const unsigned int DDPF_FOURCC = 0x4;
+const unsigned int DDPF_RGB = 0x40;
+const unsigned int DDSCAPS_COMPLEX = 0x8;
+const unsigned int DDSCAPS_TEXTURE = 0x1000;
+const unsigned int DDSCAPS_MIPMAP = 0x400000;
+
+struct DDSPixelFormat {
+	unsigned int size;
+	unsigned int flags;
+	unsigned int fourCC;
+	unsigned int rgbBitCount;
+	unsigned int rMask, gMask, bMask, aMask;
+};
+
+struct DDSHeader {
+	unsigned int size; // 124
+	unsigned int flags;
+	unsigned int height;
+	unsigned int width;
+	unsigned int pitchOrLinearSize;
+	unsigned int depth;
+	unsigned int mipMapCount;
+	unsigned int reserved1[11];
+	DDSPixelFormat format;
+	unsigned int caps, caps2, caps3, caps4;
+	unsigned int reserved2;
+};
+
+const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+const unsigned int KTX_ENDIANNESS = 0x04030201;
+
+struct KTXHeader {
+	unsigned char identifier[12];
+	unsigned int endianness;
+	unsigned int glType;     // 0 for compressed formats
+	unsigned int glTypeSize;
+	unsigned int glFormat;   // 0 for compressed formats
+	unsigned int glInternalFormat;
+	unsigned int glBaseInternalFormat;
+	unsigned int pixelWidth;
+	unsigned int pixelHeight;
+	unsigned int pixelDepth;
+	unsigned int numberOfArrayElements;
+	unsigned int numberOfFaces;
+	unsigned int numberOfMipmapLevels;
+	unsigned int bytesOfKeyValueData;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "the DDS header layout is part of the file format");
+static_assert(sizeof(KTXHeader) == 64, "the KTX header layout is part of the file format");
+
+bool writableFormat(unsigned int format){
+	return format == TEXTURE_RGBA8 || format == TEXTURE_BC1 || format == TEXTURE_BC3;
+}
+
+const unsigned int PIXEL_UNSIGNED_BYTE = 0x1401;
+const unsigned int PIXEL_HALF_FLOAT = 0x140B;
+const unsigned int PIXEL_RED = 0x1903;
+const unsigned int PIXEL_RG = 0x8227;
+const unsigned int PIXEL_RGB = 0x1907;
+const unsigned int PIXEL_RGBA = 0x1908;
+const unsigned int PIXEL_BGR = 0x80E0;
+const unsigned int PIXEL_BGRA = 0x80E1;
+
+struct FormatInfo {
+	unsigned int format;
+	unsigned int pixelFormat; // 0 for block formats
+	unsigned int pixelType;
+	unsigned int bytes;       // per pixel, or per 4x4 block
+};
+
+const FormatInfo FORMATS[] = {
+	{ TEXTURE_R8, PIXEL_RED, PIXEL_UNSIGNED_BYTE, 1 },
+	{ TEXTURE_RG8, PIXEL_RG, PIXEL_UNSIGNED_BYTE, 2 },
+	{ TEXTURE_RGB8, PIXEL_RGB, PIXEL_UNSIGNED_BYTE, 3 },
+	{ TEXTURE_RGBA8, PIXEL_RGBA, PIXEL_UNSIGNED_BYTE, 4 },
+	{ TEXTURE_SRGB8_ALPHA8, PIXEL_RGBA, PIXEL_UNSIGNED_BYTE, 4 },
+	{ TEXTURE_RGBA16F, PIXEL_RGBA, PIXEL_HALF_FLOAT, 8 },
+	{ TEXTURE_BC1, 0, 0, 8 },
+	{ TEXTURE_BC1_SRGB, 0, 0, 8 },
+	{ TEXTURE_BC2, 0, 0, 16 },
+	{ TEXTURE_BC2_SRGB, 0, 0, 16 },
+	{ TEXTURE_BC3, 0, 0, 16 },
+	{ TEXTURE_BC3_SRGB, 0, 0, 16 },
+	{ TEXTURE_BC4, 0, 0, 8 },
+	{ TEXTURE_BC5, 0, 0, 16 },
+	{ TEXTURE_BC7, 0, 0, 16 },
+	{ TEXTURE_BC7_SRGB, 0, 0, 16 }
+};
+
+const FormatInfo * findFormat(unsigned int format){
+	for (size_t i=0; i<sizeof(FORMATS) / sizeof(FORMATS[0]); i++)
+		if (FORMATS[i].format == format)
+			return &FORMATS[i];
+	return NULL;
+}
+
+unsigned int fourCC(const char * code){
+	return (unsigned int)(unsigned char)code[0] | (unsigned int)(unsigned char)code[1] << 8
+		| (unsigned int)(unsigned char)code[2] << 16 | (unsigned int)(unsigned char)code[3] << 24;
+}
+
+// the levels a full chain of this size has
+unsigned int maxLevels(unsigned int width, unsigned int height){
+	unsigned int levels = 1;
+	for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+		levels++;
+	return levels;
+}
+
+// bytes of one image with its rows padded to alignment
+size_t imageSize(const FormatInfo & info, unsigned int width, unsigned int height, unsigned int alignment){
+	if (!info.pixelFormat)
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * info.bytes;
+	size_t row = ((size_t)width * info.bytes + alignment - 1) / alignment * alignment;
+	return row * height;
+}
+
+const unsigned int DDS_HEADER_FLAGS_MIPMAPCOUNT = 0x20000;
+const unsigned int DDPF_LUMINANCE = 0x20000;
+const unsigned int DDSCAPS2_CUBEMAP = 0x200;
+const unsigned int DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+const unsigned int DDSCAPS2_VOLUME = 0x200000;
+const unsigned int DDS_DIMENSION_TEXTURE2D = 3;
+const unsigned int DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+struct DDSHeaderDX10 {
+	unsigned int dxgiFormat;
+	unsigned int resourceDimension;
+	unsigned int miscFlag;
+	unsigned int arraySize;
+	unsigned int miscFlags2;
+};
+
+static_assert(sizeof(DDSHeaderDX10) == 20, "the DX10 header layout is part of the file format");
+
+unsigned int formatFromDXGI(unsigned int dxgi, unsigned int & pixelFormat){
+	switch (dxgi){
+	case 28: return TEXTURE_RGBA8;
+	case 29: return TEXTURE_SRGB8_ALPHA8;
+	case 87: pixelFormat = PIXEL_BGRA; return TEXTURE_RGBA8;
+	case 91: pixelFormat = PIXEL_BGRA; return TEXTURE_SRGB8_ALPHA8;
+	case 10: return TEXTURE_RGBA16F;
+	case 49: return TEXTURE_RG8;
+	case 61: return TEXTURE_R8;
+	case 71: return TEXTURE_BC1;
+	case 72: return TEXTURE_BC1_SRGB;
+	case 74: return TEXTURE_BC2;
+	case 75: return TEXTURE_BC2_SRGB;
+	case 77: return TEXTURE_BC3;
+	case 78: return TEXTURE_BC3_SRGB;
+	case 80: return TEXTURE_BC4;
+	case 83: return TEXTURE_BC5;
+	case 98: return TEXTURE_BC7;
+	case 99: return TEXTURE_BC7_SRGB;
+	default: return 0;
+	}
+}
+
+// the format of a legacy header, pixelFormat is changed for files stored in BGR(A) order
+unsigned int formatFromDDS(const DDSPixelFormat & format, unsigned int & pixelFormat){
+	if (format.flags & DDPF_FOURCC){
+		unsigned int code = format.fourCC;
+		if (code == fourCC("DXT1")) return TEXTURE_BC1;
+		if (code == fourCC("DXT2") || code == fourCC("DXT3")) return TEXTURE_BC2;
+		if (code == fourCC("DXT4") || code == fourCC("DXT5")) return TEXTURE_BC3;
+		if (code == fourCC("ATI1") || code == fourCC("BC4U")) return TEXTURE_BC4;
+		if (code == fourCC("ATI2") || code == fourCC("BC5U")) return TEXTURE_BC5;
+		return 0;
+	}
+	if ((format.flags & DDPF_RGB) && format.rgbBitCount == 32){
+		if (format.rMask == 0x000000ff && format.gMask == 0x0000ff00 && format.bMask == 0x00ff0000)
+			return TEXTURE_RGBA8;
+		if (format.rMask == 0x00ff0000 && format.gMask == 0x0000ff00 && format.bMask == 0x000000ff){
+			pixelFormat = PIXEL_BGRA;
+			return TEXTURE_RGBA8;
+		}
+	}
+	if ((format.flags & DDPF_RGB) && format.rgbBitCount == 24){
+		if (format.rMask == 0x000000ff && format.bMask == 0x00ff0000)
+			return TEXTURE_RGB8;
+		if (format.rMask == 0x00ff0000 && format.bMask == 0x000000ff){
+			pixelFormat = PIXEL_BGR;
+			return TEXTURE_RGB8;
+		}
+	}
+	if ((format.flags & DDPF_LUMINANCE) && format.rgbBitCount == 8)
+		return TEXTURE_R8;
+	return 0;
+}
+
+enum ParseResult { PARSE_OK, PARSE_CORRUPT, PARSE_UNSUPPORTED }; // unsupported files have been reported
+
+// every subresource takes at least as much as the smallest level, a layer count the rest of the
+// file cannot hold is corrupt before the subresource list is allocated for it
+bool subresourcesFit(const FormatInfo & info, const TextureView & view, size_t available){
+	size_t smallest = imageSize(info, std::max(1u, view.width >> (view.levels - 1)), std::max(1u, view.height >> (view.levels - 1)), view.rowAlignment);
+	unsigned long long count = (unsigned long long)view.levels * view.layers * view.faces;
+	return count <= available / std::max(smallest, (size_t)1);
+}
+
+// DDS keeps every level of a layer (and face) together : layer 0 levels 0..n, then layer 1...
+ParseResult parseDDS(const char * path, const unsigned char * data, size_t size, TextureView & view){
+	DDSHeader header;
+	if (size < 4 + sizeof(header))
+		return PARSE_CORRUPT;
+	memcpy(&header, data + 4, sizeof(header));
+	if (header.size != sizeof(header) || header.format.size != sizeof(DDSPixelFormat))
+		return PARSE_CORRUPT;
+	size_t offset = 4 + sizeof(header);
+	unsigned int pixelFormat = 0;
+	if ((header.format.flags & DDPF_FOURCC) && header.format.fourCC == fourCC("DX10")){
+		DDSHeaderDX10 dx10;
+		if (size < offset + sizeof(dx10))
+			return PARSE_CORRUPT;
+		memcpy(&dx10, data + offset, sizeof(dx10));
+		offset += sizeof(dx10);
+		if (dx10.resourceDimension != DDS_DIMENSION_TEXTURE2D){
+			printf("%s : only 2D DDS textures are read\n", path);
+			return PARSE_UNSUPPORTED;
+		}
+		view.format = formatFromDXGI(dx10.dxgiFormat, pixelFormat);
+		view.layers = std::max(1u, dx10.arraySize);
+		view.faces = (dx10.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) ? 6 : 1;
+		if (!view.format){
+			printf("%s : DXGI format %u is not supported\n", path, dx10.dxgiFormat);
+			return PARSE_UNSUPPORTED;
+		}
+	} else {
+		if (header.caps2 & DDSCAPS2_VOLUME){
+			printf("%s : volume textures are not supported\n", path);
+			return PARSE_UNSUPPORTED;
+		}
+		if ((header.caps2 & DDSCAPS2_CUBEMAP) && (header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES){
+			printf("%s : cube maps need all six faces\n", path);
+			return PARSE_UNSUPPORTED;
+		}
+		view.format = formatFromDDS(header.format, pixelFormat);
+		view.layers = 1;
+		view.faces = (header.caps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
+		if (!view.format){
+			printf("%s : DDS pixel format is not supported\n", path);
+			return PARSE_UNSUPPORTED;
+		}
+	}
+	const FormatInfo & info = *findFormat(view.format);
+	view.pixelFormat = pixelFormat ? pixelFormat : info.pixelFormat;
+	view.pixelType = info.pixelType;
+	view.rowAlignment = 1;
+	view.width = header.width;
+	view.height = header.height;
+	view.levels = (header.flags & DDS_HEADER_FLAGS_MIPMAPCOUNT) && header.mipMapCount ? header.mipMapCount : 1;
+	if (view.width == 0 || view.height == 0 || view.levels > maxLevels(view.width, view.height) || !subresourcesFit(info, view, size - offset))
+		return PARSE_CORRUPT;
+
+	view.subresources.resize((size_t)view.levels * view.layers * view.faces);
+	for (unsigned int layer=0; layer<view.layers; layer++){
+		for (unsigned int face=0; face<view.faces; face++){
+			for (unsigned int level=0; level<view.levels; level++){
+				TextureSubresource & image = view.subresources[((size_t)level * view.layers + layer) * view.faces + face];
+				image.width = std::max(1u, view.width >> level);
+				image.height = std::max(1u, view.height >> level);
+				image.size = imageSize(info, image.width, image.height, 1);
+				if (image.size > size - offset)
+					return PARSE_CORRUPT;
+				image.data = data + offset;
+				offset += image.size;
+			}
+		}
+	}
+	return PARSE_OK;
+}
+
+// KTX keeps every layer and face of a level together, each level behind its imageSize
+ParseResult parseKTX(const char * path, const unsigned char * data, size_t size, TextureView & view){
+	KTXHeader header;
+	if (size < sizeof(header))
+		return PARSE_CORRUPT;
+	memcpy(&header, data, sizeof(header));
+	if (header.endianness != KTX_ENDIANNESS){
+		printf("%s : big endian KTX files are not supported\n", path);
+		return PARSE_UNSUPPORTED;
+	}
+	const FormatInfo * info = findFormat(header.glInternalFormat);
+	if (info == NULL || header.pixelDepth > 1){
+		printf("%s : only 2D KTX textures in a supported format are read\n", path);
+		return PARSE_UNSUPPORTED;
+	}
+	if (info->pixelFormat && (header.glType != info->pixelType || (header.glFormat != info->pixelFormat && header.glFormat != PIXEL_BGRA && header.glFormat != PIXEL_BGR))){
+		printf("%s : KTX format and type do not match the internal format\n", path);
+		return PARSE_UNSUPPORTED;
+	}
+	view.format = header.glInternalFormat;
+	view.pixelFormat = info->pixelFormat ? header.glFormat : 0;
+	view.pixelType = info->pixelType;
+	view.rowAlignment = 4;
+	view.width = header.pixelWidth;
+	view.height = std::max(1u, header.pixelHeight);
+	view.levels = std::max(1u, header.numberOfMipmapLevels);
+	view.layers = std::max(1u, header.numberOfArrayElements);
+	view.faces = header.numberOfFaces;
+	if (view.width == 0 || (view.faces != 1 && view.faces != 6) || view.levels > maxLevels(view.width, view.height))
+		return PARSE_CORRUPT;
+	// a non array cube map gives the size of one face and pads every face
+	bool cube = view.faces == 6 && header.numberOfArrayElements == 0;
+
+	size_t offset = sizeof(header);
+	if (header.bytesOfKeyValueData > size - offset)
+		return PARSE_CORRUPT;
+	offset += header.bytesOfKeyValueData;
+	if (!subresourcesFit(*info, view, size - offset))
+		return PARSE_CORRUPT;
+	view.subresources.resize((size_t)view.levels * view.layers * view.faces);
+	for (unsigned int level=0; level<view.levels; level++){
+		unsigned int width = std::max(1u, view.width >> level), height = std::max(1u, view.height >> level);
+		size_t faceSize = imageSize(*info, width, height, 4);
+		unsigned int declared;
+		if (size - offset < 4)
+			return PARSE_CORRUPT;
+		memcpy(&declared, data + offset, 4);
+		offset += 4;
+		if (declared != (cube ? faceSize : faceSize * view.layers * view.faces))
+			return PARSE_CORRUPT;
+		for (unsigned int layer=0; layer<view.layers; layer++){
+			for (unsigned int face=0; face<view.faces; face++){
+				TextureSubresource & image = view.subresources[((size_t)level * view.layers + layer) * view.faces + face];
+				image.width = width;
+				image.height = height;
+				image.size = faceSize;
+				if (faceSize > size - offset)
+					return PARSE_CORRUPT;
+				image.data = data + offset;
+				offset += faceSize;
+				if (cube)
+					offset = (offset + 3) & ~(size_t)3;
+			}
+		}
+		offset = (offset + 3) & ~(size_t)3;
+		if (offset > size)
+			return PARSE_CORRUPT;
+	}
+	return PARSE_OK;
+}
+
+} // namespace
+
+bool textureFormatCompressed(unsigned int format){
+	const FormatInfo * info = findFormat(format);
+	return info && !info->pixelFormat;
+}
+
+unsigned int textureFormatBytes(unsigned int format){
+	const FormatInfo * info = findFormat(format);
+	return info ? info->bytes : 0;
+}
+
+size_t textureLevelSize(unsigned int format, unsigned int width, unsigned int height){
+	const FormatInfo * info = findFormat(format);
+	return info ? imageSize(*info, width, height, 1) : 0;
+}
+
+unsigned char * addTextureLevel(TextureImage & image, unsigned int width, unsigned int height){
+	TextureLevel level;
+	level.width = width;
+	level.height = height;
+	level.offset = image.data.size();
+	level.size = textureLevelSize(image.format, width, height);
+	image.levels.push_back(level);
+	image.data.resize(level.offset + level.size);
+	return &image.data[level.offset];
+}
+
+void flipImageRows(unsigned char * pixels, size_t row_bytes, unsigned int rows){
+	std::vector<unsigned char> row(row_bytes);
+	for (unsigned int y=0; y<rows/2; y++){
+		unsigned char * top = pixels + row_bytes * y;
+		unsigned char * bottom = pixels + row_bytes * (rows - 1 - y);
+		memcpy(&row[0], top, row_bytes);
+		memcpy(top, bottom, row_bytes);
+		memcpy(bottom, &row[0], row_bytes);
+	}
+}
+
+bool writeDDS(const char * path, const TextureImage & image){
+	if (!writableFormat(image.format) || image.levels.empty())
+		return false;
+	DDSHeader header;
+	memset(&header, 0, sizeof(header));
+	header.size = sizeof(header);
+	header.height = image.height;
+	header.width = image.width;
+	header.mipMapCount = (unsigned int)image.levels.size();
+	header.format.size = sizeof(header.format);
+	if (textureFormatCompressed(image.format)){
+		header.flags = DDSD_BASE | DDSD_LINEARSIZE;
+		header.pitchOrLinearSize = (unsigned int)image.levels[0].size;
+		header.format.flags = DDPF_FOURCC;
+		header.format.fourCC = image.format == TEXTURE_BC1 ? FOURCC_DXT1 : FOURCC_DXT5;
+	} else {
+		header.flags = DDSD_BASE | DDSD_PITCH;
+		header.pitchOrLinearSize = image.width * 4;
+		header.format.flags = DDPF_RGB | DDPF_ALPHAPIXELS;
+		header.format.rgbBitCount = 32;
+		header.format.rMask = 0x000000ff;
+		header.format.gMask = 0x0000ff00;
+		header.format.bMask = 0x00ff0000;
+		header.format.aMask = 0xff000000;
+	}
+	header.caps = DDSCAPS_TEXTURE | (image.levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	FILE * file = fopen(path, "wb");
+	if (file == NULL){
+		printf("%s could not be written\n", path);
+		return false;
+	}
+	bool ok = fwrite(&DDS_MAGIC, 4, 1, file) == 1 && fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && fwrite(&image.data[0], 1, image.data.size(), file) == image.data.size();
+	ok = fclose(file) == 0 && ok;
+	if (!ok)
+		printf("%s could not be written\n", path);
+	return ok;
+}
+
+bool writeKTX(const char * path, const TextureImage & image){
+	if (!writableFormat(image.format) || image.levels.empty())
+		return false;
+	KTXHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+	header.endianness = KTX_ENDIANNESS;
+	if (textureFormatCompressed(image.format)){
+		header.glTypeSize = 1;
+		header.glBaseInternalFormat = image.format == TEXTURE_BC1 ? 0x1907 : 0x1908; // GL_RGB, GL_RGBA
+	} else {
+		header.glType = 0x1401; // GL_UNSIGNED_BYTE
+		header.glTypeSize = 1;
+		header.glFormat = 0x1908;
+		header.glBaseInternalFormat = 0x1908;
+	}
+	header.glInternalFormat = image.format;
+	header.pixelWidth = image.width;
+	header.pixelHeight = image.height;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = (unsigned int)image.levels.size();
+
+	FILE * file = fopen(path, "wb");
+	if (file == NULL){
+		printf("%s could not be written\n", path);
+		return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	static const unsigned char padding[3] = { 0, 0, 0 };
+	for (size_t i=0; i<image.levels.size() && ok; i++){
+		const TextureLevel & level = image.levels[i];
+		unsigned int imageSize = (unsigned int)level.size;
+		ok = fwrite(&imageSize, 4, 1, file) == 1 && fwrite(&image.data[level.offset], 1, level.size, file) == level.size;
+		size_t pad = (4 - level.size % 4) % 4; // mip padding, levels start on 4 bytes
+		ok = ok && (pad == 0 || fwrite(padding, 1, pad, file) == pad);
+	}
+	ok = fclose(file) == 0 && ok;
+	if (!ok)
+		printf("%s could not be written\n", path);
+	return ok;
+}
+
+bool writeTextureFile(const char * path, const TextureImage & image){
+	size_t length = strlen(path);
+	if (length > 4 && (strcmp(path + length - 4, ".ktx") == 0 || strcmp(path + length - 4, ".KTX") == 0))
+		return writeKTX(path, image);
+	return writeDDS(path, image);
+}
+
+std::string cookedTexturePath(const char * source_path){
+	std::string path = source_path;
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+		path.erase(dot);
+	return path + ".dds";
+}
+
+bool isTextureContainer(const char * path){
+	size_t length = strlen(path);
+	if (length < 4)
+		return false;
+	char extension[5];
+	for (int i=0; i<4; i++)
+		extension[i] = (char)tolower((unsigned char)path[length - 4 + i]);
+	extension[4] = 0;
+	return strcmp(extension, ".dds") == 0 || strcmp(extension, ".ktx") == 0;
+}
+
+bool TextureFile::open(const char * path){
+	PROFILE_SCOPE("open texture file");
+	close();
+	if (!file.open(path))
+		return false;
+	const unsigned char * data = file.data();
+	size_t size = file.size();
+	ParseResult result;
+	if (size >= 4 && memcmp(data, &DDS_MAGIC, 4) == 0)
+		result = parseDDS(path, data, size, texture);
+	else if (size >= sizeof(KTX_IDENTIFIER) && memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) == 0)
+		result = parseKTX(path, data, size, texture);
+	else {
+		printf("%s is not a DDS or KTX file\n", path);
+		result = PARSE_UNSUPPORTED;
+	}
+	if (result == PARSE_CORRUPT)
+		printf("%s is truncated or corrupt\n", path);
+	if (result != PARSE_OK)
+		close();
+	return result == PARSE_OK;
+}
+
+void TextureFile::close(){
+	file.close();
+	texture = TextureView();
+}
@@ -0,0 +1,115 @@
+#ifndef TEXTUREFILE_HPP
+#define TEXTUREFILE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <string>
+
+#include "mappedfile.hpp"
+
+// Texture containers : DDS (legacy header or DX10 extension) and KTX 1.1. TextureFile maps the
+// file and points every mip level of every array layer and cube face into the mapping, with
+// offsets worked out from the header, so levels go to GL without being copied or over-read.
+// tools/texcook writes both from a TextureImage, bottom row first, the order glTexImage2D takes.
+
+// internal formats use the OpenGL enum values (EXT_texture_compression_s3tc and EXT_texture_sRGB
+// for the S3TC block formats), so they go to glCompressedTexImage2D / glTexImage2D as they are
+enum TextureFormat {
+	TEXTURE_R8 = 0x8229,
+	TEXTURE_RG8 = 0x822B,
+	TEXTURE_RGB8 = 0x8051,
+	TEXTURE_RGBA8 = 0x8058,
+	TEXTURE_SRGB8_ALPHA8 = 0x8C43,
+	TEXTURE_RGBA16F = 0x881A,
+	TEXTURE_BC1 = 0x83F0,      // COMPRESSED_RGB_S3TC_DXT1_EXT
+	TEXTURE_BC1_SRGB = 0x8C4C, // COMPRESSED_SRGB_S3TC_DXT1_EXT
+	TEXTURE_BC2 = 0x83F2,      // COMPRESSED_RGBA_S3TC_DXT3_EXT
+	TEXTURE_BC2_SRGB = 0x8C4E,
+	TEXTURE_BC3 = 0x83F3,      // COMPRESSED_RGBA_S3TC_DXT5_EXT
+	TEXTURE_BC3_SRGB = 0x8C4F,
+	TEXTURE_BC4 = 0x8DBB,      // COMPRESSED_RED_RGTC1
+	TEXTURE_BC5 = 0x8DBD,      // COMPRESSED_RG_RGTC2
+	TEXTURE_BC7 = 0x8E8C,      // COMPRESSED_RGBA_BPTC_UNORM
+	TEXTURE_BC7_SRGB = 0x8E8D
+};
+
+// one 2D image of a container : a mip level of one array layer and cube face
+struct TextureSubresource {
+	unsigned int width;
+	unsigned int height;
+	const unsigned char * data;
+	size_t size;
+};
+
+// what a texture file holds, pointing into the mapping of a TextureFile
+struct TextureView {
+	unsigned int format;      // TextureFormat
+	unsigned int pixelFormat; // glTexImage2D format and type for uncompressed formats (GL_BGRA for
+	unsigned int pixelType;   // B8G8R8A8 files), 0 for block formats
+	unsigned int rowAlignment; // GL_UNPACK_ALIGNMENT of the rows : 4 in KTX, 1 in DDS
+	unsigned int width;
+	unsigned int height;
+	unsigned int levels;
+	unsigned int layers;
+	unsigned int faces;       // 6 for cube maps, in +x -x +y -y +z -z order
+	std::vector<TextureSubresource> subresources; // by (level * layers + layer) * faces + face
+
+	const TextureSubresource & at(unsigned int level, unsigned int layer = 0, unsigned int face = 0) const {
+		return subresources[((size_t)level * layers + layer) * faces + face];
+	}
+};
+
+// an owned image with a mip chain, what tools/texcook builds and writes
+struct TextureLevel {
+	unsigned int width;
+	unsigned int height;
+	size_t offset; // into TextureImage::data
+	size_t size;
+};
+
+struct TextureImage {
+	unsigned int format; // TextureFormat
+	unsigned int width;
+	unsigned int height;
+	std::vector<TextureLevel> levels;
+	std::vector<unsigned char> data;
+};
+
+bool textureFormatCompressed(unsigned int format);
+// bytes per 4x4 block for block formats, per pixel otherwise, 0 for formats we do not know
+unsigned int textureFormatBytes(unsigned int format);
+// bytes of one image with tightly packed rows, 4x4 blocks for the compressed formats
+size_t textureLevelSize(unsigned int format, unsigned int width, unsigned int height);
+// appends a level of the given size to image.levels and image.data, returns its bytes
+unsigned char * addTextureLevel(TextureImage & image, unsigned int width, unsigned int height);
+
+// swaps the rows of an image upside down in place
+void flipImageRows(unsigned char * pixels, size_t row_bytes, unsigned int rows);
+
+// the writers take BC1, BC3 and RGBA8 images
+bool writeDDS(const char * path, const TextureImage & image);
+bool writeKTX(const char * path, const TextureImage & image);
+// the container follows the extension, .ktx or .dds
+bool writeTextureFile(const char * path, const TextureImage & image);
+
+// where tools/texcook puts the cooked version of a source image : the same path ending in .dds
+std::string cookedTexturePath(const char * source_path);
+// true for paths ending in .dds or .ktx, which go to TextureFile instead of an image decoder
+bool isTextureContainer(const char * path);
+
+// A mapped DDS or KTX file. 2D textures, arrays and cube maps (and cube map arrays) are read,
+// volume textures are not.
+class TextureFile {
+public:
+	TextureFile() { close(); }
+
+	bool open(const char * path);
+	void close();
+	const TextureView & view() const { return texture; }
+
+private:
+	MappedFile file;
+	TextureView texture;
+};
+
+#endif
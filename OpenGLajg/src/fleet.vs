@@ -0,0 +1,32 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aNormal;
+
+// a fleet of cars in one instanced draw per part (SkinArray.h) : each instance moves the part
+// by its own offset and samples its own layer of the skin array
+const int MAX_INSTANCES = 64;
+
+out vec2 TexCoord;
+out vec3 FragPos;
+out vec3 Normal;
+flat out float Layer;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
+uniform vec4 instances[MAX_INSTANCES]; // world space offset (xyz) and skin layer (w)
+
+void main()
+{
+	vec4 instance = instances[gl_InstanceID];
+	vec3 position = positionOffset + positionScale * aPos;
+	FragPos = vec3(model * vec4(position, 1.0)) + instance.xyz;
+	Normal = mat3(transpose(inverse(model))) * aNormal;
+	TexCoord = aTexCoord;
+	Layer = instance.w;
+
+	gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+in vec4 Color;
+in vec2 Corner;
+flat in int Kind;
+
+out vec4 FragColor;
+
+// the quads of PerfHud.h : 0 a color, 1 the panel color with the white text of its mask,
+// 2 and 3 the CPU and the GPU graph, a bar a frame cut to its height
+uniform sampler2D panel;
+uniform vec4 bars[60]; // PerfHud::HISTORY fractions of the graph for the CPU then for the GPU, 4 a vector
+
+void main()
+{
+	if (Kind == 1)
+		FragColor = mix(Color, vec4(1.0), texture(panel, Corner).r); // its first row is the top
+	else if (Kind >= 2)
+	{
+		int bar = (Kind - 2) * 120 + min(int(Corner.x * 120.0), 119);
+		if (1.0 - Corner.y > bars[bar / 4][bar % 4])
+			discard;
+		FragColor = Color;
+	}
+	else
+		FragColor = Color;
+}
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+
+// the performance overlay (PerfHud.h) : positions in overlay pixels from the top left corner,
+// scaled up on the way to the screen. aPos.z is what hud.fs does with the quad
+out vec4 Color;
+out vec2 Corner; // 0 to 1 across the quad from its top left
+flat out int Kind;
+
+uniform vec2 screenSize;
+uniform float scale = 2.0;
+
+void main()
+{
+	int corner = gl_VertexID % 4; // PerfHud's quads go top left, top right, bottom right, bottom left
+	Corner = vec2(corner == 1 || corner == 2 ? 1.0 : 0.0, corner >= 2 ? 1.0 : 0.0);
+	Kind = int(aPos.z + 0.5);
+	vec2 pixels = aPos.xy * scale;
+	gl_Position = vec4(pixels.x / screenSize.x * 2.0 - 1.0, 1.0 - pixels.y / screenSize.y * 2.0, 0.0, 1.0);
+	Color = aColor;
+}
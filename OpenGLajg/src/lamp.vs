@@ -4,8 +4,12 @@ layout (location = 0) in vec3 aPos;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+// quantized positions are relative to the mesh bounds
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	vec3 position = positionOffset + positionScale * aPos;
+	gl_Position = projection * view * model * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -4,11 +4,15 @@ layout (location = 0) in vec3 aPos;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+// quantized positions are relative to the mesh bounds
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
 
 uniform vec4 offset;
 uniform mat4 transform;
 
 void main()
 {
-    gl_Position = projection * view * model * (transform * vec4(aPos, 1.0) + offset);
+    vec3 position = positionOffset + positionScale * aPos;
+    gl_Position = projection * view * model * (transform * vec4(position, 1.0) + offset);
 }
\ No newline at end of file
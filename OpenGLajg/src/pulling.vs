@@ -0,0 +1,103 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+// vertex pulling (VertexPuller.h) : same outputs as vertex.vs, the attributes are decoded
+// from raw words with the layout of the mesh instead of coming from a VAO
+
+// GL type enums, as stored in the layouts
+const uint TYPE_UNSIGNED_BYTE = 0x1401u;
+const uint TYPE_UNSIGNED_SHORT = 0x1403u;
+const uint TYPE_FLOAT = 0x1406u;
+const uint TYPE_HALF_FLOAT = 0x140Bu;
+const uint TYPE_INT_2_10_10_10_REV = 0x8D9Fu;
+
+struct Attribute
+{
+	uint offset;     // words from the start of the vertex
+	uint type;       // 0 when the mesh has no such attribute
+	uint components;
+	uint normalized;
+};
+
+struct Layout
+{
+	vec4 positionScale;
+	vec4 positionOffset;
+	uint base;   // first word of the mesh
+	uint stride; // words per vertex
+	uint padding0;
+	uint padding1;
+	Attribute attributes[4]; // 0 position, 1 color, 2 uv, 3 normal
+};
+
+struct Draw
+{
+	mat4 model;
+	uint mesh; // index of the layout
+	uint padding0;
+	uint padding1;
+	uint padding2;
+	vec4 uvTransform; // scale and offset of the texture coordinates
+};
+
+layout (std430, binding = 0) readonly buffer Vertices { uint words[]; };
+layout (std430, binding = 1) readonly buffer Layouts { Layout layouts[]; };
+layout (std430, binding = 2) readonly buffer Draws { Draw draws[]; };
+
+out vec2 TexCoord;
+out vec3 FragPos;
+out vec3 Normal;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// same defaults as a disabled vertex attribute : (0, 0, 0, 1)
+vec4 fetch(uint vertex, Attribute a)
+{
+	vec4 v = vec4(0.0, 0.0, 0.0, 1.0);
+	if (a.type == 0u)
+		return v;
+	uint word = vertex + a.offset;
+	if (a.type == TYPE_FLOAT)
+	{
+		for (uint i = 0u; i < a.components; i++)
+			v[i] = uintBitsToFloat(words[word + i]);
+		return v;
+	}
+	if (a.type == TYPE_HALF_FLOAT)
+		v = vec4(unpackHalf2x16(words[word]), a.components > 2u ? unpackHalf2x16(words[word + 1u]) : vec2(0.0, 1.0));
+	else if (a.type == TYPE_UNSIGNED_SHORT)
+	{
+		uint low = words[word], high = a.components > 2u ? words[word + 1u] : 0u;
+		v = vec4(low & 0xFFFFu, low >> 16, high & 0xFFFFu, high >> 16);
+		if (a.normalized != 0u)
+			v /= 65535.0;
+	}
+	else if (a.type == TYPE_UNSIGNED_BYTE)
+		v = a.normalized != 0u ? unpackUnorm4x8(words[word]) : vec4((uvec4(words[word]) >> uvec4(0, 8, 16, 24)) & 0xFFu);
+	else if (a.type == TYPE_INT_2_10_10_10_REV)
+	{
+		int bits = int(words[word]);
+		v = vec4(bitfieldExtract(bits, 0, 10), bitfieldExtract(bits, 10, 10), bitfieldExtract(bits, 20, 10), bitfieldExtract(bits, 30, 2));
+		if (a.normalized != 0u)
+			v = max(v / vec4(511.0, 511.0, 511.0, 1.0), -1.0);
+	}
+	// components the mesh does not store keep their defaults
+	for (uint i = a.components; i < 4u; i++)
+		v[i] = i == 3u ? 1.0 : 0.0;
+	return v;
+}
+
+void main()
+{
+	Draw draw = draws[gl_DrawIDARB];
+	Layout mesh = layouts[draw.mesh];
+	// gl_VertexID already includes the base vertex of the command
+	uint vertex = mesh.base + uint(gl_VertexID) * mesh.stride;
+
+	vec3 position = mesh.positionOffset.xyz + mesh.positionScale.xyz * fetch(vertex, mesh.attributes[0]).xyz;
+	FragPos = vec3(draw.model * vec4(position, 1.0));
+	Normal = mat3(transpose(inverse(draw.model))) * fetch(vertex, mesh.attributes[3]).xyz;
+	TexCoord = draw.uvTransform.zw + draw.uvTransform.xy * fetch(vertex, mesh.attributes[2]).xy;
+
+	gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -3,6 +3,9 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+
+#include "common/profiler.hpp"
+
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -16,6 +19,7 @@ public:
 	// ------------------------------------------------------------------------
 	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
 	{
+		PROFILE_SCOPE("compile shader");
 		// 1. retrieve the vertex/fragment source code from filePath
 		std::string vertexCode;
 		std::string fragmentCode;
@@ -10,13 +10,19 @@ out vec3 Normal;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+// quantized positions are relative to the mesh bounds
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionOffset = vec3(0.0);
+// scale (xy) and offset (zw) of the texture coordinates, parts of an atlas page use their own corner
+uniform vec4 uvTransform = vec4(1.0, 1.0, 0.0, 0.0);
 
 void main()
 {
-	FragPos = vec3(model * vec4(aPos, 1.0));
+	vec3 position = positionOffset + positionScale * aPos;
+	FragPos = vec3(model * vec4(position, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;  
     
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	TexCoord = uvTransform.zw + uvTransform.xy * aTexCoord;
 
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
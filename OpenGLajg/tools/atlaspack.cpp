@@ -0,0 +1,114 @@
+// Packs part textures into atlas pages with a manifest of where each one went (common/textureatlas.hpp)
+// build: g++ -O2 -std=c++11 -pthread -I../../Dependencies/stb_image -I../src atlaspack.cpp ../src/common/textureatlas.cpp ../src/common/texturecook.cpp ../src/common/imageresize.cpp ../src/common/texturefile.cpp ../src/common/mappedfile.cpp -o atlaspack
+// usage: atlaspack atlas.txt name=image.png [name=image.png ...]
+//        the pages go next to the manifest as atlas0.dds, atlas1.dds ... and the part names
+//        are what application.cpp looks up (body, wheel, rim, lamp)
+// options: --page n (pixels, default 2048), --padding n (gutter pixels, default 8), --levels n,
+//          --bc1 / --bc3 compress the pages (default RGBA8), --no-flip to keep the rows top first
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "common/textureatlas.hpp"
+#include "common/texturecook.hpp"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+	AtlasOptions options;
+	unsigned int format = TEXTURE_RGBA8;
+	bool flip = true;
+	std::vector<const char *> arguments;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--page") == 0 && i + 1 < argc)
+			options.pageSize = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--padding") == 0 && i + 1 < argc)
+			options.padding = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc)
+			options.levels = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--bc1") == 0)
+			format = TEXTURE_BC1;
+		else if (strcmp(argv[i], "--bc3") == 0)
+			format = TEXTURE_BC3;
+		else if (strcmp(argv[i], "--no-flip") == 0)
+			flip = false;
+		else
+			arguments.push_back(argv[i]);
+	}
+	if (arguments.size() < 2)
+	{
+		printf("usage: atlaspack atlas.txt name=image.png [name=image.png ...] [--page n] [--padding n] [--levels n] [--bc1|--bc3] [--no-flip]\n");
+		return 2;
+	}
+
+	// decoded the way cooked textures are stored, bottom row first
+	std::vector<AtlasImage> images;
+	std::vector<unsigned char *> decoded;
+	size_t sourceBytes = 0;
+	for (size_t i = 1; i < arguments.size(); i++)
+	{
+		const char *equals = strchr(arguments[i], '=');
+		if (!equals || equals == arguments[i] || std::string(arguments[i], equals).find_first_of(" \t") != std::string::npos)
+		{
+			printf("%s : expected name=image with a name without spaces\n", arguments[i]);
+			return 2;
+		}
+		int width, height, channels;
+		unsigned char *pixels = stbi_load(equals + 1, &width, &height, &channels, 4);
+		if (!pixels)
+		{
+			printf("%s could not be decoded : %s\n", equals + 1, stbi_failure_reason());
+			return 1;
+		}
+		if (flip)
+			flipImageRows(pixels, (size_t)width * 4, height);
+		AtlasImage image;
+		image.name.assign(arguments[i], equals);
+		image.width = width;
+		image.height = height;
+		image.rgba = pixels;
+		images.push_back(image);
+		decoded.push_back(pixels);
+		sourceBytes += (size_t)width * height * 4;
+	}
+
+	TextureAtlas atlas;
+	bool packed = packAtlas(images, options, atlas);
+	for (size_t i = 0; i < decoded.size(); i++)
+		stbi_image_free(decoded[i]);
+	if (!packed)
+		return 1;
+
+	std::string manifest = arguments[0];
+	size_t slash = manifest.find_last_of("/\\");
+	size_t dot = manifest.find_last_of('.');
+	std::string base = manifest.substr(0, dot == std::string::npos || (slash != std::string::npos && dot < slash) ? manifest.size() : dot);
+	std::vector<std::string> pageFiles;
+	size_t pageBytes = 0;
+	for (size_t i = 0; i < atlas.pages.size(); i++)
+	{
+		char suffix[32];
+		snprintf(suffix, sizeof(suffix), "%u.dds", (unsigned int)i);
+		std::string path = base + suffix;
+		TextureImage compressed;
+		if (format != TEXTURE_RGBA8)
+			compressTexture(atlas.pages[i], format, false, 0, compressed);
+		const TextureImage &page = format != TEXTURE_RGBA8 ? compressed : atlas.pages[i];
+		if (!writeTextureFile(path.c_str(), page))
+			return 1;
+		pageBytes += page.data.size();
+		pageFiles.push_back(path.substr(slash == std::string::npos ? 0 : slash + 1));
+	}
+	if (!writeAtlasManifest(manifest.c_str(), atlas, pageFiles))
+		return 1;
+
+	printf("%s : %u images on %u pages of %u pixels, %u levels\n", manifest.c_str(), (unsigned int)images.size(), (unsigned int)atlas.pages.size(),
+		options.pageSize, (unsigned int)atlas.pages[0].levels.size());
+	printf("%s : %.2f MB of sources -> %.2f MB of pages\n", manifest.c_str(), sourceBytes / 1048576.0, pageBytes / 1048576.0);
+	return 0;
+}
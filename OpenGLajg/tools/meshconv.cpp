@@ -0,0 +1,107 @@
+// Offline converter to the binary .mesh format (common/meshfile.hpp)
+// build: g++ -O2 -std=c++11 -pthread -I../../Dependencies/glm -I../src meshconv.cpp ../src/common/meshfile.cpp ../src/common/mappedfile.cpp ../src/common/objloader.cpp ../src/common/meshsimplify.cpp ../src/common/meshoptimize.cpp ../src/common/carprofile.cpp -o meshconv
+// usage: meshconv input.obj output.mesh [--lods]   indexed OBJ, --lods adds a simplified LOD chain
+//        meshconv --builtin directory               the hand-typed meshes of SceneMeshes.h
+//        meshconv --profile outlines.txt output.mesh the car body built from "koordinat mobil.txt", with LODs
+// vertices are quantized (quantizeMeshView) unless --float is given
+#include <glm/glm.hpp>
+
+#include "common/meshfile.hpp"
+#include "common/objloader.hpp"
+#include "common/carprofile.hpp"
+#include "common/meshoptimize.hpp"
+#include "SceneMeshes.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <stdio.h>
+
+static bool write(const char *path, MeshView mesh, bool lods, bool quantize)
+{
+	MeshCookStats stats;
+	if (!cookMeshFile(path, mesh, lods, quantize, &stats))
+		return false;
+	if (mesh.indexCount)
+		printf("%s : ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", path, stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr);
+	if (quantize)
+		printf("%s : %u -> %u bytes per vertex\n", path, stats.strideBefore, stats.strideAfter);
+	printf("%s : %u vertices, %u indices (%u bit), %u levels\n", path, stats.vertexCount, stats.indexCount, stats.indexCount ? stats.indexSize * 8 : 0, stats.lodCount);
+	return true;
+}
+
+static int convertObj(const char *input, const char *output, bool lods, bool quantize)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	IndexedMesh obj;
+	if (!loadOBJIndexed(input, obj))
+		return 1;
+
+	// same attribute locations as the application shaders : 0 position, 2 uv, 3 normal
+	MeshView mesh = MeshView();
+	mesh.layout.stride = sizeof(ObjVertex);
+	mesh.layout.attributeCount = 3;
+	mesh.layout.attributes[0] = meshAttribute(0, 3, MESH_FLOAT, offsetof(ObjVertex, position));
+	mesh.layout.attributes[1] = meshAttribute(2, 2, MESH_FLOAT, offsetof(ObjVertex, uv));
+	mesh.layout.attributes[2] = meshAttribute(3, 3, MESH_FLOAT, offsetof(ObjVertex, normal));
+	mesh.vertices = obj.vertices.empty() ? NULL : &obj.vertices[0];
+	mesh.vertexCount = (unsigned int)obj.vertices.size();
+	mesh.indices = obj.indexData();
+	mesh.indexCount = (unsigned int)obj.indexCount();
+	mesh.indexSize = (unsigned int)obj.indexSize();
+	computeMeshBounds(mesh);
+	if (!write(output, mesh, lods, quantize))
+		return 1;
+	printf("converted in %.1f ms\n", std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	return 0;
+}
+
+// the car body from the outline file (common/carprofile.hpp), the same mesh the application caches
+static int convertProfile(const char *input, const char *output, bool quantize)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	CarProfile profile;
+	if (!loadCarProfile(input, CarProfileOptions(), profile))
+		return 1;
+	printf("%s : %u vertices, %u triangles in %.1f ms\n", input, (unsigned int)profile.body.vertices.size(), (unsigned int)profile.body.indices.size() / 3,
+		std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	for (size_t i = 0; i < profile.wheels.size(); i++)
+	{
+		const ProfileWheel &wheel = profile.wheels[i];
+		printf("%s : centre (%.3f, %.3f, %.3f) radius %.3f\n", wheel.name.c_str(), wheel.centre.x, wheel.centre.y, wheel.centre.z, wheel.radius);
+	}
+	return write(output, meshDataView(profile.body), true, quantize) ? 0 : 1;
+}
+
+static int convertBuiltin(const std::string &directory, bool quantize)
+{
+	bool ok = write((directory + "/car_body.mesh").c_str(), carBodyMesh(), true, quantize);
+	ok = write((directory + "/lamp_cube.mesh").c_str(), lampCubeMesh(), false, quantize) && ok;
+	ok = write((directory + "/rain_drop.mesh").c_str(), rainDropMesh(), false, quantize) && ok;
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+	bool lods = false, quantize = true;
+	std::vector<const char *> arguments;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--lods") == 0)
+			lods = true;
+		else if (strcmp(argv[i], "--float") == 0)
+			quantize = false;
+		else
+			arguments.push_back(argv[i]);
+	}
+	if (arguments.size() == 3 && strcmp(arguments[0], "--profile") == 0)
+		return convertProfile(arguments[1], arguments[2], quantize);
+	if (arguments.size() == 2 && strcmp(arguments[0], "--builtin") == 0)
+		return convertBuiltin(arguments[1], quantize);
+	if (arguments.size() == 2)
+		return convertObj(arguments[0], arguments[1], lods, quantize);
+	printf("usage: meshconv input.obj output.mesh [--lods] [--float]\n       meshconv --builtin directory [--float]\n       meshconv --profile outlines.txt output.mesh [--float]\n");
+	return 2;
+}
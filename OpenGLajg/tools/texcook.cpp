@@ -0,0 +1,60 @@
+// Offline texture cooker to BC1 / BC3 DDS or KTX files (common/texturecook.hpp)
+// build: g++ -O2 -std=c++11 -pthread -I../../Dependencies/stb_image -I../src texcook.cpp ../src/common/texturecook.cpp ../src/common/imageresize.cpp ../src/common/texturefile.cpp ../src/common/mappedfile.cpp -o texcook
+// usage: texcook input.jpg [output.dds|output.ktx]   output defaults to the input path ending in .dds,
+//        where TextureStreamer looks for it
+// options: --bc1 / --bc3 force the format (default : BC3 only for images with alpha), --no-mips,
+//          --hq for stb_dxt's refinement, --no-flip to keep the rows top first, --threads n,
+//          --filter box|triangle|mitchell|catmullrom for the mips (default mitchell), --linear for
+//          data textures that should not be filtered in linear light
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "common/texturecook.hpp"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+	TextureCookOptions options;
+	std::vector<const char *> arguments;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bc1") == 0)
+			options.alpha = 0;
+		else if (strcmp(argv[i], "--bc3") == 0)
+			options.alpha = 1;
+		else if (strcmp(argv[i], "--no-mips") == 0)
+			options.mips = false;
+		else if (strcmp(argv[i], "--hq") == 0)
+			options.highQuality = true;
+		else if (strcmp(argv[i], "--no-flip") == 0)
+			options.flip = false;
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			options.threads = options.mipChain.threads = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			options.mipChain.filter = parseMipFilter(argv[++i], options.mipChain.filter);
+		else if (strcmp(argv[i], "--linear") == 0)
+			options.mipChain.srgb = false;
+		else
+			arguments.push_back(argv[i]);
+	}
+	if (arguments.empty() || arguments.size() > 2)
+	{
+		printf("usage: texcook input.jpg [output.dds|output.ktx] [--bc1|--bc3] [--no-mips] [--hq] [--no-flip] [--threads n] [--filter name] [--linear]\n");
+		return 2;
+	}
+	std::string output = arguments.size() == 2 ? arguments[1] : cookedTexturePath(arguments[0]);
+
+	TextureCookStats stats;
+	if (!cookTexture(arguments[0], output.c_str(), options, &stats))
+		return 1;
+	printf("%s : %s, %u levels, decode %.1f ms, %s mips %.1f ms, compress %.1f ms\n", output.c_str(), stats.format == TEXTURE_BC1 ? "BC1" : "BC3",
+		stats.levels, stats.decodeMs, mipFilterName(options.mipChain.filter), stats.mipMs, stats.compressMs);
+	printf("%s : %.2f MB as RGBA8 -> %.2f MB cooked (%.1fx)\n", output.c_str(), stats.sourceBytes / 1048576.0, stats.cookedBytes / 1048576.0,
+		(double)stats.sourceBytes / stats.cookedBytes);
+	return 0;
+}